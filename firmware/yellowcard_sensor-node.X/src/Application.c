@@ -14,12 +14,43 @@
 
 
 //Measurement Results
-float mostRecentTemp;  //Create a float to store the most recent temperature measurement
-float mostRecentRH;    //Create a float to store the most recent relative humidity measurement
-float mostRecentPres;  //Create a float to store the most recent barometric pressure measurement
+int32_t mostRecentTemp;  //Create an integer to store the most recent temperature measurement in hundredths of a degree Celsius
+int32_t mostRecentRH;    //Create an integer to store the most recent relative humidity measurement in hundredths of a percent
+int32_t mostRecentPres;  //Create an integer to store the most recent barometric pressure measurement in hundredths of a Pascal
+#ifdef APP_RAW_REPORT
+uint16_t mostRecentRawTemp;      //Raw temperature ticks of the most recent SHT4x measurement
+uint16_t mostRecentRawRH;        //Raw relative humidity ticks of the most recent SHT4x measurement
+uint32_t mostRecentRawPres;      //Raw 24-bit pressure result of the most recent DPS368 measurement
+uint32_t mostRecentRawPresTemp;  //Raw 24-bit temperature result of the most recent DPS368 measurement
+#endif
+
+//Sensor Calibration
+calibrationDPS368_t pressureSensorCal;  //Calibration context of the DPS368 pressure sensor, built from its coefficients and oversampling settings
+
+//Calibration record page, takes up an entire page of its own so that erasing it can't touch anything else, starts off erased
+const volatile uint32_t __attribute__ ((aligned(NVM_PAGE_SIZE), space(prog))) calibrationPageNVM[NVM_PAGE_SIZE / 0x00000004] = {[0x00000000 ... (NVM_PAGE_SIZE / 0x00000004) - 0x00000001] = 0xFFFFFFFF};
 
 //State Machine and Program Control
-volatile NodeState_t currentState = RESET;  //Initialize a variable to keep track of where program execution is within the state machine, starting in the RESET state
+uint32_t measureAttemptsLeft;   //Number of times left to check for measurement results before giving up on the measurement
+uint32_t measureResultsSeen;    //INT_STS bits collected from the DPS368 since the measurement was started, telling which results are ready
+uint32_t measureCheckDeadline;  //Scheduler time at which the fallback check on the DPS368 results is due
+uint32_t measurementsPending;   //APP_PENDING_* bits of the sensors whose results have yet to be collected for the current measurement
+#ifdef APP_RAW_REPORT
+uint32_t calibrationPending;    //Non-zero until the DPS368 calibration has followed the reset event over the air
+#endif
+
+#ifdef APP_PROFILE_CYCLE
+//Cycle Timing
+uint32_t cycleStartTicks;                              //Scheduler time at which the current measurement cycle started
+volatile uint32_t cycleStageTicks[CYCLE_STAGE_COUNT];  //Ticks from the start of the current cycle to each of its stages
+uint32_t previousStageTicks[CYCLE_STAGE_COUNT];        //Stage times of the previous cycle, copied out before the current cycle starts overwriting them
+#endif
+
+#ifdef SCHEDULER_ACCOUNT_CLOCK
+//Charge Estimation, rough typical figures for the MCU alone that should be replaced with ones measured on the board
+const uint32_t chargeRunCurrent[] = {1000, 2000, 6000, 13000};  //Current in uA drawn while executing at 1MHz, 4MHz, 16MHz and 40MHz
+const uint32_t chargeIdleCurrent[] = {600, 1000, 2500, 5000};   //Current in uA drawn while resting in IDLE at 1MHz, 4MHz, 16MHz and 40MHz
+#endif
 
 
 
@@ -27,11 +58,40 @@ volatile NodeState_t currentState = RESET;  //Initialize a variable to keep trac
  *  Handler Function Lookup Table  *
  ***********************************/
 
-const void (*handlerFunctionTable[])() = {&onReset,
-                                          &doMeasurements,
-                                          &reportMeasurements,
-                                          &onMeasureFail,
-                                          &doSleepLowPower};
+const taskFunction_t handlerFunctionTable[] = {&onReset,
+                                               &doMeasurements,
+                                               &collectMeasurements,
+                                               &collectHumidity,
+                                               &reportMeasurements,
+                                               &onMeasureFail,
+                                               &doSleepLowPower,
+                                               &sleepRadio};
+
+
+
+/************************
+ *  Clock Policy Table  *
+ ************************/
+
+#if APP_CLOCK_POLICY == APP_CLOCK_GOVERNED
+const SysClkSpeed_t clockPolicyTable[] = {SYSCLK_16MHZ,  //DO_RESET, encodes and sends the reset event
+                                          SYSCLK_4MHZ,   //DO_MEASUREMENTS, starts both sensors over I2C
+                                          SYSCLK_4MHZ,   //COLLECT_MEASUREMENTS, reads the DPS368 results over I2C
+                                          SYSCLK_4MHZ,   //COLLECT_HUMIDITY, reads the SHT4x results over I2C
+                                          SYSCLK_16MHZ,  //REPORT_MEASUREMENTS, encodes the frame and log and loads the transceiver
+                                          SYSCLK_1MHZ,   //MEASURE_FAIL
+                                          SYSCLK_1MHZ,   //ENTER_SLEEP
+                                          SYSCLK_1MHZ};  //RADIO_SLEEP
+#elif APP_CLOCK_POLICY == APP_CLOCK_RACE_TO_IDLE
+const SysClkSpeed_t clockPolicyTable[] = {SYSCLK_40MHZ,   //DO_RESET
+                                          SYSCLK_40MHZ,   //DO_MEASUREMENTS
+                                          SYSCLK_40MHZ,   //COLLECT_MEASUREMENTS
+                                          SYSCLK_40MHZ,   //COLLECT_HUMIDITY
+                                          SYSCLK_40MHZ,   //REPORT_MEASUREMENTS
+                                          SYSCLK_40MHZ,   //MEASURE_FAIL
+                                          SYSCLK_40MHZ,   //ENTER_SLEEP
+                                          SYSCLK_40MHZ};  //RADIO_SLEEP
+#endif
 
 
 
@@ -43,101 +103,427 @@ const void (*handlerFunctionTable[])() = {&onReset,
 //On Reset Function, handles the startup of the application and sends a startup event packet
 void onReset()
 {
-//    changeClockSpeed(SYSCLK_16MHZ);  //Boost the CPU clock for interacting with the radio
     LATBSET = 0x00000400;
 
     packetEvent_t packetBuffer;  //Allocate a new packetEvent_t structure in memory to store the generated packet for transmission
-    uint32_t logSize;            //Create a new variable to use for storing the size of the constructed log string
 
     newEventPacket(&packetBuffer, RESET, 0x00);  //Generate a new event packet that signifies a system reset event
 
-    logSize = constructPacketLog((uint8_t *) dmaBufferTxUART, packetBuffer.bytes);  //Construct a new packet log and store it in dmaBufferTxUART
-    startTxUART((uint8_t *) dmaBufferTxUART, &logSize);                             //Start the transmission of the log message
+    LOG_PACKET(packetBuffer.bytes);  //Log the packet
 
-    writePacketSX1231H(packetBuffer.bytes, PACKET_LENGTH_EVENT);  //Transmit the packet over the air
+    transmitPacketSX1231H(packetBuffer.bytes, PACKET_LENGTH_EVENT);  //Transmit the packet over the air, the transceiver returns to SLEEP by itself once it has been sent
 
-    LATBCLR = 0x00000400;
+#ifdef APP_RAW_REPORT
+    calibrationPending = 0xFFFFFFFF;  //Follow the reset event with the DPS368 calibration, sent from RADIO_SLEEP once PacketSent reports the reset event off the air
+#endif
 
-    logSize = 0x003FFFFF;  //Re-use the logSize variable as a counter to create a delay
-    while (logSize--);     //Wait for the logSize variable to become 0 before going continuing
+    LATBCLR = 0x00000400;
 
-    currentState = DO_MEASUREMENTS;  //Next state is DO_MEASUREMENTS
+#if defined(APP_PROFILE_CYCLE) || defined(SCHEDULER_ACCOUNT_CLOCK)
+    holdTimeScheduler();  //Keep Timer 1 counting for good so that the stages of each cycle can be timestamped and the SLEEP between them accounted for
+#endif
+
+#ifdef APP_BATCH_MODE
+    clearFifoDPS368();         //Throw away anything left in the FIFO buffer from before the reset
+    setModeDPS368(CONT_BOTH);  //Start background measurements of both pressure and temperature into the FIFO buffer, they keep going while the MCU sleeps
+    signalTask(ENTER_SLEEP);   //Next state is ENTER_SLEEP, the first report follows once the FIFO has had an alarm period to fill up
+#else
+    signalTask(DO_MEASUREMENTS);  //Next state is DO_MEASUREMENTS
+#endif
 }
 
-//Do Measurements Function, performs the data collection routine required to obtain new sensor measurements
+//Do Measurements Function, starts new measurements on the sensors and schedules their collection
 void doMeasurements()
 {
-    uint32_t resultBuffer[0x00000002] = {0x000000FF, 0x00000000};  //Create an array of 2 32-bit unsigned integers to use for caching the results obtained from the sensors
+    RTCCON = 0x00002208;  //Stop and disable the RTCC now that we have woken up again
 
-    requestMeasurementSHT4X(HIGH_PRECISION_NO_HEATER);  //Ask the SHT4x sensor to start a new temperature and humidity measurement
-    setModeDPS368(CONT_BOTH);                           //Start background measurements of both pressure and temperature on the DPS368 sensor
+#if defined(APP_PROFILE_CYCLE) || defined(SCHEDULER_ACCOUNT_CLOCK)
+#ifdef APP_PROFILE_CYCLE
+    //Log how the previous cycle went while the sensors convert, taking a copy of its stage times and clearing them for the current cycle
+    for (uint32_t stage = 0x00000000; stage < CYCLE_STAGE_COUNT; stage++)
+    {
+        previousStageTicks[stage] = cycleStageTicks[stage];  //Take a copy of the time the stage was reached
+        cycleStageTicks[stage] = 0x00000000;                 //A stage the current cycle never reaches, after a MEASURE_FAIL or in batch mode, is logged as 0 rather than as the time from an earlier cycle
+    }
+    cycleStartTicks = getTimeScheduler();               //The current cycle starts now
+    LOG_TIMING(previousStageTicks, CYCLE_STAGE_COUNT);  //Log the timing of the previous cycle
+#endif
+
+#ifdef SCHEDULER_ACCOUNT_CLOCK
+    clockAccountScheduler_t clockAccount;      //Time spent at each operating point over the previous cycle
+    uint32_t pointCharge[SYSCLK_SPEED_COUNT];  //Charge in nC drawn at each operating point over the previous cycle
+    uint32_t sleepCharge;                      //Charge in nC drawn in SLEEP over the previous cycle
+
+    //Log the charge drawn by the previous cycle, which runs from the start of its DO_MEASUREMENTS up until now
+    takeClockAccountScheduler(&clockAccount);
+    estimateCycleCharge(&clockAccount, pointCharge, &sleepCharge);
+    LOG_CHARGE(APP_CLOCK_POLICY, pointCharge, SYSCLK_SPEED_COUNT, sleepCharge);
+#endif
+#endif
+
+    measurementsPending = APP_PENDING_DPS368 | APP_PENDING_SHT4X;  //Both sensors have results to collect for this measurement
+
+    //Ask the SHT4x sensor to start a new temperature and humidity measurement, then read it out exactly once after it is known to be done
+    if (!requestMeasurementSHT4X(APP_SHT4X_MEASUREMENT))
+    {
+        signalTask(MEASURE_FAIL);  //Next state is MEASURE_FAIL
+        return;
+    }
+
+    scheduleTask(COLLECT_HUMIDITY, SCHEDULER_TICKS_FROM_US(getMeasureTimeSHT4X(APP_SHT4X_MEASUREMENT)));
+
+#ifdef APP_BATCH_MODE
+    signalTask(COLLECT_MEASUREMENTS);  //The DPS368 samples are already waiting in its FIFO, so collect them while the SHT4x is busy
+#else
+    measureResultsSeen = 0x00000000;  //Nothing has been reported ready by the DPS368 for this measurement yet
+    setModeDPS368(CONT_BOTH);         //Start background measurements of both pressure and temperature on the DPS368 sensor
+
+    //Sleep until the DPS368 signals each of its results through the change notice interrupt, checking anyway once they are overdue in case it never does
+    measureAttemptsLeft = APP_MEASURE_ATTEMPTS;                                                                       //Allow a limited number of checks for the results before giving up
+    measureCheckDeadline = getTimeScheduler() + SCHEDULER_TICKS_FROM_MS(APP_MEASURE_TIME_MS + APP_MEASURE_RETRY_MS);  //Fall back to checking on the sensor a little after it should be done
+    scheduleTask(COLLECT_MEASUREMENTS, SCHEDULER_TICKS_FROM_MS(APP_MEASURE_TIME_MS + APP_MEASURE_RETRY_MS));          //Sleep until the change notice, or until the fallback check is due
+#endif
+}
 
-    while (resultBuffer[0x00000000]--);  //Wait a little bit before polling for measurement results
+//Collect Measurements Function, obtains the results of the DPS368 measurements once the sensor is done taking them
+void collectMeasurements()
+{
+#ifdef APP_BATCH_MODE
+    //Obtain the average barometric pressure of every sample taken since the last report
+    if (!averageBatchPressure(&mostRecentPres))
+    {
+        signalTask(MEASURE_FAIL);  //Next state is MEASURE_FAIL
+        return;
+    }
+#else
+    uint32_t resultBuffer[0x00000002];  //Create an array of 2 32-bit unsigned integers to use for caching the results obtained from the sensor
+    uint8_t interruptStatus;            //INT_STS bits of the DPS368, reading them also releases its interrupt pin ready for the next result
+    uint32_t newResults = 0x00000000;   //Results reported ready by this check that hadn't been seen before, none when the read fails
+
+    if (readInterruptStatusDPS368(&interruptStatus)) newResults = interruptStatus & ~measureResultsSeen & (DPS368_STS_TEMP_READY | DPS368_STS_PRES_READY);  //Pick out what the DPS368 has finished since the last check
+    measureResultsSeen |= newResults;                                                                                                                     //Add it onto what has already been seen
+    if (!(measurementsPending & APP_PENDING_DPS368)) return;                                                                                              //Nothing more to do when the measurement has already failed, the read above still releases the interrupt pin
+
+    //Keep waiting when INT_STS hasn't reported both temperature and pressure yet. A change notice that brings in the first result leaves the fallback
+    //check as it is, so the node sleeps straight through to the next result. Only the fallback check itself, once it is due, checks back again a
+    //little later, and only one that finds nothing new counts against the attempts. The sensor latches each bit until it is read, so a missed
+    //interrupt still shows up on the fallback check without polling MEAS_CFG.
+    if ((measureResultsSeen & (DPS368_STS_TEMP_READY | DPS368_STS_PRES_READY)) != (DPS368_STS_TEMP_READY | DPS368_STS_PRES_READY))
+    {
+        if ((int32_t) (getTimeScheduler() - measureCheckDeadline) < 0x00000000) return;  //The fallback check isn't due yet, so this was a change notice
+
+        if (!newResults && !--measureAttemptsLeft)
+        {
+            signalTask(MEASURE_FAIL);  //Next state is MEASURE_FAIL, which puts the DPS368 back into IDLE
+            return;
+        }
+
+        measureCheckDeadline = getTimeScheduler() + SCHEDULER_TICKS_FROM_MS(APP_MEASURE_RETRY_MS);  //The next fallback check is due a little while from now
+        scheduleTask(COLLECT_MEASUREMENTS, SCHEDULER_TICKS_FROM_MS(APP_MEASURE_RETRY_MS));          //Sleep until then unless the change notice comes first
+        return;
+    }
+
+    cancelTask(COLLECT_MEASUREMENTS);  //Drop the fallback check now that the results are in
 
     //Obtain and calculate the barometric pressure measurement
-    while (getResultStatusDPS368() != BOTH_READY);                                              //Proceed only if both temperature and pressure readings are available from the DPS368
-    setModeDPS368(IDLE);                                                                        //Put the DPS368 sensor back into IDLE mode to save power
-    getResultsFromFifoDPS368(resultBuffer, 0x00000002);                                         //Read both the temperature and pressure data from the sensor into resultBuffer
-    mostRecentPres = convertToPressureFromDPS368(*resultBuffer, *(resultBuffer + 0x00000001));  //Convert the raw sensor data into the compensated barometric pressure in Pascal
-
-    //Obtain and calculate the temperature and relative humidity measurements
-    while (!getResultsSHT4X((uint16_t *) resultBuffer, (uint16_t *) (resultBuffer + 0x00000001)));  //Poll the SHT4x for results, storing them in the resultBuffer array
-    mostRecentTemp = convertToTempCFromSHT4X((uint16_t *) resultBuffer);                            //Convert the raw temperature data into it's compensated form in Celsius
-    mostRecentRH = convertToRHFromSHT4X((uint16_t *) (resultBuffer + 0x00000001));                  //Convert the raw humidity data into it's compensated form as a percentage
+    setModeDPS368(IDLE);                                 //Put the DPS368 sensor back into IDLE mode to save power
+    getResultsFromFifoDPS368(resultBuffer, 0x00000002);  //Read both the temperature and pressure data from the sensor into resultBuffer
+#ifdef APP_RAW_REPORT
+    mostRecentRawPres = *resultBuffer;                       //Keep the raw pressure for the raw report, the receiver compensates it
+    mostRecentRawPresTemp = *(resultBuffer + 0x00000001);  //Keep the raw temperature for the raw report, the receiver needs it for the compensation
+#else
+    mostRecentPres = convertToCentiPaFromDPS368(&pressureSensorCal, *resultBuffer, *(resultBuffer + 0x00000001));   //Convert the raw sensor data into the compensated barometric pressure in hundredths of a Pascal
+#endif
+#endif
+
+    finishMeasurement(APP_PENDING_DPS368);  //The DPS368 results are in
+}
 
-    currentState = REPORT_MEASUREMENTS;  //Next state is REPORT_MEASUREMENTS
+//Collect Humidity Function, reads the results of the SHT4x measurement out once the time it takes has passed
+void collectHumidity()
+{
+    uint16_t resultBuffer[0x00000002];  //Create an array of 2 16-bit unsigned integers to use for caching the results obtained from the sensor
+
+    if (!(measurementsPending & APP_PENDING_SHT4X)) return;  //Nothing more to do when the measurement has already failed
+
+    //Obtain and calculate the temperature and relative humidity measurements, a single read that fails or has a bad CRC fails the whole measurement
+    if (!getResultsSHT4X(resultBuffer, resultBuffer + 0x00000001))
+    {
+        signalTask(MEASURE_FAIL);  //Next state is MEASURE_FAIL
+        return;
+    }
+
+#ifdef APP_RAW_REPORT
+    mostRecentRawTemp = *resultBuffer;                 //Keep the raw temperature ticks for the raw report, the receiver converts them
+    mostRecentRawRH = *(resultBuffer + 0x00000001);  //Keep the raw humidity ticks for the raw report, the receiver converts them
+#else
+    mostRecentTemp = convertToCentiCFromSHT4X(resultBuffer);                //Convert the raw temperature data into hundredths of a degree Celsius
+    mostRecentRH = convertToCentiRHFromSHT4X(resultBuffer + 0x00000001);  //Convert the raw humidity data into hundredths of a percent
+#endif
+
+    finishMeasurement(APP_PENDING_SHT4X);  //The SHT4x results are in
 }
 
 //Report Measurements Function, prepares the obtained measurements and then sends them over the air
 void reportMeasurements()
 {
-//    changeClockSpeed(SYSCLK_16MHZ);  //Boost the CPU clock for both interacting with the radio later on and also to keep computation time short
     LATBSET = 0x00000400;
 
+#ifdef APP_RAW_REPORT
+    packetRawReport_t packetBuffer;  //Allocate a new packetRawReport_t structure in memory to store the generated packet for transmission
+
+    newRawReportPacket(&packetBuffer, &mostRecentRawTemp, &mostRecentRawRH, &mostRecentRawPres, &mostRecentRawPresTemp);  //Generate a new raw report packet containing the most recent unconverted results
+    sendCalibration();                                                                                                    //Make sure the receiver gets the calibration ahead of the first report when the measurement beat PacketSent of the reset event
+
+    transmitPacketSX1231H(packetBuffer.bytes, PACKET_LENGTH_RAWREPORT);  //Transmit the packet over the air first, the log is put together while it is on air
+    APP_MARK_STAGE(STAGE_FRAME_LOADED);                                  //Mark the time the frame was handed to the transceiver
+
+    LOG_PACKET(packetBuffer.bytes);  //Log the packet, there are no converted measurements to log
+#else
     packetMeasureReport_t packetBuffer;  //Allocate a new packetMeasureReport_t structure in memory to store the generated packet for transmission
-    uint32_t logSize;                    //Create a new variable to use for storing the size of constructed log strings
-    
+
     newMeasureReportPacket(&packetBuffer, &mostRecentTemp, &mostRecentRH, &mostRecentPres);  //Generate a new measurement report packet containing the most recent measurement data
 
-    logSize = constructMeasurementLog((uint8_t *) dmaBufferTxUART, &mostRecentTemp, &mostRecentRH, &mostRecentPres);  //Construct a new measurement report log and store it in dmaBufferTxUART
-    logSize += constructPacketLog((uint8_t *) dmaBufferTxUART + logSize - 0x00000001, packetBuffer.bytes);            //Construct a new packet log and append it to dmaBufferTxUART
-    startTxUART((uint8_t *) dmaBufferTxUART, &logSize);                                                               //Start the transmission of the log message over UART
+    transmitPacketSX1231H(packetBuffer.bytes, PACKET_LENGTH_MEASUREREPORT);  //Transmit the packet over the air first, the log is put together while it is on air
+    APP_MARK_STAGE(STAGE_FRAME_LOADED);                                      //Mark the time the frame was handed to the transceiver
 
-    writePacketSX1231H(packetBuffer.bytes, PACKET_LENGTH_MEASUREREPORT);
-    while (DCH2CON & 0x00008000) asm volatile ("wait");  //Keep the CPU in idle mode until DMA 2 is done writing to UART 2 before down-clocking the CPU
-    while (!(U2STA & 0x00000100));                       //Wait until the transmission has completed fully before we down-clock the CPU
-    
-    LATBCLR = 0x00000400;
-//    changeClockSpeed(SYSCLK_1MHZ);
+    LOG_MEASUREMENT(&mostRecentTemp, &mostRecentRH, &mostRecentPres);  //Log the measurements
+    LOG_PACKET(packetBuffer.bytes);                                    //Log the packet behind them
+#endif
 
-    //Reset the RTC before going entering sleep mode
-    RTCDATE = 0x00000000;  //Reset the date value back to 0
-    RTCTIME = 0x00000000;  //Reset the time value back to 0
-    RTCALRM = 0x00008600;  //Setup a single alarm to occur at the pre-set interval
+    LATBCLR = 0x00000400;
 
-    currentState = ENTER_SLEEP;
+    signalTask(ENTER_SLEEP);  //Next state is ENTER_SLEEP
 }
 
 //On Measure Fail Function, exception handling method for failed measurement attempts
 void onMeasureFail()
 {
-    currentState = ENTER_SLEEP;
+    //Stop waiting on whichever sensor is still busy, anything it signals from here on is ignored
+    measurementsPending = 0x00000000;
+    cancelTask(COLLECT_MEASUREMENTS);
+    cancelTask(COLLECT_HUMIDITY);
+#ifndef APP_BATCH_MODE
+    setModeDPS368(IDLE);  //Put the DPS368 sensor back into IDLE mode to save power
+#endif
+
+    signalTask(ENTER_SLEEP);  //Next state is ENTER_SLEEP
 }
 
-//Do Sleep Low Power Function, halts program execution with the MCU fully powered down until an interrupt occurs
+//Do Sleep Low Power Function, arms the RTCC alarm that wakes the node for its next measurement
 void doSleepLowPower()
 {
-    //TODO:  Disable unwanted interrupt sources
-    RTCCON = 0x0000A248;   //Enable the RTCC and start counting
-    
-    currentState = DO_MEASUREMENTS;  //The assumption is made that when we wake from sleep the next state will be DO_MEASUREMENTS
+    //Reset the RTC before going entering sleep mode
+    RTCDATE = 0x00000000;        //Reset the date value back to 0
+    RTCTIME = 0x00000000;        //Reset the time value back to 0
+    RTCALRM = APP_REPORT_ALARM;  //Setup a single alarm to occur at the pre-set interval
 
-    allowSleepMode(0xFFFFFFFF);  //Enable sleep mode such that the next time to WAIT instruction is called, the MCU enters a deep sleep
-    asm volatile ("wait");       //Go to sleep and power down the MCU entirely
-    allowSleepMode(0x00000000);  //Disable sleep mode now that we've woken up
+    RTCCON = 0x0000A248;  //Enable the RTCC and start counting
 
-    RTCCON = 0x00002208;  //Stop and disable the RTCC now that we have woken up again
-    //TODO:  Re-enable the previously disabled interrupt sources
+#ifdef PROFILER_PROBES
+    dumpProfiler();  //Log what the probes have gathered since the reset while a console is attached, the probe of this task includes the dump
+#endif
+
+    //Nothing is left to run now, so the scheduler puts the MCU fully to sleep once the UART log and radio transmission are done, the RTCC alarm signals DO_MEASUREMENTS
+}
+
+//Sleep Radio Function, puts the transceiver back into SLEEP once it has returned to STBY after sending a frame
+void sleepRadio()
+{
+    if (sx1231hTxActive) return;  //Leave the transceiver alone while a frame is on its way out, PacketSent signals this task again once it's done
+
+#ifdef APP_RAW_REPORT
+    //Send the DPS368 calibration now that the reset event is off the air, the transceiver returns to its starting mode by itself after that frame too
+    if (calibrationPending)
+    {
+        sendCalibration();  //PacketSent of the calibration signals this task again
+        return;
+    }
+#endif
+
+    setDeviceModeSX1231H(SLEEP);  //Stop the crystal oscillator, nothing is written to the transceiver when it is already in SLEEP
+}
+
+
+
+/******************
+ *  Measurements  *
+ ******************/
+
+
+//Finish Measurement Function, marks the results of a sensor as collected and starts the report once every sensor is done
+void finishMeasurement(uint32_t pendingMask)
+{
+    measurementsPending &= ~pendingMask;  //These results are in
+    if (measurementsPending) return;      //Keep waiting on the other sensor
+
+    //Wake the transceiver now that every result is in, its oscillator starts up while the packet is encoded
+    APP_MARK_STAGE(STAGE_RESULTS_READY);  //Mark the time the last result came in
+    wakeSX1231H();                        //Bring the transceiver from SLEEP into STBY
+    APP_MARK_STAGE(STAGE_RADIO_WAKE);     //Mark the time the transceiver was woken
+
+    signalTask(REPORT_MEASUREMENTS);  //Next state is REPORT_MEASUREMENTS
+}
+
+
+
+/***********************
+ *  Charge Estimation  *
+ ***********************/
+
+
+#ifdef SCHEDULER_ACCOUNT_CLOCK
+//Estimate Cycle Charge Function, works out the charge in nC drawn at each operating point and in SLEEP from the provided clock account
+void estimateCycleCharge(const clockAccountScheduler_t *account, uint32_t *pointCharge, uint32_t *sleepCharge)
+{
+    uint64_t activeTime;  //Time in us spent executing at the operating point
+    uint64_t awakeTime;   //Time in us spent at the operating point, executing or resting in IDLE
+
+    for (uint32_t point = 0x00000000; point < SYSCLK_SPEED_COUNT; point++)
+    {
+        activeTime = ((uint64_t) account->activeCycles[point] * 2000000) / sysClkOperatingPoints[point].frequency;  //Convert the CP0 Count cycles (SYSCLK / 2) into microseconds
+        awakeTime = ((uint64_t) account->awakeTicks[point] * 0x3D09) >> 0x00000009;                                //Convert the Timer 1 ticks (1/32768s) into microseconds, multiplying by 15625/512
+        if (activeTime > awakeTime) activeTime = awakeTime;                                                          //Executing can't take longer than being awake, this only happens through the ~30.5us resolution of Timer 1
+
+        //Charge in nC is current in uA multiplied by time in us, divided by 1000
+        pointCharge[point] = (uint32_t) (((chargeRunCurrent[point] * activeTime) + (chargeIdleCurrent[point] * (awakeTime - activeTime))) / 1000);
+    }
+
+    *sleepCharge = (uint32_t) ((APP_SLEEP_CURRENT_UA * (((uint64_t) account->sleepTicks * 0x3D09) >> 0x00000009)) / 1000);
+}
+#endif
+
+
+
+/********************
+ *  Batch Sampling  *
+ ********************/
+
+
+#ifdef APP_BATCH_MODE
+//Average Batch Pressure Function, drains the DPS368 FIFO and works out the average compensated pressure of the samples it held
+uint32_t averageBatchPressure(int32_t *pressure)
+{
+    static uint32_t lastRawTemp = DPS368_FIFO_EMPTY;  //Most recent raw temperature seen in the FIFO, carried over to the next batch in case it starts on a pressure
+    uint32_t fifoBuffer[DPS368_FIFO_SIZE];            //Space for every result the FIFO buffer can hold
+    uint32_t resultCount;                             //Number of results drained from the FIFO buffer
+    int64_t presSum = 0x00000000;                     //Sum of the compensated pressures in hundredths of a Pascal
+    uint32_t presCount = 0x00000000;                  //Number of pressure results that went into presSum
+    uint8_t interruptStatus;                          //INT_STS bits of the DPS368, only read to release its interrupt pin
+
+    resultCount = drainFifoDPS368(fifoBuffer, DPS368_FIFO_SIZE);  //Read everything the sensor has collected since the last report in one go
+    readInterruptStatusDPS368(&interruptStatus);                   //Release the interrupt pin so that the FIFO filling up again raises it once more
+
+    //Use the first temperature in the batch for any pressures ahead of it when this is the first batch since the reset
+    if (lastRawTemp == DPS368_FIFO_EMPTY)
+    {
+        for (uint32_t index = 0x00000000; index < resultCount; index++)
+        {
+            if (!isPressureDPS368(&fifoBuffer[index]))
+            {
+                lastRawTemp = fifoBuffer[index];
+                break;
+            }
+        }
+    }
+
+    //Compensate every pressure with the temperature taken closest before it, the pressure results are marked by the LSB being set
+    for (uint32_t index = 0x00000000; index < resultCount; index++)
+    {
+        if (isPressureDPS368(&fifoBuffer[index]))
+        {
+            presSum += convertToCentiPaFromDPS368(&pressureSensorCal, fifoBuffer[index], lastRawTemp);
+            presCount++;
+        }
+        else
+        {
+            lastRawTemp = fifoBuffer[index];
+        }
+    }
+
+    if (!presCount || (lastRawTemp == DPS368_FIFO_EMPTY)) return 0x00000000;  //Report failure when the batch didn't contain anything usable
+
+    *pressure = (int32_t) (presSum / presCount);  //Store the average compensated pressure of the batch
+
+    return 0xFFFFFFFF;  //Return a non-negative value to indicate the average pressure was obtained
+}
+#endif
+
+
+
+/*****************
+ *  Raw Reports  *
+ *****************/
+
+
+#ifdef APP_RAW_REPORT
+//Send Calibration Function, sends the DPS368 calibration packet when it has yet to follow the reset event, letting the receiver convert the raw reports
+void sendCalibration()
+{
+    packetCalibration_t calibrationBuffer;  //Allocate a new packetCalibration_t structure in memory to store the calibration packet
+
+    if (!calibrationPending) return;  //Leave when the calibration has already been sent since the reset
+    calibrationPending = 0x00000000;  //Only send it the once
+
+    newCalibrationPacket(&calibrationBuffer, &pressureSensorCal, APP_PRES_OVERSAMPLE, APP_TEMP_OVERSAMPLE);  //Generate a new calibration packet from the calibration context of the DPS368
+    transmitPacketSX1231H(calibrationBuffer.bytes, PACKET_LENGTH_CALIBRATION);                               //Transmit it, resting first while any frame before it is still on air
+    LOG_PACKET(calibrationBuffer.bytes);                                                                     //Log it behind the reset event
+}
+#endif
+
+
+
+/********************************
+ *  Calibration Record Storage  *
+ ********************************/
+
+
+//Restore Calibration Record Function, loads the calibration context from flash when the record is intact and matches the fitted sensor
+uint32_t restoreCalibrationRecord(calibrationDPS368_t *calibration)
+{
+    calibrationRecord_t record;  //Copy of the record in RAM to validate before anything is taken from it
+    uint8_t productId;           //Product ID reported by the fitted sensor
+
+    if (!readProductIdDPS368(&productId)) return 0x00000000;  //Leave when the sensor doesn't respond, the full start up will keep retrying it
+
+    //Copy the record out of flash one word at a time
+    uint32_t *recordWords = (uint32_t *) &record;                                                                                                   //View the record as words to match the flash
+    for (uint32_t index = 0x00000000; index < (sizeof(calibrationRecord_t) / 0x00000004); index++) recordWords[index] = calibrationPageNVM[index];  //Copy each word of the record out of the page
+
+    //Only trust the record when it was written in this layout, for this sensor and has arrived intact
+    if (record.marker != APP_CAL_RECORD_MARKER) return 0x00000000;                                                           //Leave when the page is blank or holds a record of another layout
+    if (record.productId != productId) return 0x00000000;                                                                    //Leave when the record belongs to a different sensor
+    if (record.crc != calculateCRC16((uint8_t *) &record, __builtin_offsetof(calibrationRecord_t, crc))) return 0x00000000;  //Leave when the record was corrupted or cut short
+
+    *calibration = record.calibration;  //Hand the stored calibration context over to the caller
+
+    return 0xFFFFFFFF;  //Return a non-negative value to indicate the calibration was restored
+}
+
+//Save Calibration Record Function, writes the calibration context of the fitted sensor into the reserved page of flash
+uint32_t saveCalibrationRecord(const calibrationDPS368_t *calibration)
+{
+    calibrationRecord_t record;  //Record to be written out to flash
+    uint8_t productId;           //Product ID reported by the fitted sensor
+
+    if (!readProductIdDPS368(&productId)) return 0x00000000;  //Leave when the sensor doesn't respond, there's no way to tie the record to it
+
+    //Fill in the record, finishing with the CRC over everything before it
+    record.marker = APP_CAL_RECORD_MARKER;                                                           //Mark the record as being written in this layout
+    record.productId = productId;                                                                    //Tie the record to the fitted sensor
+    record.calibration = *calibration;                                                               //Copy in the calibration context to be kept
+    record.crc = calculateCRC16((uint8_t *) &record, __builtin_offsetof(calibrationRecord_t, crc));  //Protect everything before the CRC with it
+
+    if (!erasePageNVM(calibrationPageNVM)) return 0x00000000;  //Erase the page before programming the new record into it
+
+    //Program the record into the page one word at a time, the CRC goes in last so a record cut short by a reset never validates
+    uint32_t *recordWords = (uint32_t *) &record;  //View the record as words to match the flash
+    for (uint32_t index = 0x00000000; index < (sizeof(calibrationRecord_t) / 0x00000004); index++)
+    {
+        if (!writeWordNVM(&calibrationPageNVM[index], recordWords[index])) return 0x00000000;  //Give up on the first word that fails to program
+    }
+
+    return 0xFFFFFFFF;  //Return a non-negative value to indicate the record was saved
 }
 
 
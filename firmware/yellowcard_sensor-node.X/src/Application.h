@@ -14,27 +14,203 @@
 #include "drv/DPS368/DPS368.h"    //Include the driver for the DPS368 barometric pressure sensor
 #include "drv/SHT4x/SHT4x.h"      //Include the driver for the SHT4x temperature and humidity sensor
 #include "drv/SX1231H/SX1231H.h"  //Include the driver for the SX1231H sub-1GHz radio IC
+#include "Scheduler.h"            //Include the scheduler header file, runs the application tasks and puts the MCU to sleep in between them
 
 
-//Define any enum types used within this file
+//Define any constants used within this file
+#ifndef APP_PRES_OVERSAMPLE
+#define APP_PRES_OVERSAMPLE    OVERSAMPLE_32  //Oversampling rate used for the DPS368 pressure measurements
+#endif
+
+#ifndef APP_TEMP_OVERSAMPLE
+#define APP_TEMP_OVERSAMPLE    OVERSAMPLE_8  //Oversampling rate used for the DPS368 temperature measurements
+#endif
+
+#ifndef APP_SHT4X_MEASUREMENT
+#define APP_SHT4X_MEASUREMENT    HIGH_PRECISION_NO_HEATER  //Type of measurement taken by the SHT4x, its results are read once getMeasureTimeSHT4X() of it has passed
+#endif
+
+//Time in milliseconds for the DPS368 to finish both of its measurements
+#define APP_MEASURE_TIME_MS    ((DPS368_MEASURE_TIME_US(APP_PRES_OVERSAMPLE) + DPS368_MEASURE_TIME_US(APP_TEMP_OVERSAMPLE) + 999) / 1000)
+
+#ifndef APP_MEASURE_RETRY_MS
+#define APP_MEASURE_RETRY_MS    0x0000000A  //Time in milliseconds to wait before checking again when the measurement results aren't ready yet
+#endif
+
+#ifndef APP_MEASURE_ATTEMPTS
+#define APP_MEASURE_ATTEMPTS    0x0000000A  //Number of times to check for measurement results before giving up on the measurement
+#endif
+
+//Define APP_BATCH_MODE to have the DPS368 keep sampling in background mode into its FIFO buffer while the MCU sleeps, instead of taking a single
+//measurement per report. Every report then drains the FIFO and sends the average of the pressures it held. Each sample takes up two FIFO entries
+//(a pressure and a temperature), so APP_SAMPLE_RATE samples per second over one APP_REPORT_ALARM period should fit in DPS368_FIFO_SIZE / 2 entries,
+//a FIFO that fills up sooner raises the interrupt pin of the sensor and brings the report forward. One sample of each at the chosen oversampling
+//rates has to finish within a single sampling period.
+#ifndef APP_SAMPLE_RATE
+#define APP_SAMPLE_RATE    BACKGROUND_1HZ  //Rate at which the DPS368 samples both pressure and temperature while in batch mode
+#endif
+
+#ifdef APP_BATCH_MODE
+#define APP_FIFO_ENABLE    0xFFFFFFFF  //Results are collected in the FIFO buffer of the DPS368 while in batch mode
+#else
+#define APP_FIFO_ENABLE    0x00000000  //Results are read straight out of the result registers of the DPS368 when taking single measurements
+#endif
+
+//The DPS368 raises its interrupt pin when there is something to collect, waking the node through the change notice interrupt instead of it checking
+//the status of the sensor over I2C. Single measurements wake it for each result (the collection waits for both), batches only once the FIFO is full.
+#ifdef APP_BATCH_MODE
+#define APP_DPS368_INT_CONFIG    (DPS368_INT_ACTIVE_HIGH | DPS368_INT_FIFO_FULL)                          //Interrupt sources enabled on the DPS368 while in batch mode
+#define APP_DPS368_INT_TASK      DO_MEASUREMENTS                                                          //Task signalled when the DPS368 raises its interrupt pin while in batch mode
+#else
+#define APP_DPS368_INT_CONFIG    (DPS368_INT_ACTIVE_HIGH | DPS368_INT_TEMP_READY | DPS368_INT_PRES_READY)  //Interrupt sources enabled on the DPS368 when taking single measurements
+#define APP_DPS368_INT_TASK      COLLECT_MEASUREMENTS                                                     //Task signalled when the DPS368 raises its interrupt pin when taking single measurements
+#endif
+
+#ifndef APP_REPORT_ALARM
+#ifdef APP_BATCH_MODE
+#define APP_REPORT_ALARM    0x00008200  //RTCALRM contents arming the alarm that wakes the node for each report, AMASK = 0010 wakes it every 10 seconds
+#else
+#define APP_REPORT_ALARM    0x00008600  //RTCALRM contents arming the alarm that wakes the node for each report, AMASK = 0110 wakes it once a day
+#endif
+#endif
+
+//Bits of measurementsPending, each sensor clears its own once its results have been collected and the report follows when none are left
+#define APP_PENDING_DPS368    0x00000001  //The DPS368 results are still to be collected
+#define APP_PENDING_SHT4X     0x00000002  //The SHT4x results are still to be collected
+
+//Define APP_RAW_REPORT to send the SHT4x ticks and the 24-bit DPS368 results as read in RAW_REPORT packets rather than converting them on the node,
+//with the DPS368 calibration going out in a CALIBRATION packet as soon as the reset event is off the air. The receiver does the conversions (see
+//host/PacketDecoder.h) at the full resolution of the sensors. Batch mode reports the average of the compensated pressures, so it can't be combined
+//with raw reports.
+#if defined(APP_RAW_REPORT) && defined(APP_BATCH_MODE)
+#error "APP_RAW_REPORT can't be combined with APP_BATCH_MODE"
+#endif
+
+#define APP_CAL_RECORD_MARKER    0x31535044  //Marks the calibration record page as holding a record of this layout ("DPS1"), an erased page reads back as all 1's
+
+//The DPS368 calibration context is kept in a reserved page of flash alongside the product ID of the sensor it came from and a CRC16 over both, letting
+//a warm boot skip the wait for the coefficients (40ms after power on) and the 18 byte read of them. The record is only rewritten when it fails to
+//validate, which happens after the firmware is reflashed (the programmer erases the page) or when a sensor with a different product ID is fitted.
+
+
+//The measurement cycle is pipelined, both sensors convert at the same time and the transceiver is moved into STBY as soon as their results are in so
+//that its crystal oscillator is running by the time the frame has been encoded. The frame goes out before the UART log is put together, letting the
+//log be built while the frame is on air, and the log itself finishes in the background while the node heads back to sleep. PacketSent signals
+//RADIO_SLEEP to drop the transceiver from STBY back into SLEEP.
+
+//Define APP_PROFILE_CYCLE to timestamp each cycleStage_t of every measurement cycle with Timer 1 (kept counting for the purpose, ~30.5us resolution),
+//the times of the previous cycle are logged over UART at the start of the next, with any stage it never reached as 0. The later of Frame Sent and
+//Log Sent marks the end of the critical path.
+#ifdef APP_PROFILE_CYCLE
+#define APP_MARK_STAGE(stage)    (cycleStageTicks[(stage)] = getTimeScheduler() - cycleStartTicks)  //Records the time at which the given stage of the current cycle was reached
+#else
+#define APP_MARK_STAGE(stage)
+#endif
+
+//APP_CLOCK_POLICY picks the operating point the scheduler runs each task at (see setClockPolicyScheduler()). FIXED leaves the system clock at 16MHz
+//throughout. GOVERNED drives the sensors over I2C at 4MHz, encodes and sends the frame and log at 16MHz, and runs everything else, including the
+//waits on the UART and the radio, at 1MHz. RACE_TO_IDLE runs every task at 40MHz to get back to resting at 1MHz as soon as possible, paying for
+//the PLL to lock again after every switch up. Both governed policies rest at 1MHz, so waking from SLEEP never waits on the PLL.
+#define APP_CLOCK_FIXED           0x00000000
+#define APP_CLOCK_GOVERNED        0x00000001
+#define APP_CLOCK_RACE_TO_IDLE    0x00000002
+
+#ifndef APP_CLOCK_POLICY
+#define APP_CLOCK_POLICY    APP_CLOCK_GOVERNED  //Clock policy handed to the scheduler at startup
+#endif
+
+#if APP_CLOCK_POLICY == APP_CLOCK_FIXED
+#define APP_CLOCK_TASK_SPEEDS    NULL          //The scheduler leaves the clock alone without a table of task operating points
+#define APP_CLOCK_IDLE_SPEED     SYSCLK_16MHZ  //Operating point the core rests at between tasks
+#else
+#define APP_CLOCK_TASK_SPEEDS    clockPolicyTable  //Operating point of each task, indexed by NodeState_t
+#define APP_CLOCK_IDLE_SPEED     SYSCLK_1MHZ       //Operating point the core rests at between tasks
+#endif
+
+//Define SCHEDULER_ACCOUNT_CLOCK to have an estimate of the charge drawn by the previous cycle at each operating point, and in SLEEP, logged over
+//UART at the start of the next alongside the policy in use. Timer 1 is kept counting for the purpose so that the SLEEP between cycles is counted.
+//The estimate multiplies the time spent executing and resting at each operating point by the currents in chargeRunCurrent[] and chargeIdleCurrent[],
+//which are rough typical figures from the PIC32MX1xx datasheet for the MCU alone. Replace them with figures measured on the board before comparing
+//policies in absolute terms, the sensors and transceiver draw the same charge under each policy and aren't included.
+#ifndef APP_SLEEP_CURRENT_UA
+#define APP_SLEEP_CURRENT_UA    0x00000005  //Current in uA drawn by the MCU in SLEEP with the secondary oscillator, RTCC and Timer 1 running
+#endif
+
+
+//Define any enum types used within this file, each state is a task of the scheduler with lower numbers taking priority when several are ready
 typedef enum
 {
-    DO_RESET, DO_MEASUREMENTS, REPORT_MEASUREMENTS, MEASURE_FAIL, ENTER_SLEEP
+    DO_RESET, DO_MEASUREMENTS, COLLECT_MEASUREMENTS, COLLECT_HUMIDITY, REPORT_MEASUREMENTS, MEASURE_FAIL, ENTER_SLEEP, RADIO_SLEEP, NODE_TASK_COUNT
 } NodeState_t;
 
+//Stages of the measurement cycle timestamped when APP_PROFILE_CYCLE is defined, in the order they are listed in the timing log
+typedef enum
+{
+    STAGE_RESULTS_READY, STAGE_RADIO_WAKE, STAGE_FRAME_LOADED, STAGE_FRAME_SENT, STAGE_LOG_SENT, CYCLE_STAGE_COUNT
+} cycleStage_t;
+
+
+//Define any structs used within this file
+typedef struct
+{
+    uint32_t marker;                  //Set to APP_CAL_RECORD_MARKER when the page holds a record
+    uint32_t productId;               //Product and revision ID of the sensor the calibration was read from
+    calibrationDPS368_t calibration;  //Calibration context prepared from the coefficients of the sensor
+    uint32_t crc;                     //CRC16 of every byte of the record before this field
+} calibrationRecord_t;
+
 
 //Define any variables that are external to this file
-extern volatile NodeState_t currentState;       //Used to track where program execution is currently taking place within the program state machine
-extern const void (*handlerFunctionTable[])();  //Provides a lookup table of handler functions to allow for proper execution redirection after each state is processed
+extern const taskFunction_t handlerFunctionTable[];  //Provides a lookup table of handler functions for the scheduler to run, indexed by NodeState_t
+extern calibrationDPS368_t pressureSensorCal;        //Calibration context of the DPS368 pressure sensor, filled in during startup
+extern const volatile uint32_t calibrationPageNVM[];  //Reserved page of flash memory holding the calibration record of the DPS368 pressure sensor
+#ifdef APP_PROFILE_CYCLE
+extern uint32_t cycleStartTicks;             //Scheduler time at which the current measurement cycle started
+extern volatile uint32_t cycleStageTicks[];  //Ticks from the start of the current cycle to each of its stages
+#endif
+#if APP_CLOCK_POLICY != APP_CLOCK_FIXED
+extern const SysClkSpeed_t clockPolicyTable[];  //Provides the operating point of each task for the scheduler, indexed by NodeState_t
+#endif
+#ifdef SCHEDULER_ACCOUNT_CLOCK
+extern const uint32_t chargeRunCurrent[];   //Current in uA drawn by the MCU while executing at each operating point, indexed by SysClkSpeed_t
+extern const uint32_t chargeIdleCurrent[];  //Current in uA drawn by the MCU while resting in IDLE at each operating point, indexed by SysClkSpeed_t
+#endif
 
 
 //State Machine Handler Functions
-extern void __attribute__ ((section(".state_machine"))) onReset();             //On Reset Function, handles the startup of the application and sends a startup event packet
-extern void __attribute__ ((section(".state_machine"))) doMeasurements();      //Do Measurements Function, performs the data collection routine required to obtain new sensor measurements
-extern void __attribute__ ((section(".state_machine"))) reportMeasurements();  //Report Measurements Function, prepares the obtained measurements and then sends them over the air
-extern void __attribute__ ((section(".state_machine"))) onMeasureFail();       //On Measure Fail Function, exception handling method for failed measurement attempts
-extern void __attribute__ ((section(".state_machine"))) doSleepLowPower();     //Do Sleep Low Power Function, halts program execution with the MCU fully powered down until an interrupt occurs
+extern void __attribute__ ((section(".state_machine"))) onReset();              //On Reset Function, handles the startup of the application and sends a startup event packet
+extern void __attribute__ ((section(".state_machine"))) doMeasurements();       //Do Measurements Function, starts new measurements on the sensors and schedules their collection
+extern void __attribute__ ((section(".state_machine"))) collectMeasurements();  //Collect Measurements Function, obtains the results of the DPS368 measurements once the sensor is done taking them
+extern void __attribute__ ((section(".state_machine"))) collectHumidity();      //Collect Humidity Function, reads the results of the SHT4x measurement out once the time it takes has passed
+extern void __attribute__ ((section(".state_machine"))) reportMeasurements();   //Report Measurements Function, prepares the obtained measurements and then sends them over the air
+extern void __attribute__ ((section(".state_machine"))) onMeasureFail();        //On Measure Fail Function, exception handling method for failed measurement attempts
+extern void __attribute__ ((section(".state_machine"))) doSleepLowPower();      //Do Sleep Low Power Function, arms the RTCC alarm that wakes the node for its next measurement
+extern void __attribute__ ((section(".state_machine"))) sleepRadio();           //Sleep Radio Function, puts the transceiver back into SLEEP once it has returned to STBY after sending a frame
+
+
+//Measurement Functions
+extern void finishMeasurement(uint32_t pendingMask);  //Finish Measurement Function, marks the results of a sensor as collected and starts the report once every sensor is done
+
+//Charge Estimation Functions
+#ifdef SCHEDULER_ACCOUNT_CLOCK
+extern void estimateCycleCharge(const clockAccountScheduler_t *account,  //Estimate Cycle Charge Function, works out the charge in nC drawn at each operating point and in SLEEP from the provided clock account
+                                uint32_t *pointCharge,
+                                uint32_t *sleepCharge);
+#endif
+
+//Batch Sampling Functions
+#ifdef APP_BATCH_MODE
+extern uint32_t averageBatchPressure(int32_t *pressure);  //Average Batch Pressure Function, drains the DPS368 FIFO and works out the average compensated pressure of the samples it held
+#endif
+
+//Raw Report Functions
+#ifdef APP_RAW_REPORT
+extern void sendCalibration();  //Send Calibration Function, sends the DPS368 calibration packet when it has yet to follow the reset event, letting the receiver convert the raw reports
+#endif
 
+//Calibration Record Functions
+extern uint32_t restoreCalibrationRecord(calibrationDPS368_t *calibration);    //Restore Calibration Record Function, loads the calibration context from flash when the record is intact and matches the fitted sensor
+extern uint32_t saveCalibrationRecord(const calibrationDPS368_t *calibration);  //Save Calibration Record Function, writes the calibration context of the fitted sensor into the reserved page of flash
 
 #endif
 
@@ -17,20 +17,22 @@
 inline void setupInterrupts()
 {
     asm volatile ("di");  //Disable global interrupts
-    INTCON = 0x00001000;  //Enable multi-vector interrupt modes
+    INTCON = 0x00001010;  //Enable multi-vector interrupt modes and have INT4 trigger on a rising edge
 
     IFS0 = 0x00000000;  //Clear the entire IFS0 register to clear all interrupt flags
     IFS1 = 0x00000000;  //Clear the entire IFS1 register to clear all interrupt flags
 
     IPC1 = 0x00000008;   //Set the Timer 1 interrupt priority level to 2
+    IPC3 = 0x08000000;   //Set the External Interrupt 3 priority level to 2
     IPC4 = 0x04000000;   //Set the External Interrupt 4 priority level to 1
     IPC6 = 0x00000800;   //Set the RTCC interrupt priority level to 2
+    IPC7 = 0x0C000000;   //Set the SPI 1 interrupt priority level to 3
     IPC8 = 0x00040000;   //Set the Change Notice interrupt priority level to 1
-    IPC10 = 0x00080000;  //Set the DMA 2 interrupt priority level to 2
+    IPC9 = 0x000C0800;   //Set the UART 2 interrupt priority level to 2 and the I2C 2 interrupt priority level to 3
+    IPC10 = 0x00080C0C;  //Set the DMA 0 and DMA 1 interrupt priority levels to 3, and the DMA 2 interrupt priority level to 2
 
-    IEC0 = 0x40800010;  //Enable the Timer 1 period match, RTCC, and fourth external interrupts
-    IEC1 = 0x40000000;
-//    IEC1 = 0x40004000;  //Enable the DMA 2 abort/complete interrupt and Port B change notification interrupts
+    IEC0 = 0x40800010;  //Enable the Timer 1 period match, RTCC, and fourth external interrupts, the third external interrupt is only enabled while a frame is being streamed
+    IEC1 = 0x75004000;  //Enable the DMA 0, DMA 1 and DMA 2 abort/complete interrupts, the I2C 2 master and bus collision interrupts and the Port B change notification interrupt, the UART 2 TX interrupt is only enabled while the last log drains out
 
     asm volatile ("ei");  //Enable global interrupts again
 }
@@ -44,52 +46,163 @@ inline void setupInterrupts()
 
 //Priority 3
 
+//I2C 2 Interrupt Handler Function, called when the I2C2 peripheral finishes a bus event or detects a bus collision
+void __ISR(_I2C_2_VECTOR, IPL3SOFT) i2c2ISR()
+{
+    PROFILE_ENTER(PROBE_ISR_I2C2);  //Start timing the I2C 2 handler
+
+    //Handle bus collisions separately, the active transaction has lost the bus and needs to be failed
+    if (IFS1 & 0x01000000)
+    {
+        IFS1CLR = 0x05000000;          //Clear both the I2C 2 bus collision and master interrupt flags
+        abortTransactionI2C();         //Fail the active transaction and move on to the next one in the queue
+        PROFILE_EXIT(PROBE_ISR_I2C2);  //Stop timing the handler on the way out of the bus collision path
+        return;
+    }
+
+    IFS1CLR = 0x04000000;  //Clear the I2C 2 master interrupt flag
+
+    serviceTransactionI2C();  //Advance the I2C transaction engine to the next step
+
+    PROFILE_EXIT(PROBE_ISR_I2C2);  //Stop timing the I2C 2 handler
+}
+
+//DMA Channel 0 Interrupt Handler Function, called when DMA0 finishes receiving a block of data from SPI1
+void __ISR(_DMA_0_VECTOR, IPL3SOFT) dma0ISR()
+{
+    PROFILE_ENTER(PROBE_ISR_DMA0);  //Start timing the DMA 0 handler
+
+    IFS1CLR = 0x10000000;  //Clear the DMA 0 interrupt flag
+
+    DCH0INTCLR = 0x000000FF;  //Clear the interrupts flags for DMA 0 itself
+    completeTransferSPI();    //Every byte has been received, so the SPI transfer is done
+
+    PROFILE_EXIT(PROBE_ISR_DMA0);  //Stop timing the DMA 0 handler
+}
+
+//DMA Channel 1 Interrupt Handler Function, called when DMA1 finishes handing a block of data to SPI1
+void __ISR(_DMA_1_VECTOR, IPL3SOFT) dma1ISR()
+{
+    PROFILE_ENTER(PROBE_ISR_DMA1);  //Start timing the DMA 1 handler
+
+    IFS1CLR = 0x20000000;  //Clear the DMA 1 interrupt flag
+
+    DCH1INTCLR = 0x000000FF;  //Clear the interrupts flags for DMA 1 itself
+    drainTransferSPI();       //Wait for the remaining bytes in the SPI1 buffer to be shifted out
+
+    PROFILE_EXIT(PROBE_ISR_DMA1);  //Stop timing the DMA 1 handler
+}
+
+//SPI 1 Interrupt Handler Function, called when the last byte of a write-only transfer has left the SPI1 shift register
+void __ISR(_SPI_1_VECTOR, IPL3SOFT) spi1ISR()
+{
+    PROFILE_ENTER(PROBE_ISR_SPI1);  //Start timing the SPI 1 handler
+
+    IEC1CLR = 0x00000040;  //Disable the SPI 1 TX interrupt, it stays asserted while the transmit buffer is empty
+    IFS1CLR = 0x00000040;  //Clear the SPI 1 TX interrupt flag
+
+    completeTransferSPI();  //Every byte has been shifted out, so the SPI transfer is done
+
+    PROFILE_EXIT(PROBE_ISR_SPI1);  //Stop timing the SPI 1 handler
+}
+
 
 //Priority 2
 
 //Timer 1 Period Match Interrupt Handler Function, called when the TMR1 register matches PR1
 void __ISR(_TIMER_1_VECTOR, IPL2SOFT) timer1PeriodMatchISR()
 {
+    PROFILE_ENTER(PROBE_ISR_TIMER1);  //Start timing the Timer 1 handler
+
     IFS0CLR = 0x00000010;  //Clear the Timer 1 interrupt flag
 
-    T1CONCLR = 0x00008000;  //Stop Timer 1 by clearing Bit-15 of the T1CON register
+    serviceTimerScheduler();  //Ready any tasks whose deadline has been reached and set Timer 1 up for the next one
 
-    //Do something here
+    PROFILE_EXIT(PROBE_ISR_TIMER1);  //Stop timing the Timer 1 handler
 }
 
 //RTCC Alarm Interrupt Handler Function, called whenever an alarm goes off within the RTCC
 void __ISR(_RTCC_VECTOR, IPL2SOFT) rtccAlarmISR()
 {
+    PROFILE_ENTER(PROBE_ISR_RTCC);  //Start timing the RTCC alarm handler
+
     IFS0CLR = 0x40000000;  //Clear the RTCC interrupt flag
 
-    //Do something here
+    signalTask(DO_MEASUREMENTS);  //Time for the next round of measurements
+
+    PROFILE_EXIT(PROBE_ISR_RTCC);  //Stop timing the RTCC alarm handler
+}
+
+//External Interrupt 3 Handler Function, called on the falling edge of INT3 when DIO1 of the transceiver signals that the FIFO has drained down to its threshold
+void __ISR(_EXTERNAL_3_VECTOR, IPL2SOFT) int3ISR()
+{
+    PROFILE_ENTER(PROBE_ISR_INT3);  //Start timing the INT3 handler
+
+    IFS0CLR = 0x00040000;  //Clear the INT3 interrupt flag
+
+    refillFifoSX1231H();  //Top the FIFO buffer of the transceiver back up with the rest of the frame
+
+    PROFILE_EXIT(PROBE_ISR_INT3);  //Stop timing the INT3 handler
 }
 
 //DMA Channel 2 Interrupt Handler Function, called when DMA2 aborts or finishes transferring a block of data
 void __ISR(_DMA_2_VECTOR, IPL2SOFT) dma2ISR()
 {
+    PROFILE_ENTER(PROBE_ISR_DMA2);  //Start timing the DMA 2 handler
+
     IFS1CLR = 0x40000000;  //Clear the DMA 2 interrupt flag
 
-    DCH2INT = 0x00080000;           //Clear the interrupts flags for DMA 2 itself
-    while (!(U2STA & 0x00000100));  //Wait until the transmission has completed fully before leaving
+    DCH2INT = 0x00080000;  //Clear the interrupts flags for DMA 2 itself
+#if LOG_ANY_ENABLED
+    serviceLogQueue();  //Chain the next log on, or leave the UART2 TX interrupt to finish off once the last byte has gone out
+#endif
+
+    PROFILE_EXIT(PROBE_ISR_DMA2);  //Stop timing the DMA 2 handler
+}
+
+//UART 2 Interrupt Handler Function, called once the last byte of the logs has left the UART2 shift register
+void __ISR(_UART_2_VECTOR, IPL2SOFT) uart2ISR()
+{
+    PROFILE_ENTER(PROBE_ISR_UART2);  //Start timing the UART 2 handler
+
+    IEC1CLR = 0x00800000;  //Disable the UART 2 TX interrupt, it stays asserted while the transmit shift register is empty
+    IFS1CLR = 0x00800000;  //Clear the UART 2 TX interrupt flag
+
+#if LOG_ANY_ENABLED
+    if (!finishLogQueue()) APP_MARK_STAGE(STAGE_LOG_SENT);  //Chain on a log committed in the meantime, or mark the time once every queued log has been sent
+#endif
+
+    PROFILE_EXIT(PROBE_ISR_UART2);  //Stop timing the UART 2 handler
 }
 
 
 //Priority 1 (Lowest)
 
-//External Interrupt 4 Handler Function, called on the falling edge of INT4
+//External Interrupt 4 Handler Function, called on the rising edge of INT4 when DIO0 of the transceiver signals PacketSent
 void __ISR(_EXTERNAL_4_VECTOR, IPL1SOFT) int4ISR()
 {
+    PROFILE_ENTER(PROBE_ISR_INT4);  //Start timing the INT4 handler
+
     IFS0CLR = 0x00800000;  //Clear the INT4 interrupt flag
 
-    //Do something here
+    packetSentSX1231H();               //Let the transceiver driver know that the frame has been sent
+    signalTask(RADIO_SLEEP);           //Put the transceiver back into SLEEP in case it was sent from STBY
+    APP_MARK_STAGE(STAGE_FRAME_SENT);  //Mark the time PacketSent was raised
+
+    PROFILE_EXIT(PROBE_ISR_INT4);  //Stop timing the INT4 handler
 }
 
-//Port Change Notice Interrupt Handler Function, called when any of the 3 buttons or reed switch changes state
+//Port Change Notice Interrupt Handler Function, called when the interrupt output of the DPS368 (or any other enabled Port B input) changes state
 void __ISR(_CHANGE_NOTICE_VECTOR, IPL1SOFT) portChangeNoticeISR()
 {
-    uint32_t stataBuffer = CNSTATB;  //Create a temp copy of the state of CNSTATA so that PORTA calls aren't changing CNSTATA for the next if statement
-    IFS1CLR = 0x00002000;            //Clear Port Change Notice interrupt flag
+    PROFILE_ENTER(PROBE_ISR_CHANGE_NOTICE);  //Start timing the Port B change notice handler
+
+    uint32_t statbBuffer = CNSTATB;  //Create a temp copy of CNSTATB to know which of the pins changed
+    uint32_t portbBuffer = PORTB;    //Read the current state of Port B, which also ends the mismatch condition that raised the interrupt
+    IFS1CLR = 0x00004000;            //Clear the Port B Change Notice interrupt flag
+
+    //Only the rising edge matters, the DPS368 holds its interrupt pin high until INT_STS has been read
+    if (statbBuffer & portbBuffer & DPS368_INT_PORTB_MASK) signalTask(APP_DPS368_INT_TASK);
 
-    //Do something here
+    PROFILE_EXIT(PROBE_ISR_CHANGE_NOTICE);  //Stop timing the Port B change notice handler
 }
\ No newline at end of file
@@ -25,16 +25,22 @@ extern void setupInterrupts();  //Setup Interrupts Function, configures the inte
 
 
 //  Priority 3
+extern void i2c2ISR();               //I2C 2 Interrupt Handler Function, called when the I2C2 peripheral finishes a bus event or detects a bus collision
+extern void dma0ISR();               //DMA Channel 0 Interrupt Handler Function, called when DMA0 finishes receiving a block of data from SPI1
+extern void dma1ISR();               //DMA Channel 1 Interrupt Handler Function, called when DMA1 finishes handing a block of data to SPI1
+extern void spi1ISR();               //SPI 1 Interrupt Handler Function, called when the last byte of a write-only transfer has left the SPI1 shift register
 
 
 //  Priority 2
 extern void timer1PeriodMatchISR();  //Timer 1 Period Match Interrupt Handler Function, called when the TMR1 register matches PR1
 extern void rtccAlarmISR();          //RTCC Alarm Interrupt Handler Function, called whenever an alarm goes off within the RTCC
+extern void int3ISR();               //External Interrupt 3 Handler Function, called on the falling edge of INT3 when DIO1 of the transceiver signals that the FIFO has drained down to its threshold
 extern void dma2ISR();               //DMA Channel 2 Interrupt Handler Function, called when DMA2 aborts or finishes transferring a block of data
+extern void uart2ISR();              //UART 2 Interrupt Handler Function, called once the last byte of the logs has left the UART2 shift register
 
 //  Priority 1  (Lowest)
-extern void int4ISR();               //External Interrupt 4 Handler Function, called on the falling edge of INT4
-extern void portChangeNoticeISR();   //Port Change Notice Interrupt Handler Function, called when any of the 3 buttons or reed switch changes state
+extern void int4ISR();               //External Interrupt 4 Handler Function, called on the rising edge of INT4 when DIO0 of the transceiver signals PacketSent
+extern void portChangeNoticeISR();   //Port Change Notice Interrupt Handler Function, called when the interrupt output of the DPS368 (or any other enabled Port B input) changes state
 
 
 #endif
@@ -12,149 +12,606 @@
  *  Logging Constants  *
  ***********************/
 
-const uint8_t logConstants_measurementReport[] = "\n\n\n\nMeasurement\n  Temperature:   C\n     Humidity:   %\n     Pressure:   Pa\0";
-const uint8_t logConstants_packet[] = "\n\nPacket\n   Length:  \n  Address:  \n     Type:  \n  Frame #:  \n      Raw: ";
+const uint8_t logConstants_measurement_temperature[] = "\n\n\n\nMeasurement\n  Temperature:  ";
+const uint8_t logConstants_measurement_humidity[] = " C\n     Humidity:  ";
+const uint8_t logConstants_measurement_pressure[] = " %\n     Pressure:  ";
+const uint8_t logConstants_measurement_end[] = " Pa";
+
+const logSegment_t logSegments_measurementReport[] = {LOG_SEGMENT(logConstants_measurement_temperature),
+                                                      LOG_SEGMENT(logConstants_measurement_humidity),
+                                                      LOG_SEGMENT(logConstants_measurement_pressure),
+                                                      LOG_SEGMENT(logConstants_measurement_end)};
+
+const uint8_t logConstants_packet_length[] = "\n\nPacket\n   Length:  ";
+const uint8_t logConstants_packet_address[] = "\n  Address:  ";
+const uint8_t logConstants_packet_type[] = "\n     Type:  ";
+const uint8_t logConstants_packet_frame[] = "\n  Frame #:  ";
+const uint8_t logConstants_packet_raw[] = "\n      Raw: ";
+
+const logSegment_t logSegments_packet[] = {LOG_SEGMENT(logConstants_packet_length),
+                                           LOG_SEGMENT(logConstants_packet_address),
+                                           LOG_SEGMENT(logConstants_packet_type),
+                                           LOG_SEGMENT(logConstants_packet_frame),
+                                           LOG_SEGMENT(logConstants_packet_raw)};
+
+const uint8_t logConstants_packetType_acknowledge[] = "ACKNOWLEDGE";
+const uint8_t logConstants_packetType_event[] = "EVENT";
+const uint8_t logConstants_packetType_measureReport[] = "MEASURE_REPORT";
+const uint8_t logConstants_packetType_rawReport[] = "RAW_REPORT";
+const uint8_t logConstants_packetType_calibration[] = "CALIBRATION";
+
+const logSegment_t logSegments_packetType[] = {LOG_SEGMENT(logConstants_packetType_acknowledge),
+                                               LOG_SEGMENT(logConstants_packetType_event),
+                                               LOG_SEGMENT(logConstants_packetType_measureReport),
+                                               LOG_SEGMENT(logConstants_packetType_rawReport),
+                                               LOG_SEGMENT(logConstants_packetType_calibration)};
+
+const uint8_t logConstants_cycleTiming[] = "\n\n\n\nPrevious Cycle (us)";
+
+const uint8_t logConstants_cycleStage_resultsReady[] = "\n  Results Ready:  ";
+const uint8_t logConstants_cycleStage_radioWake[] = "\n     Radio Wake:  ";
+const uint8_t logConstants_cycleStage_frameLoaded[] = "\n   Frame Loaded:  ";
+const uint8_t logConstants_cycleStage_frameSent[] = "\n     Frame Sent:  ";
+const uint8_t logConstants_cycleStage_logSent[] = "\n       Log Sent:  ";
+
+const logSegment_t logSegments_cycleTiming[] = {LOG_SEGMENT(logConstants_cycleTiming),  //Heading, followed by the label of each stage
+                                                LOG_SEGMENT(logConstants_cycleStage_resultsReady),
+                                                LOG_SEGMENT(logConstants_cycleStage_radioWake),
+                                                LOG_SEGMENT(logConstants_cycleStage_frameLoaded),
+                                                LOG_SEGMENT(logConstants_cycleStage_frameSent),
+                                                LOG_SEGMENT(logConstants_cycleStage_logSent)};
+
+const uint8_t logConstants_cycleCharge[] = "\n\n\n\nPrevious Cycle Charge (nC)";
+const uint8_t logConstants_clockPolicy[] = "\n         Policy:  ";
+const uint8_t logConstants_chargeSleep[] = "\n          Sleep:  ";
+const uint8_t logConstants_chargeTotal[] = "\n          Total:  ";
+
+const logSegment_t logSegments_cycleCharge[] = {LOG_SEGMENT(logConstants_cycleCharge),
+                                                LOG_SEGMENT(logConstants_clockPolicy),
+                                                LOG_SEGMENT(logConstants_chargeSleep),
+                                                LOG_SEGMENT(logConstants_chargeTotal)};
+
+const uint8_t logConstants_clockPolicy_fixed[] = "FIXED";
+const uint8_t logConstants_clockPolicy_governed[] = "GOVERNED";
+const uint8_t logConstants_clockPolicy_raceToIdle[] = "RACE_TO_IDLE";
+
+const logSegment_t logSegments_clockPolicy[] = {LOG_SEGMENT(logConstants_clockPolicy_fixed),
+                                                LOG_SEGMENT(logConstants_clockPolicy_governed),
+                                                LOG_SEGMENT(logConstants_clockPolicy_raceToIdle)};
+
+const uint8_t logConstants_operatingPoint_1MHz[] = "\n           1MHz:  ";
+const uint8_t logConstants_operatingPoint_4MHz[] = "\n           4MHz:  ";
+const uint8_t logConstants_operatingPoint_16MHz[] = "\n          16MHz:  ";
+const uint8_t logConstants_operatingPoint_40MHz[] = "\n          40MHz:  ";
+
+const logSegment_t logSegments_operatingPoint[] = {LOG_SEGMENT(logConstants_operatingPoint_1MHz),
+                                                   LOG_SEGMENT(logConstants_operatingPoint_4MHz),
+                                                   LOG_SEGMENT(logConstants_operatingPoint_16MHz),
+                                                   LOG_SEGMENT(logConstants_operatingPoint_40MHz)};
+
+const uint8_t logConstants_profile[] = "\n\n\n\nProbe Profile (Count cycles)";
+const uint8_t logConstants_profile_probeCost[] = "\n     Probe Cost:  ";
+const uint8_t logConstants_profile_biasRemoved[] = "\n   Bias Removed:  ";
+
+const logSegment_t logSegments_profile[] = {LOG_SEGMENT(logConstants_profile),
+                                            LOG_SEGMENT(logConstants_profile_probeCost),
+                                            LOG_SEGMENT(logConstants_profile_biasRemoved)};
+
+const uint8_t logConstants_probe_task[] = "\n\nTask ";
+const uint8_t logConstants_probe_count[] = "\n          Count:  ";
+const uint8_t logConstants_probe_min[] = "\n            Min:  ";
+const uint8_t logConstants_probe_mean[] = "\n           Mean:  ";
+const uint8_t logConstants_probe_max[] = "\n            Max:  ";
+const uint8_t logConstants_probe_histogram[] = "\n      Histogram: ";
+
+const logSegment_t logSegments_probe[] = {LOG_SEGMENT(logConstants_probe_task),  //Heading of task probes, followed by the label of each statistic
+                                          LOG_SEGMENT(logConstants_probe_count),
+                                          LOG_SEGMENT(logConstants_probe_min),
+                                          LOG_SEGMENT(logConstants_probe_mean),
+                                          LOG_SEGMENT(logConstants_probe_max),
+                                          LOG_SEGMENT(logConstants_probe_histogram)};
+
+const uint8_t logConstants_probeName_i2cTransaction[] = "\n\nI2C Transaction";
+const uint8_t logConstants_probeName_spiTransaction[] = "\n\nSPI Transaction";
+const uint8_t logConstants_probeName_i2c2ISR[] = "\n\nI2C2 ISR";
+const uint8_t logConstants_probeName_dma0ISR[] = "\n\nDMA0 ISR";
+const uint8_t logConstants_probeName_dma1ISR[] = "\n\nDMA1 ISR";
+const uint8_t logConstants_probeName_spi1ISR[] = "\n\nSPI1 ISR";
+const uint8_t logConstants_probeName_timer1ISR[] = "\n\nTimer1 ISR";
+const uint8_t logConstants_probeName_rtccISR[] = "\n\nRTCC ISR";
+const uint8_t logConstants_probeName_int3ISR[] = "\n\nINT3 ISR";
+const uint8_t logConstants_probeName_dma2ISR[] = "\n\nDMA2 ISR";
+const uint8_t logConstants_probeName_uart2ISR[] = "\n\nUART2 ISR";
+const uint8_t logConstants_probeName_int4ISR[] = "\n\nINT4 ISR";
+const uint8_t logConstants_probeName_changeNoticeISR[] = "\n\nChange Notice ISR";
+
+const logSegment_t logSegments_probeName[] = {LOG_SEGMENT(logConstants_probeName_i2cTransaction),  //Indexed from PROBE_I2C_TRANSACTION, the probes of the tasks come before it
+                                              LOG_SEGMENT(logConstants_probeName_spiTransaction),
+                                              LOG_SEGMENT(logConstants_probeName_i2c2ISR),
+                                              LOG_SEGMENT(logConstants_probeName_dma0ISR),
+                                              LOG_SEGMENT(logConstants_probeName_dma1ISR),
+                                              LOG_SEGMENT(logConstants_probeName_spi1ISR),
+                                              LOG_SEGMENT(logConstants_probeName_timer1ISR),
+                                              LOG_SEGMENT(logConstants_probeName_rtccISR),
+                                              LOG_SEGMENT(logConstants_probeName_int3ISR),
+                                              LOG_SEGMENT(logConstants_probeName_dma2ISR),
+                                              LOG_SEGMENT(logConstants_probeName_uart2ISR),
+                                              LOG_SEGMENT(logConstants_probeName_int4ISR),
+                                              LOG_SEGMENT(logConstants_probeName_changeNoticeISR)};
+
+
+
+#ifdef LOG_BINARY
+/*******************************
+ *  Binary Record Descriptors  *
+ *******************************/
+
+const logRecordDescriptor_t logRecordDescriptors[] = {{0x03, {0x02, 0x02, 0x04}},                     //LOG_RECORD_MEASUREMENT, temperature (centi-C), humidity (centi-%) and pressure (centi-Pa)
+                                                      {0x00, {0x00}},                                 //LOG_RECORD_PACKET, the raw bytes of the packet
+                                                      {0x05, {0x04, 0x04, 0x04, 0x04, 0x04}},         //LOG_RECORD_TIMING, Timer 1 ticks from the start of the cycle to each of its stages
+                                                      {0x06, {0x01, 0x04, 0x04, 0x04, 0x04, 0x04}},   //LOG_RECORD_CHARGE, clock policy, charge (nC) at each operating point and charge (nC) in SLEEP
+                                                      {0x02, {0x04, 0x04}},                           //LOG_RECORD_PROFILE, Count cycles added by a probe and Count cycles taken off every sample
+                                                      {0x00, {0x00}}};                                //LOG_RECORD_PROBE, probe, count, min, mean and max (4 bytes each) followed by each histogram bucket (2 bytes each)
+#endif
+
+
+
+/***************
+ *  Log Queue  *
+ ***************/
+
+uint8_t logQueueSlots[LOG_QUEUE_SLOTS][LOG_SLOT_SIZE];  //Buffers that the logs are constructed into, DMA 2 sends them out over UART2 straight from here
+volatile uint32_t logQueueLengths[LOG_QUEUE_SLOTS];     //Length of the log committed into each slot, 0 while the slot is free or still being constructed into
+volatile uint32_t logQueueHead = 0x00000000;            //Index of the oldest slot in the queue, the one being sent while logQueueSending is set
+volatile uint32_t logQueueCount = 0x00000000;           //Number of slots currently reserved or committed
+volatile uint32_t logQueueSending = 0x00000000;         //Non-zero while DMA 2 is working its way through the committed slots
+volatile uint32_t logQueueDropped = 0x00000000;         //Number of logs dropped because every slot of the log queue was taken
+
+
+
+#ifndef LOG_BINARY
+/****************************
+ *  Construction Functions  *
+ ****************************/
+
+
+//Construct Measurement Log Function, constructs a new string to log the provided measurement results
+uint32_t constructMeasurementLog(uint8_t *stringBuffer, const int32_t *temperature, const int32_t *humidity, const int32_t *pressure)
+{
+    logCursor_t cursor;                 //Write cursor into the string buffer
+    uint32_t magnitude = *temperature;  //Magnitude of the temperature in hundredths of a degree, the sign is written separately
+
+    openLogCursor(&cursor, stringBuffer, LOG_SLOT_SIZE);               //Start writing at the beginning of the string buffer
+    emitSegment(&cursor, &logSegments_measurementReport[0x00000000]);  //Add the heading of the measurement report along with the temperature label
+
+    //Handle scenarios where the temperature is actually a negative
+    if (*temperature < 0x00000000)
+    {
+        emitCharacter(&cursor, 0x2D);  //Add a minus character to indicate the negative number
+        magnitude = -*temperature;     //Carry on with the magnitude of the temperature
+    }
 
-const uint8_t logConstants_packetType_acknowledge[] = "ACKNOWLEDGE\0";
-const uint8_t logConstants_packetType_event[] = "EVENT\0";
-const uint8_t logConstants_packetType_measureReport[] = "MEASURE_REPORT\0";
+    emitUnsigned(&cursor, magnitude / 0x00000064);  //Add the whole number portion of the temperature
 
-const uint8_t *logConstants_packetTypeLookup[] = {logConstants_packetType_acknowledge,
-                                                  logConstants_packetType_event,
-                                                  logConstants_packetType_measureReport};
+    //Only add the decimal point and digits when actually required, otherwise don't bother
+    if (magnitude % 0x00000064)
+    {
+        emitCharacter(&cursor, 0x2E);                   //Place the decimal point right after the whole number portion
+        emitUnsigned(&cursor, magnitude % 0x00000064);  //Add the decimal portion of the temperature
+    }
 
+    emitSegment(&cursor, &logSegments_measurementReport[0x00000001]);  //Add the temperature unit along with the humidity label
+    emitUnsigned(&cursor, (*humidity + 0x00000032) / 0x00000064);      //Add the measured RH in whole percent, rounded to the nearest
+    emitSegment(&cursor, &logSegments_measurementReport[0x00000002]);  //Add the humidity unit along with the pressure label
+    emitUnsigned(&cursor, *pressure / 0x00000064);                     //Add the measured pressure in whole Pascals
+    emitSegment(&cursor, &logSegments_measurementReport[0x00000003]);  //Add the pressure unit to finish off the report
 
+    return closeLogCursor(&cursor);  //Leave the function returning the final length of the constructed string
+}
+
+//Construct Packet Log Function, constructs a new string to log the provided packet bytes
+uint32_t constructPacketLog(uint8_t *stringBuffer, const uint8_t *packetBytes)
+{
+    logCursor_t cursor;  //Write cursor into the string buffer
+
+    openLogCursor(&cursor, stringBuffer, LOG_SLOT_SIZE);                                       //Start writing at the beginning of the string buffer
+    emitSegment(&cursor, &logSegments_packet[0x00000000]);                                     //Add the heading of the packet log along with the length label
+    emitUnsigned(&cursor, packetBytes[0x00000000]);                                            //Add the size of the packet
+    emitSegment(&cursor, &logSegments_packet[0x00000001]);                                     //Add the address label
+    emitUnsigned(&cursor, packetBytes[0x00000001]);                                            //Add the address of the packet
+    emitSegment(&cursor, &logSegments_packet[0x00000002]);                                     //Add the type label
+    emitSegment(&cursor, &logSegments_packetType[packetBytes[0x00000002]]);                    //Add the name of the packet type
+    emitSegment(&cursor, &logSegments_packet[0x00000003]);                                     //Add the frame number label
+    emitUnsigned(&cursor, (packetBytes[0x00000003] << 0x00000008) | packetBytes[0x00000004]);  //Add the frame number of the packet
+    emitSegment(&cursor, &logSegments_packet[0x00000004]);                                     //Add the label of the raw bytes
+
+    //Create a series of hexadecimal translations of the raw packet
+    for (uint32_t counter = packetBytes[0x00000000]; counter; counter--)
+    {
+        emitCharacter(&cursor, 0x20);            //Append a space just before the hexadecimal digits
+        emitHexByte(&cursor, *(packetBytes++));  //Append the next byte of the packet as hexadecimal
+    }
+
+    return closeLogCursor(&cursor);  //Leave the function returning the final length of the constructed string
+}
+
+//Construct Timing Log Function, constructs a new string listing how long into the previous measurement cycle each of its stages was reached
+uint32_t constructTimingLog(uint8_t *stringBuffer, const uint32_t *stageTicks, uint32_t stageCount)
+{
+    logCursor_t cursor;  //Write cursor into the string buffer
+
+    openLogCursor(&cursor, stringBuffer, LOG_SLOT_SIZE);         //Start writing at the beginning of the string buffer
+    emitSegment(&cursor, &logSegments_cycleTiming[0x00000000]);  //Add the heading of the timing log
+
+    //Add a line for each stage, giving the time at which it was reached in microseconds from the start of the cycle
+    for (uint32_t stage = 0x00000000; stage < stageCount; stage++)
+    {
+        emitSegment(&cursor, &logSegments_cycleTiming[stage + 0x00000001]);                         //Add the label of the stage
+        emitUnsigned(&cursor, (uint32_t) (((uint64_t) stageTicks[stage] * 0x3D09) >> 0x00000009));  //Convert the Timer 1 ticks (1/32768s) into microseconds, multiplying by 15625/512
+    }
+
+    return closeLogCursor(&cursor);  //Leave the function returning the final length of the constructed string
+}
+
+//Construct Charge Log Function, constructs a new string listing the charge drawn by the previous measurement cycle at each operating point, in SLEEP and in total
+uint32_t constructChargeLog(uint8_t *stringBuffer, uint32_t clockPolicy, const uint32_t *pointCharge, uint32_t pointCount, uint32_t sleepCharge)
+{
+    logCursor_t cursor;                  //Write cursor into the string buffer
+    uint32_t totalCharge = sleepCharge;  //Sum of the charge drawn across the whole cycle
 
+    openLogCursor(&cursor, stringBuffer, LOG_SLOT_SIZE);          //Start writing at the beginning of the string buffer
+    emitSegment(&cursor, &logSegments_cycleCharge[0x00000000]);   //Add the heading of the charge log
+    emitSegment(&cursor, &logSegments_cycleCharge[0x00000001]);   //Add the policy label
+    emitSegment(&cursor, &logSegments_clockPolicy[clockPolicy]);  //Name the clock policy that was in use
+
+    //Add a line for each operating point, giving the charge drawn while running or resting at it
+    for (uint32_t point = 0x00000000; point < pointCount; point++)
+    {
+        emitSegment(&cursor, &logSegments_operatingPoint[point]);  //Add the label of the operating point
+        emitUnsigned(&cursor, pointCharge[point]);                 //Add the charge drawn at it
+        totalCharge += pointCharge[point];                         //Add the charge onto the total for the cycle
+    }
+
+    //Finish off with the charge drawn in SLEEP and the total for the whole cycle
+    emitSegment(&cursor, &logSegments_cycleCharge[0x00000002]);  //Add the SLEEP label
+    emitUnsigned(&cursor, sleepCharge);                          //Add the charge drawn in SLEEP
+    emitSegment(&cursor, &logSegments_cycleCharge[0x00000003]);  //Add the total label
+    emitUnsigned(&cursor, totalCharge);                          //Add the total charge
+
+    return closeLogCursor(&cursor);  //Leave the function returning the final length of the constructed string
+}
+
+//Construct Profile Log Function, constructs a new string heading a profiler dump with the overhead of a probe
+uint32_t constructProfileLog(uint8_t *stringBuffer, uint32_t probeCycles, uint32_t biasCycles)
+{
+    logCursor_t cursor;  //Write cursor into the string buffer
+
+    openLogCursor(&cursor, stringBuffer, LOG_SLOT_SIZE);     //Start writing at the beginning of the string buffer
+    emitSegment(&cursor, &logSegments_profile[0x00000000]);  //Add the heading of the profiler dump
+    emitSegment(&cursor, &logSegments_profile[0x00000001]);  //Add the probe cost label
+    emitUnsigned(&cursor, probeCycles);                      //Add the Count cycles each pass adds to the code around a probe
+    emitSegment(&cursor, &logSegments_profile[0x00000002]);  //Add the bias label
+    emitUnsigned(&cursor, biasCycles);                       //Add the Count cycles taken off every sample
+
+    return closeLogCursor(&cursor);  //Leave the function returning the final length of the constructed string
+}
+
+//Construct Probe Log Function, constructs a new string listing the statistics gathered by the given profiler probe
+uint32_t constructProbeLog(uint8_t *stringBuffer, profilerProbe_t probe, const profilerProbeStats_t *stats)
+{
+    logCursor_t cursor;  //Write cursor into the string buffer
+
+    openLogCursor(&cursor, stringBuffer, LOG_SLOT_SIZE);  //Start writing at the beginning of the string buffer
+
+    //Head the log with the name of the probe, the tasks are only known to the profiler by their number
+    if (probe < PROFILER_TASK_PROBES)
+    {
+        emitSegment(&cursor, &logSegments_probe[0x00000000]);  //Add the task heading
+        emitUnsigned(&cursor, probe);                          //Add the number of the task
+    }
+    else emitSegment(&cursor, &logSegments_probeName[probe - PROFILER_TASK_PROBES]);
+
+    emitSegment(&cursor, &logSegments_probe[0x00000001]);                   //Add the count label
+    emitUnsigned(&cursor, stats->count);                                    //Add the number of passes
+    emitSegment(&cursor, &logSegments_probe[0x00000002]);                   //Add the min label
+    emitUnsigned(&cursor, stats->minCycles);                                //Add the fewest cycles
+    emitSegment(&cursor, &logSegments_probe[0x00000003]);                   //Add the mean label
+    emitUnsigned(&cursor, (uint32_t) (stats->totalCycles / stats->count));  //Add the mean cycles, only probes that have been passed through are logged
+    emitSegment(&cursor, &logSegments_probe[0x00000004]);                   //Add the max label
+    emitUnsigned(&cursor, stats->maxCycles);                                //Add the most cycles
+    emitSegment(&cursor, &logSegments_probe[0x00000005]);                   //Add the histogram label
+
+    //Add the number of passes within each bucket of the histogram
+    for (uint32_t bucket = 0x00000000; bucket < PROFILER_HISTOGRAM_BUCKETS; bucket++)
+    {
+        emitCharacter(&cursor, 0x20);                     //Append a space just before the count
+        emitUnsigned(&cursor, stats->histogram[bucket]);  //Append the count of the bucket
+    }
+
+    return closeLogCursor(&cursor);  //Leave the function returning the final length of the constructed string
+}
+#else
 /****************************
  *  Construction Functions  *
  ****************************/
 
 
-//Construct Measurement Log Function, constructs a new string to log the provided measurement results
-uint32_t constructMeasurementLog(uint8_t *stringBuffer, const float *temperature, const float *humidity, const float *pressure)
+//Construct Measurement Log Function, constructs a new measurement record holding the provided measurement results
+uint32_t constructMeasurementLog(uint8_t *stringBuffer, const int32_t *temperature, const int32_t *humidity, const int32_t *pressure)
 {
-    int32_t dataBuffer;     //Reserve a new 32-bit variable in RAM to use for doing number manipulation while creating the measurement report
-    uint32_t stringLength;  //Create a new variable to use for tracking the length of the string being constructed
+    uint32_t fields[] = {*temperature, *humidity, *pressure};  //Fields of the record in the order given by its descriptor
 
-    memcpy(stringBuffer, logConstants_measurementReport, 0x00000020);  //Copy the first part of the measurement report string into the string buffer
-    stringLength = 0x00000020;                                         //Set the starting length of the string to 32 characters
-    dataBuffer = (*temperature * 100.0F);                              //Multiply the most recent temperature measurement by 100, then store it in the dataBuffer with no decimal
+    return constructRecord(stringBuffer, LOG_RECORD_MEASUREMENT, fields, NULL, 0x00000000);  //Frame the results into a measurement record
+}
 
-    //Handle scenarios where the value of dataBuffer is actually a negative
-    if (dataBuffer < 0x00000000)
+//Construct Packet Log Function, constructs a new packet record holding the provided packet bytes
+uint32_t constructPacketLog(uint8_t *stringBuffer, const uint8_t *packetBytes)
+{
+    return constructRecord(stringBuffer, LOG_RECORD_PACKET, NULL, packetBytes, *packetBytes);  //Frame the whole packet into a packet record, its first byte is its length
+}
+
+//Construct Timing Log Function, constructs a new timing record holding the Timer 1 ticks into the previous measurement cycle at which each of its stages was reached
+uint32_t constructTimingLog(uint8_t *stringBuffer, const uint32_t *stageTicks, uint32_t stageCount)
+{
+    return constructRecord(stringBuffer, LOG_RECORD_TIMING, stageTicks, NULL, 0x00000000);  //The ticks are converted into microseconds by the receiver
+}
+
+//Construct Charge Log Function, constructs a new charge record holding the charge drawn by the previous measurement cycle at each operating point and in SLEEP
+uint32_t constructChargeLog(uint8_t *stringBuffer, uint32_t clockPolicy, const uint32_t *pointCharge, uint32_t pointCount, uint32_t sleepCharge)
+{
+    uint32_t fields[LOG_RECORD_MAX_FIELDS];  //Fields of the record in the order given by its descriptor
+
+    fields[0x00000000] = clockPolicy;                                                                                //The clock policy leads the record
+    for (uint32_t point = 0x00000000; point < pointCount; point++) fields[point + 0x00000001] = pointCharge[point];  //Followed by the charge at each operating point
+    fields[pointCount + 0x00000001] = sleepCharge;                                                                   //Finished off by the charge in SLEEP, the receiver works out the total
+
+    return constructRecord(stringBuffer, LOG_RECORD_CHARGE, fields, NULL, 0x00000000);  //Frame the charges into a charge record
+}
+
+//Construct Profile Log Function, constructs a new profile record holding the overhead of a probe, heading a profiler dump
+uint32_t constructProfileLog(uint8_t *stringBuffer, uint32_t probeCycles, uint32_t biasCycles)
+{
+    uint32_t fields[] = {probeCycles, biasCycles};  //Fields of the record in the order given by its descriptor
+
+    return constructRecord(stringBuffer, LOG_RECORD_PROFILE, fields, NULL, 0x00000000);  //Frame the overhead into a profile record
+}
+
+//Construct Probe Log Function, constructs a new probe record holding the statistics gathered by the given profiler probe
+uint32_t constructProbeLog(uint8_t *stringBuffer, profilerProbe_t probe, const profilerProbeStats_t *stats)
+{
+    uint8_t payload[0x00000011 + (PROFILER_HISTOGRAM_BUCKETS << 0x00000001)];                                                //Probe, four 4 byte statistics and the 2 byte buckets
+    uint32_t values[] = {stats->count, stats->minCycles, (uint32_t) (stats->totalCycles / stats->count), stats->maxCycles};  //Statistics in the order they are sent
+    uint8_t *byte = payload;                                                                                                 //Next byte of the payload to fill in
+
+    //The histogram doesn't fit within the fields of a descriptor, so the payload is laid out here as a run of raw bytes, MSB first like the fields
+    *byte++ = probe;
+    for (uint32_t value = 0x00000000; value < 0x00000004; value++)
+    {
+        for (uint32_t width = 0x00000004; width; width--) *byte++ = values[value] >> ((width - 0x00000001) << 0x00000003);
+    }
+    for (uint32_t bucket = 0x00000000; bucket < PROFILER_HISTOGRAM_BUCKETS; bucket++)
     {
-        stringBuffer[stringLength++] = 0x2D;  //Add a minus character to the string buffer to indicate the negative number
-        dataBuffer = -dataBuffer;             //Force the contents of dataBuffer back into the positives again
+        *byte++ = stats->histogram[bucket] >> 0x00000008;
+        *byte++ = stats->histogram[bucket];
     }
 
-    uintToDecString(dataBuffer / 0x00000064, stringBuffer + stringLength);  //Convert the whole number portion of the temperature into a string and put it into the string buffer
-    stringLength = strlen(stringBuffer);                                    //Find the new length of the string with the whole number added into it
-    dataBuffer %= 0x00000064;                                               //Modulo the contents of dataBuffer by 100, storing the result back into the dataBuffer variable
+    return constructRecord(stringBuffer, LOG_RECORD_PROBE, NULL, payload, byte - payload);  //Frame the statistics into a probe record
+}
 
-    //Only add the decimal point and digits when actually required, otherwise don't bother
-    if (dataBuffer)
+//Construct Record Function, frames the provided fields or raw bytes into a binary record of the given type, returning the length of the record
+uint32_t constructRecord(uint8_t *recordBuffer, logRecordType_t type, const uint32_t *fields, const uint8_t *bytes, uint32_t byteCount)
+{
+    const logRecordDescriptor_t *descriptor = &logRecordDescriptors[type];  //Layout of the payload of the record
+    uint32_t recordLength = LOG_RECORD_HEADER_LENGTH;                       //Create a new variable to use for tracking the length of the record being constructed
+    uint32_t timestamp = getTimeScheduler();                                //Scheduler time at which the record is being built
+    uint16_t crc;                                                           //CRC-16 of the record
+
+    //Write each field MSB first, using only as many bytes as the descriptor gives it
+    for (uint32_t field = 0x00000000; field < descriptor->fieldCount; field++)
     {
-        stringBuffer[stringLength++] = 0x2E;                                    //Place the decimal point right after the whole number portion
-        uintToDecString(dataBuffer % 0x00000064, stringBuffer + stringLength);  //Convert the decimal portion of the temperature into a string and put it into the string buffer
-        stringLength = strlen(stringBuffer);                                    //Find the new length of the string with the decimal places added into it
+        for (uint32_t width = descriptor->fieldWidths[field]; width; width--) recordBuffer[recordLength++] = fields[field] >> ((width - 0x00000001) << 0x00000003);
     }
 
-    memcpy(stringBuffer + stringLength, logConstants_measurementReport + 0x00000020, 0x00000013);  //Load the next segment of the report string into the buffer
-    stringLength += 0x00000013;                                                                    //Add the appropriate amount to stringLength to compensate for the added characters
-    uintToDecString((uint32_t) *humidity, stringBuffer + stringLength);                            //Convert the measured RH into it's string equivalent and append it to the string buffer
-    stringLength = strlen(stringBuffer);                                                           //Find the new length of the string with the humidity measurement added in
+    //Cut the raw bytes short when they would run the record past the end of its slot, leaving room for the CRC, the same as the text logs are
+    if (byteCount > LOG_SLOT_SIZE - LOG_RECORD_CRC_LENGTH - recordLength) byteCount = LOG_SLOT_SIZE - LOG_RECORD_CRC_LENGTH - recordLength;
 
-    memcpy(stringBuffer + stringLength, logConstants_measurementReport + 0x00000033, 0x00000013);  //Load the next segment of the report string into the buffer
-    stringLength += 0x00000013;                                                                    //Add the appropriate amount to stringLength to compensate for the added characters
-    uintToDecString((uint32_t) *pressure, stringBuffer + stringLength);                            //Convert the measured pressure into a string and append it to the string buffer
-    stringLength = strlen(stringBuffer);                                                           //Find the new length of the string with the barometric pressure value added
+    memcpy(recordBuffer + recordLength, bytes, byteCount);  //Follow the fields with the raw bytes, records have one or the other
+    recordLength += byteCount;                              //Add the appropriate amount to recordLength to compensate for the added bytes
 
-    memcpy(stringBuffer + stringLength, logConstants_measurementReport + 0x00000046, 0x00000004);  //Add the final part of the report string into the buffer
-    stringLength += 0x00000004;                                                                    //Add the appropriate amount to stringLength to compensate for the added characters
+    //Fill the header in now that the length of the payload is known
+    recordBuffer[0x00000000] = LOG_RECORD_SYNC;                          //Sync byte marking the start of the record
+    recordBuffer[0x00000001] = type;                                     //Type of the record, picks the descriptor used to decode the payload
+    recordBuffer[0x00000002] = recordLength - LOG_RECORD_HEADER_LENGTH;  //Length of the payload
+    recordBuffer[0x00000003] = timestamp >> 0x00000018;                  //Timestamp, MSB first
+    recordBuffer[0x00000004] = timestamp >> 0x00000010;
+    recordBuffer[0x00000005] = timestamp >> 0x00000008;
+    recordBuffer[0x00000006] = timestamp;
 
-    return stringLength;  //Leave the function returning the final length of the constructed string
+    crc = calculateCRC16(recordBuffer + 0x00000001, recordLength - 0x00000001);  //Protect everything after the sync byte
+    recordBuffer[recordLength++] = crc >> 0x00000008;                            //Close the record off with the CRC, MSB first
+    recordBuffer[recordLength++] = crc;
+
+    return recordLength;  //Leave the function returning the final length of the constructed record
 }
+#endif
 
-//Construct Packet Log Function, constructs a new string to log the provided packet bytes
-uint32_t constructPacketLog(uint8_t *stringBuffer, const uint8_t *packetBytes)
+
+
+/*************************
+ *  Log Queue Functions  *
+ *************************/
+
+
+//Reserve Log Slot Function, hands out the next free slot of the log queue to construct a log into, returning NULL and counting the log as dropped when the queue is full
+uint8_t *reserveLogSlot()
 {
-    uint32_t stringLength;                          //Create a new variable to use for tracking the length of the string being constructed
-    uint32_t counter = *packetBytes;                //Store the size of the provided packet locally in a new variable to use for later
-    uint32_t dataBuffer = packetBytes[0x00000001];  //Reserve a new 32-bit variable in RAM to use for doing number manipulation while creating the log message
+    uint32_t interruptState;  //Create a variable to use for preserving the state of the interrupts
+    uint8_t *slot = NULL;     //Slot being handed out, left as NULL when there are none free
 
-    memcpy(stringBuffer, logConstants_packet, 0x00000015);  //Copy the first part of the packet log string into the string buffer
-    stringLength = 0x00000015;                              //Set the starting length of the string to 22 characters
-    uintToDecString(counter, stringBuffer + stringLength);  //Put the decimal representation of the packet size
-    stringLength = strlen(stringBuffer);                    //Find the new length of the string with the packet size added in
+    asm volatile ("di %0" : "=r" (interruptState));  //Disable interrupts while taking the slot, the DMA 2 interrupt frees slots from the head of the queue
+    if (logQueueCount < LOG_QUEUE_SLOTS)
+    {
+        slot = logQueueSlots[(logQueueHead + logQueueCount) & (LOG_QUEUE_SLOTS - 0x00000001)];  //The next free slot follows on from the last one reserved
+        logQueueCount++;                                                                        //Count the slot as taken until it has been sent
+    }
+    else logQueueDropped++;                                //Drop the log rather than waiting on the UART for a slot to free up
+    if (interruptState & 0x00000001) asm volatile ("ei");  //Restore the interrupts if they were enabled before entering the function
 
-    memcpy(stringBuffer + stringLength, logConstants_packet + 0x00000015, 0x0000000D);  //Load the next segment of the log string into the buffer
-    stringLength += 0x0000000D;                                                         //Add the appropriate amount to stringLength to compensate for the added characters
-    uintToDecString(dataBuffer, stringBuffer + stringLength);                           //Convert the destination address value into it's decimal form and append it to the string buffer
-    stringLength = strlen(stringBuffer);                                                //Find the new length of the string with the destination address added
+    return slot;  //Return the reserved slot, or NULL when the log has to be dropped
+}
 
-    uint8_t *typeString = (uint8_t *) logConstants_packetTypeLookup[packetBytes[0x00000002]];  //Create a pointer that points to the string that represents the packet type
-    memcpy(stringBuffer + stringLength, logConstants_packet + 0x00000022, 0x0000000D);         //Load the next segment of the log string into the buffer
-    stringLength += 0x0000000D;                                                                //Add the appropriate amount to stringLength to compensate for the added characters
-    memcpy(stringBuffer + stringLength, typeString, strlen(typeString) + 0x00000001);          //Copy the string constants that represents the packet type into the buffer
-    stringLength = strlen(stringBuffer);                                                       //Find the new length of the string with the packet type added
+//Commit Log Slot Function, queues the log constructed into the provided slot to be sent, starting DMA 2 right away when it is idle
+void commitLogSlot(uint8_t *slot, uint32_t length)
+{
+    uint32_t interruptState;                                              //Create a variable to use for preserving the state of the interrupts
+    uint32_t index = (slot - logQueueSlots[0x00000000]) / LOG_SLOT_SIZE;  //Index of the slot within the queue
 
-    memcpy(stringBuffer + stringLength, logConstants_packet + 0x0000002F, 0x0000000D);  //Load the next segment of the log string into the buffer
-    stringLength += 0x0000000D;                                                         //Add the appropriate amount to stringLength to compensate for the added characters
-    dataBuffer = (packetBytes[0x00000003] << 0x00000008) | packetBytes[0x00000004];     //Combine the next 3 bytes of the packet to calculate the frame number of the packet
-    uintToDecString(dataBuffer, stringBuffer + stringLength);                           //Convert the frame number into it's decimal form and append it to the string buffer
-    stringLength = strlen(stringBuffer);                                                //Find the new length of the string with the frame number added
+    asm volatile ("di %0" : "=r" (interruptState));  //Disable interrupts so that the DMA 2 interrupt can't chain the slot at the same time as it is started here
+    logQueueLengths[index] = length;                 //Mark the slot as ready to send
 
-    memcpy(stringBuffer + stringLength, logConstants_packet + 0x0000003C, 0x0000000C);  //Load the next segment of the log string into the buffer
-    stringLength += 0x0000000C;                                                         //Add the appropriate amount to stringLength to compensate for the added characters
+    //Logs go out in the order their slots were reserved, so DMA 2 is only started from here when it is idle and this slot is at the head of the queue
+    if (!logQueueSending && (index == logQueueHead))
+    {
+        logQueueSending = 0x00000001;  //The DMA 2 interrupt takes over from here, chaining on every slot committed by the time it fires
+        holdAwake();                   //Keep the peripheral clocks running until DMA 2 has sent everything in the queue
+        startTxUART(slot, &length);    //Start sending the log
+    }
 
-    //Create a series of hexadecimal translations of the raw packet
-    while (counter--)
+    if (interruptState & 0x00000001) asm volatile ("ei");  //Restore the interrupts if they were enabled before entering the function
+}
+
+//Service Log Queue Function, frees the slot DMA 2 has just sent and chains the next committed one into the transfer, called from the DMA 2 interrupt
+void serviceLogQueue()
+{
+    uint32_t length;  //Length of the log in the next slot, 0 when it hasn't been committed yet
+
+    logQueueLengths[logQueueHead] = 0x00000000;                                   //Free the slot that has just been sent
+    logQueueHead = (logQueueHead + 0x00000001) & (LOG_QUEUE_SLOTS - 0x00000001);  //Move the head of the queue onto the next slot
+    logQueueCount--;                                                              //One less slot in the queue
+
+    length = logQueueLengths[logQueueHead];                                          //See whether the next slot is ready to go
+    if (logQueueCount && length) startTxUART(logQueueSlots[logQueueHead], &length);  //Chain it straight on without waiting for UART2 to empty out
+    else drainTxUART();                                                              //Have the UART2 TX interrupt call finishLogQueue() once the last byte has left the shift register
+}
+
+//Finish Log Queue Function, chains on a log committed while the last bytes went out or lets go of UART2, the DMA and the awake hold, called from the UART2 TX interrupt
+uint32_t finishLogQueue()
+{
+    uint32_t length = logQueueLengths[logQueueHead];  //Length of the log in the next slot, 0 when it hasn't been committed yet
+
+    if (logQueueCount && length) startTxUART(logQueueSlots[logQueueHead], &length);  //Carry on with the same transmission, commits leave starting DMA 2 to the interrupts until logQueueSending is cleared
+    else
     {
-        stringBuffer[stringLength++] = 0x20;                             //Append a space just before the hexadecimal string
-        byteToHexString(*(packetBytes++), stringBuffer + stringLength);  //Convert the next byte of the packet into it's string hexadecimal representation and append it to stringBuffer
-        stringLength += 0x00000002;                                      //Increment the value of the stringLength variable by 2 to compensate for the 2 newly added bytes
+        completeTxUART();              //Let go of UART2 and the DMA now that the last byte has gone out
+        logQueueSending = 0x00000000;  //The next commit has to start DMA 2 up again
+        releaseAwake();                //The peripheral clocks are no longer needed for the logs, so let the MCU sleep again
     }
 
-    stringBuffer[stringLength++] = 0x00;  //Null terminate the end of the string
-    return stringLength;                  //Leave the function returning the final length of the constructed string
+    return logQueueCount;  //Return the number of slots still in the queue, 0 when every log has been sent
 }
 
+//Flush Log Queue Function, idles the CPU until every committed log has gone out over UART2, only for use from tasks
+void flushLogQueue()
+{
+    waitWhileBusy(&logQueueSending);  //The UART2 TX interrupt clears the flag once the last byte has gone out with no committed slot left to chain on
+}
 
 
-/***********************
- *  Utility Functions  *
- ***********************/
 
+/**************************
+ *  Formatting Functions  *
+ **************************/
+
+
+//Open Log Cursor Function, points the provided cursor at the start of an empty buffer of the given size
+void openLogCursor(logCursor_t *cursor, uint8_t *buffer, uint32_t size)
+{
+    cursor->buffer = buffer;            //Write from the start of the buffer
+    cursor->length = 0x00000000;        //Nothing has been written yet
+    cursor->limit = size - 0x00000001;  //Keep the last byte of the buffer back for the null terminator
+    cursor->overflow = 0x00000000;      //Nothing has been left out yet
+}
+
+//Close Log Cursor Function, null terminates the string written through the cursor, returning its final length including the terminator
+uint32_t closeLogCursor(logCursor_t *cursor)
+{
+    cursor->buffer[cursor->length++] = 0x00;  //Null terminate the end of the string, there is always room left for it
+    return cursor->length;                    //Return the final length of the string
+}
+
+//Emit Bytes Function, appends the provided characters to the string, returning how many were written
+uint32_t emitBytes(logCursor_t *cursor, const uint8_t *bytes, uint32_t length)
+{
+    //Leave the characters out altogether when they don't fit, rather than cutting them off part way through
+    if (length > cursor->limit - cursor->length)
+    {
+        cursor->overflow = 0xFFFFFFFF;  //Flag that the string is missing something
+        return 0x00000000;              //Nothing was written
+    }
+
+    memcpy(cursor->buffer + cursor->length, bytes, length);  //Copy the characters in at the end of the string
+    cursor->length += length;                                //Move the cursor past them
+
+    return length;  //Return the number of characters written
+}
 
-//Unsigned Integer To Decimal String, converts the provided unsigned integer into it's string representation
-void uintToDecString(uint32_t numberToConvert, uint8_t *stringBuffer)
+//Emit Segment Function, appends the provided segment of a template to the string, returning how many characters were written
+uint32_t emitSegment(logCursor_t *cursor, const logSegment_t *segment)
 {
-	uint32_t counter = 0x00000000;      //Create a variable to use for tracking the digit that's being converted
-    uint8_t tempBuffer[0x0000000B];     //Create an array of 11 bytes to use for storing the generated ASCII digits before copying them into the main byte 
-    uint8_t *tempPointer = tempBuffer;  //Initialize a new pointer that points at the tempBuffer array
+    return emitBytes(cursor, segment->text, segment->length);  //The length of the segment is already known, so it is copied straight in
+}
 
-    //Perform digit separation for the size of the provided buffer
-	while (counter++ <= 0x0000000B)
+//Emit Character Function, appends a single character to the string, returning how many characters were written
+uint32_t emitCharacter(logCursor_t *cursor, uint8_t character)
+{
+    //Leave the character out when there is no room left for it
+    if (cursor->length == cursor->limit)
     {
-    	*(tempPointer++) = (numberToConvert % 0x0000000A) | 0x00000030;  //Modulo the contents of numberToConvert by 10, ORing 0x30 to the result to convert the digit into an ASCII character
-        numberToConvert /= 0x0000000A;                                   //Divide numberToConvert by 10, then put the result back into the numberToConvert variable
-        if (!numberToConvert) break;                                     //Break from the loop whenever numberToConvert becomes empty
+        cursor->overflow = 0xFFFFFFFF;  //Flag that the string is missing something
+        return 0x00000000;              //Nothing was written
     }
 
-    //Starting from the array index given by the value of the counter variable, start reversing the contents of the character array so that it's legible
-    while (counter--) *(stringBuffer++) = *(--tempPointer);  //Copy the character at the address before the one stored in tempPointer into the next character in the stringBuffer array
+    cursor->buffer[cursor->length++] = character;  //Write the character straight in, a single byte isn't worth a call to memcpy()
 
-    *stringBuffer = 0x00;  //Complete the string by null terminating it with 0x00
+    return 0x00000001;  //Return the number of characters written
 }
 
-//Byte To Hexadecimal String, converts the provided byte into it's hexadecimal string representation
-void byteToHexString(uint8_t byteToConvert, uint8_t *stringBuffer)
+//Emit Unsigned Function, appends the decimal representation of the provided unsigned integer to the string, returning how many digits were written
+uint32_t emitUnsigned(logCursor_t *cursor, uint32_t value)
 {
-    *stringBuffer = ((byteToConvert & 0x000000F0) >> 0x00000004) | 0x30;  //Mask out the last 4 bits of the provided byte and create the first ASCII character for it
-    if (*stringBuffer > 0x39) *stringBuffer += 0x07;                      //Add 0x07 to the character if it's supposed to be a letter
-    *(++stringBuffer) = (byteToConvert & 0x0000000F) | 0x30;              //Mask out the first 4 bits of the provided byte and create the second ASCII character for it
-    if (*stringBuffer > 0x39) *stringBuffer += 0x07;                      //Add 0x07 to the character if it's supposed to be a letter
-    *(++stringBuffer) = 0x00;                                             //Complete the string by null terminating it with 0x00
+    uint8_t digits[0x0000000A];            //Room for the 10 digits of the largest 32-bit value
+    uint8_t *digit = digits + 0x0000000A;  //Digits are worked out from the least significant, so they are filled in backwards
+
+    //Perform digit separation until there is nothing left of the value, always giving at least one digit
+    do
+    {
+        *(--digit) = (value % 0x0000000A) | 0x00000030;  //Modulo the value by 10, ORing 0x30 to the result to convert the digit into an ASCII character
+        value /= 0x0000000A;                             //Move onto the next digit
+    }
+    while (value);
+
+    return emitBytes(cursor, digit, digits + 0x0000000A - digit);  //Append the digits in the order they are read
+}
+
+//Emit Hexadecimal Byte Function, appends the 2 digit hexadecimal representation of the provided byte to the string, returning how many digits were written
+uint32_t emitHexByte(logCursor_t *cursor, uint8_t value)
+{
+    uint8_t *digits = cursor->buffer + cursor->length;  //Both digits are written straight in at the end of the string
+
+    //Leave the byte out when there is no room left for both of its digits
+    if ((cursor->limit - cursor->length) < 0x00000002)
+    {
+        cursor->overflow = 0xFFFFFFFF;  //Flag that the string is missing something
+        return 0x00000000;              //Nothing was written
+    }
+
+    digits[0x00000000] = (value >> 0x00000004) | 0x30;          //Create the ASCII character for the upper nibble
+    if (digits[0x00000000] > 0x39) digits[0x00000000] += 0x07;  //Add 0x07 to the character if it's supposed to be a letter
+    digits[0x00000001] = (value & 0x0F) | 0x30;                 //Create the ASCII character for the lower nibble
+    if (digits[0x00000001] > 0x39) digits[0x00000001] += 0x07;  //Add 0x07 to the character if it's supposed to be a letter
+    cursor->length += 0x00000002;                               //Move the cursor past both digits
+
+    return 0x00000002;  //Return the number of digits written
 }
 
 
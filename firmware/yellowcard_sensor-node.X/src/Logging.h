@@ -11,30 +11,274 @@
 #include <xc.h>           //Include the main header file for the XC32 compiler, provides register definitions
 #include <sys/attribs.h>  //Include the attribs file, contains compiler level memory organization macros
 #include <string.h>       //Include the default string library which has some handy memory and string manipulation functions
+#include "Scheduler.h"    //Include the scheduler header file, keeps the peripheral clocks running while the log queue is being sent and provides the HAL
 
 
-//Logging strings
-extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_measurementReport[];
-extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_packet[];
+//Define any constants that are used within this file
+#ifndef LOG_QUEUE_SLOTS
+#define LOG_QUEUE_SLOTS    0x00000004  //Number of buffers within the log queue, has to be a power of 2
+#endif
+
+#ifndef LOG_SLOT_SIZE
+#define LOG_SLOT_SIZE    0x00000100  //Size in bytes of each buffer within the log queue, text logs and binary records constructed into a slot are cut short to fit within it
+#endif
+
+//Levels and categories of the logs, a log is only built into the firmware when its category is within LOG_CATEGORIES and its level is at most LOG_LEVEL
+#define LOG_LEVEL_NONE              0x00000000  //Builds no logs at all
+#define LOG_LEVEL_INFO              0x00000001  //Measurement reports and the packets sent over the air
+#define LOG_LEVEL_DEBUG             0x00000002  //Timing and charge of each measurement cycle and the profiler dumps, on top of what is built in by APP_PROFILE_CYCLE, SCHEDULER_ACCOUNT_CLOCK and PROFILER_PROBES
+#define LOG_CATEGORY_MEASUREMENT    0x00000001
+#define LOG_CATEGORY_PACKET         0x00000002
+#define LOG_CATEGORY_TIMING         0x00000004
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL    LOG_LEVEL_DEBUG  //Most detailed level of log that is built into the firmware
+#endif
+
+#ifndef LOG_CATEGORIES
+#define LOG_CATEGORIES    (LOG_CATEGORY_MEASUREMENT | LOG_CATEGORY_PACKET | LOG_CATEGORY_TIMING)  //Categories of log that are built into the firmware
+#endif
+
+#define LOG_ENABLED(category, level)    ((((category) & (LOG_CATEGORIES)) != 0x00000000) && ((level) <= (LOG_LEVEL)))
+#define LOG_ANY_ENABLED                 (LOG_ENABLED(LOG_CATEGORY_MEASUREMENT, LOG_LEVEL_INFO) || LOG_ENABLED(LOG_CATEGORY_PACKET, LOG_LEVEL_INFO) || LOG_ENABLED(LOG_CATEGORY_TIMING, LOG_LEVEL_DEBUG))
+
+//Logs are written through the LOG_ macros below, which compile away to nothing for logs that aren't built in, leaving their construct functions and
+//strings to be removed by the linker. The logs that are built in are only constructed while a console is attached to UART2, sensed through U2RX
+//idling high against the pull-down on RB5, so a node in the field spends no cycles, DMA transfers or UART time on them. Define LOG_CONSOLE_ALWAYS
+//to skip the sensing and always log, for listeners that don't drive U2RX.
+#ifdef LOG_CONSOLE_ALWAYS
+#define LOG_CONSOLE_PRESENT()    0xFFFFFFFF
+#else
+#define LOG_CONSOLE_PRESENT()    detectConsoleUART()
+#endif
+
+//Reserves a slot, constructs the log into it through the provided expression, which refers to the slot as logSlot, and commits it
+#define LOG_WRITE(construction)                                                                             \
+    do                                                                                                      \
+    {                                                                                                       \
+        uint8_t *logSlot;                                                                                   \
+        if (LOG_CONSOLE_PRESENT() && (logSlot = reserveLogSlot())) commitLogSlot(logSlot, (construction));  \
+    } while (0)
+
+#if LOG_ENABLED(LOG_CATEGORY_MEASUREMENT, LOG_LEVEL_INFO)
+#define LOG_MEASUREMENT(temperature, humidity, pressure)    LOG_WRITE(constructMeasurementLog(logSlot, (temperature), (humidity), (pressure)))
+#else
+#define LOG_MEASUREMENT(temperature, humidity, pressure)
+#endif
+
+#if LOG_ENABLED(LOG_CATEGORY_PACKET, LOG_LEVEL_INFO)
+#define LOG_PACKET(packetBytes)    LOG_WRITE(constructPacketLog(logSlot, (packetBytes)))
+#else
+#define LOG_PACKET(packetBytes)
+#endif
+
+#if LOG_ENABLED(LOG_CATEGORY_TIMING, LOG_LEVEL_DEBUG)
+#define LOG_TIMING(stageTicks, stageCount)                               LOG_WRITE(constructTimingLog(logSlot, (stageTicks), (stageCount)))
+#define LOG_CHARGE(clockPolicy, pointCharge, pointCount, sleepCharge)    LOG_WRITE(constructChargeLog(logSlot, (clockPolicy), (pointCharge), (pointCount), (sleepCharge)))
+#define LOG_PROFILE(probeCycles, biasCycles)                             LOG_WRITE(constructProfileLog(logSlot, (probeCycles), (biasCycles)))
+#define LOG_PROBE(probe, stats)                                          LOG_WRITE(constructProbeLog(logSlot, (probe), (stats)))
+#else
+#define LOG_TIMING(stageTicks, stageCount)
+#define LOG_CHARGE(clockPolicy, pointCharge, pointCount, sleepCharge)
+#define LOG_PROFILE(probeCycles, biasCycles)
+#define LOG_PROBE(probe, stats)
+#endif
+
+//Logs go out over UART2 through a queue of DMA-able slots rather than a single shared buffer. Producers reserve a slot, construct their log into
+//it and commit it with its length, committing never waits on the UART. DMA 2 sends the committed slots in the order they were reserved, with its
+//block complete interrupt chaining the next committed slot straight into the transfer, so UART2 and the DMA are only powered up and the core only
+//held out of SLEEP once for a whole run of logs. Once DMA 2 runs out of slots the UART2 TX interrupt is switched over to the shift register emptying
+//out, and everything is let go of from there rather than spinning on it within the DMA 2 interrupt. When every slot is taken the log is dropped and
+//counted in logQueueDropped instead.
+
+//Define LOG_BINARY to have the construct functions build compact binary records instead of text, cutting the bytes UART2 sends each cycle by 5-10x
+//and the time UART2 and the DMA are kept powered with them. Every record is framed as below, with multi-byte values sent MSB first and the CRC being
+//the CRC-16/CCITT-FALSE of everything after the sync byte. The payload of each record type is laid out by logRecordDescriptors, records without
+//fields carry a run of raw bytes instead. host/LogDecoder.c turns the stream back into the same text the node logs without LOG_BINARY.
+//
+//      [0xA5] [type] [payload length] [timestamp (4)] [payload ...] [CRC (2)]
+#define LOG_RECORD_SYNC             0xA5        //First byte of every record, lets the receiver find the start of the next record after a corrupted one
+#define LOG_RECORD_HEADER_LENGTH    0x00000007  //Sync byte, record type, payload length and the scheduler time (Timer 1 ticks) at which the record was built
+#define LOG_RECORD_CRC_LENGTH       0x00000002  //Length of the CRC-16 closing off each record
+#define LOG_RECORD_MAX_FIELDS       0x00000006  //Largest number of fields within any record
+
+//Text logs are written through a cursor that tracks the end of the string, so nothing is rescanned with strlen() as the log grows. The fixed text
+//of each log is split into segments held in a table, with the length of every segment worked out by the compiler from the size of its string,
+//and fields are emitted in between them. Emitters return the number of characters they wrote, leaving out anything that doesn't fit whole and
+//flagging the overflow on the cursor rather than running past the end of the buffer.
+#define LOG_SEGMENT(string)    {(string), sizeof(string) - 0x00000001}  //Builds a segment from a string array defined in the same file, without its null terminator
+
+
+//Define any enums used within this file
+typedef enum
+{
+    LOG_RECORD_MEASUREMENT, LOG_RECORD_PACKET, LOG_RECORD_TIMING, LOG_RECORD_CHARGE, LOG_RECORD_PROFILE, LOG_RECORD_PROBE, LOG_RECORD_COUNT
+} logRecordType_t;
+
+
+//Define any structs used within this file
+typedef struct
+{
+    uint8_t fieldCount;                          //Number of fields making up the payload, 0 for records carrying a run of raw bytes instead
+    uint8_t fieldWidths[LOG_RECORD_MAX_FIELDS];  //Width of each field in bytes, values are truncated down to it
+} logRecordDescriptor_t;
+
+typedef struct
+{
+    const uint8_t *text;  //Start of the text making up the segment, it isn't null terminated
+    uint32_t length;      //Number of characters within the segment, worked out by the compiler through LOG_SEGMENT()
+} logSegment_t;
+
+typedef struct
+{
+    uint8_t *buffer;    //Start of the buffer being written into
+    uint32_t length;    //Number of characters written so far, which is also where the next one goes
+    uint32_t limit;     //Number of characters that fit within the buffer, leaving room for the null terminator
+    uint32_t overflow;  //Non-zero once anything had to be left out for lack of room
+} logCursor_t;
+
+
+//Measurement Report strings
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_measurement_temperature[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_measurement_humidity[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_measurement_pressure[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_measurement_end[];
+
+extern const logSegment_t __attribute__ ((space(prog), section(".logging_constants_ptrs"))) logSegments_measurementReport[];
+
+//Packet strings
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_packet_length[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_packet_address[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_packet_type[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_packet_frame[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_packet_raw[];
+
+extern const logSegment_t __attribute__ ((space(prog), section(".logging_constants_ptrs"))) logSegments_packet[];
 
 //Packet Type strings
 extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_packetType_acknowledge[];
 extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_packetType_event[];
 extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_packetType_measureReport[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_packetType_rawReport[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_packetType_calibration[];
+
+extern const logSegment_t __attribute__ ((space(prog), section(".logging_constants_ptrs"))) logSegments_packetType[];
 
-extern const uint8_t* __attribute__ ((space(prog), section(".logging_constants_ptrs"))) logConstants_packetTypeLookup[];
+//Cycle Timing strings
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_cycleTiming[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_cycleStage_resultsReady[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_cycleStage_radioWake[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_cycleStage_frameLoaded[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_cycleStage_frameSent[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_cycleStage_logSent[];
+
+extern const logSegment_t __attribute__ ((space(prog), section(".logging_constants_ptrs"))) logSegments_cycleTiming[];
+
+//Cycle Charge strings
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_cycleCharge[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_clockPolicy[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_clockPolicy_fixed[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_clockPolicy_governed[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_clockPolicy_raceToIdle[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_operatingPoint_1MHz[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_operatingPoint_4MHz[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_operatingPoint_16MHz[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_operatingPoint_40MHz[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_chargeSleep[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_chargeTotal[];
+
+extern const logSegment_t __attribute__ ((space(prog), section(".logging_constants_ptrs"))) logSegments_cycleCharge[];
+extern const logSegment_t __attribute__ ((space(prog), section(".logging_constants_ptrs"))) logSegments_clockPolicy[];
+extern const logSegment_t __attribute__ ((space(prog), section(".logging_constants_ptrs"))) logSegments_operatingPoint[];
+
+//Profiler strings
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_profile[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_profile_probeCost[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_profile_biasRemoved[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_probe_task[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_probe_count[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_probe_min[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_probe_mean[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_probe_max[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_probe_histogram[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_probeName_i2cTransaction[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_probeName_spiTransaction[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_probeName_i2c2ISR[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_probeName_dma0ISR[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_probeName_dma1ISR[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_probeName_spi1ISR[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_probeName_timer1ISR[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_probeName_rtccISR[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_probeName_int3ISR[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_probeName_dma2ISR[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_probeName_uart2ISR[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_probeName_int4ISR[];
+extern const uint8_t __attribute__ ((space(prog), section(".logging_constants"))) logConstants_probeName_changeNoticeISR[];
+
+extern const logSegment_t __attribute__ ((space(prog), section(".logging_constants_ptrs"))) logSegments_profile[];
+extern const logSegment_t __attribute__ ((space(prog), section(".logging_constants_ptrs"))) logSegments_probe[];
+extern const logSegment_t __attribute__ ((space(prog), section(".logging_constants_ptrs"))) logSegments_probeName[];
+
+
+//Define any variables that are external to this file
+extern volatile uint32_t logQueueDropped;                   //Number of logs dropped because every slot of the log queue was taken
+#ifdef LOG_BINARY
+extern const logRecordDescriptor_t logRecordDescriptors[];  //Stores the layout of the payload of each record, indexed by logRecordType_t
+#endif
 
 
 //Define prototypes for functions used in the Logging source file
 extern uint32_t constructMeasurementLog(uint8_t *stringBuffer,     //Construct Measurement Log Function, constructs a new string to log the provided measurement results
-                                        const float *temperature,
-                                        const float *humidity,
-                                        const float *pressure);
+                                        const int32_t *temperature,
+                                        const int32_t *humidity,
+                                        const int32_t *pressure);
 extern uint32_t constructPacketLog(uint8_t *stringBuffer,          //Construct Packet Log Function, constructs a new string to log the provided packet bytes
                                    const uint8_t *packetBytes);
+extern uint32_t constructTimingLog(uint8_t *stringBuffer,          //Construct Timing Log Function, constructs a new string listing how long into the previous measurement cycle each of its stages was reached
+                                   const uint32_t *stageTicks,
+                                   uint32_t stageCount);
+extern uint32_t constructChargeLog(uint8_t *stringBuffer,          //Construct Charge Log Function, constructs a new string listing the charge drawn by the previous measurement cycle at each operating point, in SLEEP and in total
+                                   uint32_t clockPolicy,
+                                   const uint32_t *pointCharge,
+                                   uint32_t pointCount,
+                                   uint32_t sleepCharge);
+extern uint32_t constructProfileLog(uint8_t *stringBuffer,         //Construct Profile Log Function, constructs a new string heading a profiler dump with the overhead of a probe
+                                    uint32_t probeCycles,
+                                    uint32_t biasCycles);
+extern uint32_t constructProbeLog(uint8_t *stringBuffer,           //Construct Probe Log Function, constructs a new string listing the statistics gathered by the given profiler probe
+                                  profilerProbe_t probe,
+                                  const profilerProbeStats_t *stats);
+#ifdef LOG_BINARY
+extern uint32_t constructRecord(uint8_t *recordBuffer,             //Construct Record Function, frames the provided fields or raw bytes into a binary record of the given type, returning the length of the record
+                                logRecordType_t type,
+                                const uint32_t *fields,
+                                const uint8_t *bytes,
+                                uint32_t byteCount);
+#endif
+
+extern uint8_t *reserveLogSlot();                                  //Reserve Log Slot Function, hands out the next free slot of the log queue to construct a log into, returning NULL and counting the log as dropped when the queue is full
+extern void commitLogSlot(uint8_t *slot,                           //Commit Log Slot Function, queues the log constructed into the provided slot to be sent, starting DMA 2 right away when it is idle
+                          uint32_t length);
+extern void serviceLogQueue();                                     //Service Log Queue Function, frees the slot DMA 2 has just sent and chains the next committed one into the transfer, called from the DMA 2 interrupt
+extern uint32_t finishLogQueue();                                  //Finish Log Queue Function, chains on a log committed while the last bytes went out or lets go of UART2, the DMA and the awake hold, called from the UART2 TX interrupt
+extern void flushLogQueue();                                       //Flush Log Queue Function, idles the CPU until DMA 2 has sent every committed log, only for use from tasks
 
-extern void uintToDecString(uint32_t numberToConvert, uint8_t *stringBuffer);  //Unsigned Integer To Decimal String, converts the provided unsigned integer into it's decimal string representation
-extern void byteToHexString(uint8_t byteToConvert, uint8_t *stringBuffer);     //Byte To Hexadecimal String, converts the provided byte into it's hexadecimal string representation
+//Formatting Functions
+extern void openLogCursor(logCursor_t *cursor,                     //Open Log Cursor Function, points the provided cursor at the start of an empty buffer of the given size
+                          uint8_t *buffer,
+                          uint32_t size);
+extern uint32_t closeLogCursor(logCursor_t *cursor);               //Close Log Cursor Function, null terminates the string written through the cursor, returning its final length including the terminator
+extern uint32_t emitBytes(logCursor_t *cursor,                     //Emit Bytes Function, appends the provided characters to the string, returning how many were written
+                          const uint8_t *bytes,
+                          uint32_t length);
+extern uint32_t emitSegment(logCursor_t *cursor,                   //Emit Segment Function, appends the provided segment of a template to the string, returning how many characters were written
+                            const logSegment_t *segment);
+extern uint32_t emitCharacter(logCursor_t *cursor,                 //Emit Character Function, appends a single character to the string, returning how many characters were written
+                              uint8_t character);
+extern uint32_t emitUnsigned(logCursor_t *cursor,                  //Emit Unsigned Function, appends the decimal representation of the provided unsigned integer to the string, returning how many digits were written
+                             uint32_t value);
+extern uint32_t emitHexByte(logCursor_t *cursor,                   //Emit Hexadecimal Byte Function, appends the 2 digit hexadecimal representation of the provided byte to the string, returning how many digits were written
+                            uint8_t value);
 
 
 #endif
@@ -32,32 +32,38 @@ inline void setupMCU()
     TRISA = 0x00000018;  //Set RA0 and RA1 to outputs
 
     //Configure Port B
-    ANSELB = 0x0000E003;  //Force RB2 and RB3 to fully digital IO, allowing the I2C peripheral to function correctly
-    LATB = 0x00001000;    //Clear all of Port B to logic LOW, setting RB12 to logic HIGH
-    ODCB = 0x00001000;    //Enable the open-drain function on RB12
-    CNENB = 0x000003C0;   //Enable change notification interrupts on inputs RB6 through RB9
-    TRISB = 0x0000EBFF;   //Set RB10 and RB12 to outputs
+    ANSELB = 0x0000E001 & ~DPS368_INT_PORTB_MASK;  //Force RB1, RB2, RB3 and the DPS368 interrupt pin to fully digital IO, allowing the I2C peripheral and the interrupt inputs to function correctly
+    LATB = 0x00001000;                             //Clear all of Port B to logic LOW, setting RB12 to logic HIGH
+    ODCB = 0x00001000;                             //Enable the open-drain function on RB12
+    CNCONB = 0x00008000;                           //Turn on the change notice module of Port B
+    CNENB = DPS368_INT_PORTB_MASK;                 //Enable change notification interrupts on the pin wired to the interrupt output of the DPS368, the buttons on RB6 through RB9 (0x03C0) have no handler yet
+    TRISB = 0x0000EBFF;                            //Set RB10 and RB12 to outputs
 
     //Configure PPS connections
-    RPA3R = 0x00000002;   //Assign RA3 to the TX output of UART2
-    U2RXR = 0x00000001;   //Assign RB5 to the RX input of UART2
-    INT4R = 0x00000004;   //Assign RB7 to the 4th external interrupt
-    RPB13R = 0x00000003;  //Assign RB13 to the SDO output of SPI1
-    SDI1R = 0x00000003;   //Assign RB11 to the SDI input of SPI1
+    RPA3R = 0x00000002;          //Assign RA3 to the TX output of UART2
+    U2RXR = 0x00000001;          //Assign RB5 to the RX input of UART2
+#ifndef LOG_CONSOLE_ALWAYS
+    CNPDBSET = 0x00000020;       //Pull RB5 down so that U2RX only reads high while a console is attached and idling its TX line, see detectConsoleUART()
+#endif
+    INT3R = SX1231H_DIO1_INT3R;  //Assign the pin wired to DIO1 of the transceiver to the 3rd external interrupt
+    INT4R = 0x00000004;          //Assign RB7 to the 4th external interrupt
+    RPB13R = 0x00000003;         //Assign RB13 to the SDO output of SPI1
+    SDI1R = 0x00000003;          //Assign RB11 to the SDI input of SPI1
     
     //Enable and configure the first SPI peripheral, SPI1
-    SPI1BRG = 0x00000001;   //Set the clock frequency of SPI1 to operate at 4MHz
-    SPI1CON2 = 0x00000C00;  //Disable all audio codec functionality of SPI1
-    SPI1CON = 0x00008120;   //Enable SPI1 in master mode, configured for 8-bit words in standard buffer mode
+    SPI1BRG = sysClkOperatingPoints[SYSCLK_16MHZ].brgSPI;  //Set the clock frequency of SPI1 to operate at 2MHz
+    SPI1CON2 = 0x00000C00;                                 //Disable all audio codec functionality of SPI1
+    SPI1CON = 0x0001012D;                                  //Configure SPI1 in master mode for 8-bit words in enhanced buffer mode, with the TX interrupt asserted while the buffer has room and the RX interrupt while it holds data
+    SPI1CONSET = 0x00008000;                               //Enable SPI1 now that enhanced buffer mode has been selected
 
     //Enable and configure the second I2C peripheral, I2C2
-    I2C2BRG = 0x00000008;  //Set the bus speed of I2C2 to ~429kHz
-    I2C2CON = 0x0000A000;  //Enable I2C2 with the stop in idle mode active
+    I2C2BRG = sysClkOperatingPoints[SYSCLK_16MHZ].brgI2C;  //Set the bus speed of I2C2 to ~370kHz
+    I2C2CON = 0x0000A000;                                  //Enable I2C2 with the stop in idle mode active
 
     //Enable and configure the second UART peripheral, UART2
-    U2BRG = 0x00000019;   //Set the baud rate of UART2 to operate at roughly 19200bps
-    U2STA = 0x00008400;   //Enable the transmitter with the interrupt asserted on an empty TX buffer
-    U2MODE = 0x00008000;  //Enable UART2 in standard baud mode
+    U2BRG = sysClkOperatingPoints[SYSCLK_16MHZ].brgUART;  //Set the baud rate of UART2 to operate at roughly 19200bps
+    U2STA = 0x00008400;                                    //Enable the transmitter with the interrupt asserted on an empty TX buffer
+    U2MODE = 0x00008008;                                   //Enable UART2 in high baud mode, leaving enough resolution in U2BRG for 19200bps at a 1MHz PBCLK
 
     //Prepare for configuraiton of the RTCC peripheral
     SYSKEY = 0x00000000;  //Reset the register lock state machine by writing a 0 to it
@@ -72,15 +78,19 @@ inline void setupMCU()
     RTCCON = 0x00002208;              //Configure the RTCC to use SOSC as the source clock with stop-in-idle mode active
 
     //Configure Timer 1
-//    PR1 = 0x00001FFF;
-//    T1CON = 0x00000016;  //Enable Timer 1 using the secondary oscillator as the clock source with a 256 cycle pre-scaler
-//    T1CON = 0x00000002;
-//    TMR1 = 0x00000000;   //Clear the contents of the Timer 1 count register
+    T1CON = 0x00000002;  //Clock Timer 1 asynchronously from the secondary oscillator with a 1:1 pre-scaler so that it keeps counting in SLEEP, the scheduler starts and stops it
+    TMR1 = 0x00000000;   //Clear the contents of the Timer 1 count register
 
     //Enable the DMA peripheral
     DMACON = 0x00008000;
 
+    //Configure DMA 0 for SPI RX transfers
+    DCH0CON = 0x00000003;   //Setup DMA0 for normal transfers with the highest DMA priority
+    DCH0ECON = 0x00002510;  //Allow start events from IRQ 37 (SPI1 RX interrupt)
+
     //Configure DMA 1 for SPI TX transfers
+    DCH1CON = 0x00000002;   //Setup DMA1 for normal transfers with a DMA priority just below DMA0
+    DCH1ECON = 0x00002610;  //Allow start events from IRQ 38 (SPI1 TX interrupt)
 
     //Configure DMA 2 for UART TX transfers
     DCH2DSIZ = 0x00000001;          //Destination pointer has a size of 1 byte
@@ -88,40 +98,70 @@ inline void setupMCU()
     DCH2DSA = KVA_TO_PA(&U2TXREG);  //Assign the destination address of DMA2 to the transmit buffer of UART2
     DCH2DAT = 0x00000000;           //Use a NULL character as the termination byte for the transfer sequence
     DCH2CON = 0x00000000;           //Setup DMA2 for pattern matching with the lowest DMA priority
+#ifdef LOG_BINARY
+    DCH2ECON = 0x00003710;          //Allow start events from IRQ 55 (UART2 TX interrupt), binary records are full of NULL bytes so they are sent by length alone
+#else
     DCH2ECON = 0x00003730;          //Using pattern match mode, allow start events from IRQ 55 (UART2 TX interrupt)
+#endif
     DCH2INT = 0x00080000;           //Enable block transfer complete interrupts for DMA 2
 
-    setupInterrupts();               //Setup the interrupt controller of the MCU and enable interrupts
+    initializePeripheralPower();  //Switch off every module that isn't needed right now, the managed ones come back on by themselves when used
+    setupInterrupts();            //Setup the interrupt controller of the MCU and enable interrupts
 }
 
 //Main Function, called upon reset of the MCU
 void main()
 {
     setupMCU();  //Configure the main functionality of the microcontroller for the application
+#ifdef PROFILER_PROBES
+    initializeProfiler();  //Find the overhead of a probe before any of them are passed through
+#endif
 
-    uint32_t counter = 0x000FFFFF;  //Create a counter variable to use for the various reset tasks
-    while (counter--);              //Wait a short period of time before continuing
+    uint32_t counter;  //Create a counter variable to use for the various reset tasks
 
     //Initialize any hardware connected to the microcontroller for the application
-    initializeSX1231H(OOK_F_2BR);
-    setCarrierFreqSX1231H(432950000);
-    setFreqDeviationSX1231H(600);
-    setBitRateSX1231H(2400);
-    setPowerLevelSX1231H(0x00000016);
-    setDeviceModeSX1231H(SLEEP);
-    
-    counter = 0x000000FF;  //Allow a maximum of 255 attempts when trying to read the calibration data from the pressure sensor
-    while (counter--)
+    sx1231hRestHook = &restWhileBusy;        //Wait out frames on air through the scheduler, in SLEEP unless an awake hold needs the peripheral clocks running
+    delayMilliseconds(SX1231H_POR_TIME_MS);  //Give the transceiver time to come out of its power on reset before talking to it
+    initializeSX1231H();                     //Load the compile-time generated radio configuration into the transceiver
+    setDeviceModeSX1231H(SLEEP);             //Put the transceiver to sleep until there is something to transmit
+
+    delayMilliseconds(DPS368_SENSOR_READY_MS);  //Wait until the pressure sensor is ready to communicate
+
+    //Use the calibration record kept in flash when it is intact and belongs to the fitted pressure sensor, only configuring the sensor
+    if (restoreCalibrationRecord(&pressureSensorCal))
     {
-        initializeDPS368(OVERSAMPLE_32, BACKGROUND_1HZ, OVERSAMPLE_8, BACKGROUND_1HZ, 0x00000000);  //Send the desired operating configuration to the DPS368 pressure sensor
-        if (readCalCoeffsDPS368()) break;                                                           //Attempt to load the calibration data from the sensor, exiting the loop when successful
+        counter = 0x000000FF;  //Allow a maximum of 255 attempts when trying to configure the pressure sensor
+        while (counter--)
+        {
+            if (initializeDPS368(&pressureSensorCal, APP_PRES_OVERSAMPLE, APP_SAMPLE_RATE, APP_TEMP_OVERSAMPLE, APP_SAMPLE_RATE, APP_FIFO_ENABLE, APP_DPS368_INT_CONFIG)) break;  //Send the desired operating configuration to the DPS368 pressure sensor
+            delayMilliseconds(0x00000001);                                                                                                         //Give the sensor a moment before trying again
+        }
     }
-
-    //Infinite loop of death :3
-    while (0xFFFFFFFF)
+    else
     {
-        handlerFunctionTable[currentState]();  //Invoke the function located at the address obtained from the lookup table
+        delayMilliseconds(DPS368_COEF_READY_MS - DPS368_SENSOR_READY_MS);  //Wait until the calibration coefficients of the pressure sensor are guaranteed to be readable
+
+        counter = 0x000000FF;  //Allow a maximum of 255 attempts when trying to read the calibration data from the pressure sensor
+        while (counter--)
+        {
+            initializeDPS368(&pressureSensorCal, APP_PRES_OVERSAMPLE, APP_SAMPLE_RATE, APP_TEMP_OVERSAMPLE, APP_SAMPLE_RATE, APP_FIFO_ENABLE, APP_DPS368_INT_CONFIG);  //Send the desired operating configuration to the DPS368 pressure sensor
+
+            //Attempt to load the calibration data from the sensor, keeping it in flash for the next boot and exiting the loop when successful
+            if (readCalCoeffsDPS368(&pressureSensorCal))
+            {
+                saveCalibrationRecord(&pressureSensorCal);
+                break;
+            }
+
+            delayMilliseconds(0x00000001);  //Give the sensor a moment before trying again
+        }
     }
+
+    //Hand control over to the scheduler, starting off in the DO_RESET state
+    initializeScheduler(handlerFunctionTable, NODE_TASK_COUNT);           //Give the scheduler the table of application tasks
+    setClockPolicyScheduler(APP_CLOCK_TASK_SPEEDS, APP_CLOCK_IDLE_SPEED);  //Give the scheduler the operating point of each task along with the one to rest at
+    signalTask(DO_RESET);                                                 //Run the DO_RESET task first
+    runScheduler();                                                       //Infinite loop of death :3
 }
 
 
@@ -41,7 +41,7 @@ void newEventPacket(packetEvent_t *packetBuffer, packetEventType_t eventType, ui
 }
 
 //New Measure Report Packet Function, generates a new measurement report packet at the provided address
-void newMeasureReportPacket(packetMeasureReport_t *packetBuffer, const float *temperature, const float *humidity, const float *pressure)
+void newMeasureReportPacket(packetMeasureReport_t *packetBuffer, const int32_t *temperature, const int32_t *humidity, const int32_t *pressure)
 {
     generateHeader(&packetBuffer->packetHeader, MEASURE_REPORT, PACKET_LENGTH_MEASUREREPORT);  //Generate a new packet header for the MEASURE_REPORT type
     
@@ -49,17 +49,17 @@ void newMeasureReportPacket(packetMeasureReport_t *packetBuffer, const float *te
     uint32_t dataBuffer;  //Create a temporary 16-bit unsigned variable to use for data manipulation while constructing the payload
 
     //Put the temperature value into the payload
-    dataBuffer = (int32_t) (*temperature * 100.0F);
+    dataBuffer = *temperature;                                //The temperature is already in hundredths of a degree Celsius
     packetBuffer->reportedTempLSB = dataBuffer & 0x000000FF;  //Store the first byte of dataBuffer in the reportedTempLSB part of the packet
     dataBuffer >>= 0x00000008;                                //Shift the contents of dataBuffer over to the right by 8 bits
     packetBuffer->reportedTempMSB = dataBuffer & 0x000000FF;  //Write the remaining byte of dataBuffer into the reportedTempMSB portion of the packet
 
     //Put the relative humidity value into the payload
-    dataBuffer = (uint32_t) *humidity;
-    packetBuffer->reportedRH = dataBuffer;  //Copy the contents of dataBuffer into the reportedRH part of the packet
+    dataBuffer = (*humidity + 0x00000032) / 0x00000064;  //Round the relative humidity from hundredths of a percent to the nearest whole percent
+    packetBuffer->reportedRH = dataBuffer;               //Copy the contents of dataBuffer into the reportedRH part of the packet
 
     //Put the barometric pressure value into the payload
-    dataBuffer = (uint32_t) *pressure;
+    dataBuffer = *pressure / 0x00000064;                      //Convert the pressure from hundredths of a Pascal into whole Pascals
     packetBuffer->reportedPresLSB = dataBuffer & 0x000000FF;  //Store the first byte of dataBuffer in the reportedPresLSB part of the packet
     dataBuffer >>= 0x00000008;                                //Shift the contents of dataBuffer over to the right by 8 bits
     packetBuffer->reportedPresMSB = dataBuffer & 0x000000FF;  //Write the second byte of dataBuffer into the reportedPresMSB portion of the packet
@@ -67,6 +67,63 @@ void newMeasureReportPacket(packetMeasureReport_t *packetBuffer, const float *te
     packetBuffer->reportedPresHSB = dataBuffer & 0x000000FF;  //Write the third byte of dataBuffer into the reportedPresHSB portion of the packed
 }
 
+//New Raw Report Packet Function, generates a new raw report packet at the provided address from the unconverted sensor results
+void newRawReportPacket(packetRawReport_t *packetBuffer, const uint16_t *rawTemperature, const uint16_t *rawHumidity, const uint32_t *rawPressure, const uint32_t *rawPresTemperature)
+{
+    generateHeader(&packetBuffer->packetHeader, RAW_REPORT, PACKET_LENGTH_RAWREPORT);  //Generate a new packet header for the RAW_REPORT type
+
+    //Put the SHT4x ticks into the payload
+    packetBuffer->rawTempMSB = *rawTemperature >> 0x00000008;  //Store the upper byte of the raw temperature in the rawTempMSB part of the packet
+    packetBuffer->rawTempLSB = *rawTemperature & 0x00FF;       //Store the lower byte of the raw temperature in the rawTempLSB part of the packet
+    packetBuffer->rawRHMSB = *rawHumidity >> 0x00000008;       //Store the upper byte of the raw humidity in the rawRHMSB part of the packet
+    packetBuffer->rawRHLSB = *rawHumidity & 0x00FF;            //Store the lower byte of the raw humidity in the rawRHLSB part of the packet
+
+    //Put the 24-bit DPS368 results into the payload
+    packetBuffer->rawPresHSB = (*rawPressure >> 0x00000010) & 0x000000FF;                //Store the upper byte of the raw pressure in the rawPresHSB part of the packet
+    packetBuffer->rawPresMSB = (*rawPressure >> 0x00000008) & 0x000000FF;                //Store the middle byte of the raw pressure in the rawPresMSB part of the packet
+    packetBuffer->rawPresLSB = *rawPressure & 0x000000FF;                                //Store the lower byte of the raw pressure in the rawPresLSB part of the packet
+    packetBuffer->rawPresTempHSB = (*rawPresTemperature >> 0x00000010) & 0x000000FF;  //Store the upper byte of the raw DPS368 temperature in the rawPresTempHSB part of the packet
+    packetBuffer->rawPresTempMSB = (*rawPresTemperature >> 0x00000008) & 0x000000FF;  //Store the middle byte of the raw DPS368 temperature in the rawPresTempMSB part of the packet
+    packetBuffer->rawPresTempLSB = *rawPresTemperature & 0x000000FF;                  //Store the lower byte of the raw DPS368 temperature in the rawPresTempLSB part of the packet
+}
+
+//New Calibration Packet Function, generates a new calibration packet at the provided address from the DPS368 calibration context
+void newCalibrationPacket(packetCalibration_t *packetBuffer, const calibrationDPS368_t *calibration, precisionDPS368_t presOversample, precisionDPS368_t tempOversample)
+{
+    generateHeader(&packetBuffer->packetHeader, CALIBRATION, PACKET_LENGTH_CALIBRATION);  //Generate a new packet header for the CALIBRATION type
+
+    //Recover the coefficients as read from the sensor, the Q24 ones hold them shifted up by 24 bits
+    int32_t c00 = (int32_t) (calibration->c00 >> 0x00000018);  //Coefficient c00 as read from the sensor, taken out of Q24
+    int32_t c10 = (int32_t) (calibration->c10 >> 0x00000018);  //Coefficient c10 as read from the sensor, taken out of Q24
+    int32_t c01 = (int32_t) (calibration->c01 >> 0x00000018);  //Coefficient c01 as read from the sensor, taken out of Q24
+    int32_t c11 = (int32_t) (calibration->c11 >> 0x00000018);  //Coefficient c11 as read from the sensor, taken out of Q24
+    int32_t c20 = (int32_t) (calibration->c20 >> 0x00000018);  //Coefficient c20 as read from the sensor, taken out of Q24
+
+    packetBuffer->oversampling = (presOversample << 0x00000004) | tempOversample;  //Pack the pressure and temperature oversampling rates into a single byte
+
+    //Put the coefficients into the payload
+    packetBuffer->c0MSB = (calibration->c0 >> 0x00000008) & 0x000000FF;    //Store the upper byte of coefficient c0 in the c0MSB part of the packet
+    packetBuffer->c0LSB = calibration->c0 & 0x000000FF;                    //Store the lower byte of coefficient c0 in the c0LSB part of the packet
+    packetBuffer->c1MSB = (calibration->c1 >> 0x00000008) & 0x000000FF;    //Store the upper byte of coefficient c1 in the c1MSB part of the packet
+    packetBuffer->c1LSB = calibration->c1 & 0x000000FF;                    //Store the lower byte of coefficient c1 in the c1LSB part of the packet
+    packetBuffer->c00HSB = (c00 >> 0x00000010) & 0x000000FF;               //Store the upper byte of coefficient c00 in the c00HSB part of the packet
+    packetBuffer->c00MSB = (c00 >> 0x00000008) & 0x000000FF;               //Store the middle byte of coefficient c00 in the c00MSB part of the packet
+    packetBuffer->c00LSB = c00 & 0x000000FF;                               //Store the lower byte of coefficient c00 in the c00LSB part of the packet
+    packetBuffer->c10HSB = (c10 >> 0x00000010) & 0x000000FF;               //Store the upper byte of coefficient c10 in the c10HSB part of the packet
+    packetBuffer->c10MSB = (c10 >> 0x00000008) & 0x000000FF;               //Store the middle byte of coefficient c10 in the c10MSB part of the packet
+    packetBuffer->c10LSB = c10 & 0x000000FF;                               //Store the lower byte of coefficient c10 in the c10LSB part of the packet
+    packetBuffer->c01MSB = (c01 >> 0x00000008) & 0x000000FF;               //Store the upper byte of coefficient c01 in the c01MSB part of the packet
+    packetBuffer->c01LSB = c01 & 0x000000FF;                               //Store the lower byte of coefficient c01 in the c01LSB part of the packet
+    packetBuffer->c11MSB = (c11 >> 0x00000008) & 0x000000FF;               //Store the upper byte of coefficient c11 in the c11MSB part of the packet
+    packetBuffer->c11LSB = c11 & 0x000000FF;                               //Store the lower byte of coefficient c11 in the c11LSB part of the packet
+    packetBuffer->c20MSB = (c20 >> 0x00000008) & 0x000000FF;               //Store the upper byte of coefficient c20 in the c20MSB part of the packet
+    packetBuffer->c20LSB = c20 & 0x000000FF;                               //Store the lower byte of coefficient c20 in the c20LSB part of the packet
+    packetBuffer->c21MSB = (calibration->c21 >> 0x00000008) & 0x000000FF;  //Store the upper byte of coefficient c21 in the c21MSB part of the packet
+    packetBuffer->c21LSB = calibration->c21 & 0x000000FF;                  //Store the lower byte of coefficient c21 in the c21LSB part of the packet
+    packetBuffer->c30MSB = (calibration->c30 >> 0x00000008) & 0x000000FF;  //Store the upper byte of coefficient c30 in the c30MSB part of the packet
+    packetBuffer->c30LSB = calibration->c30 & 0x000000FF;                  //Store the lower byte of coefficient c30 in the c30LSB part of the packet
+}
+
 
 
 
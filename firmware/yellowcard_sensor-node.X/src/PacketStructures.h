@@ -8,18 +8,26 @@
 #define	_PACKET_STRUCTURES_H_
 
 //Import any libraries used by this file
-#include <xc.h>  //Include the main header file for the XC32 compiler, provides register definitions
+#include <xc.h>                 //Include the main header file for the XC32 compiler, provides register definitions
+#include "drv/DPS368/DPS368.h"  //Include the driver for the DPS368 barometric pressure sensor, its calibration context is sent in calibration packets
 
 
 //Define any constants related to packet lengths
 #define PACKET_LENGTH_EVENT            0x00000007
 #define PACKET_LENGTH_MEASUREREPORT    0x0000000B
+#define PACKET_LENGTH_RAWREPORT        0x0000000F
+#define PACKET_LENGTH_CALIBRATION      0x0000001A
+
+//RAW_REPORT packets carry the SHT4x ticks and the 24-bit DPS368 results exactly as they were read, leaving every conversion to the receiver. The
+//receiver needs the DPS368 coefficients and oversampling rates to do so, which are sent in a CALIBRATION packet with the coefficients sign extended
+//into whole bytes (c0 and c1 into 16 bits, c00 and c10 into 24 bits) and the pressure and temperature precisionDPS368_t in the upper and lower
+//nibbles of the oversampling byte. Every multi-byte field is sent most significant byte first.
 
 
 //Define any enums used within this file
 typedef enum
 {
-    ACKNOWLEDGE = 0x00, EVENT = 0x01, MEASURE_REPORT = 0x02
+    ACKNOWLEDGE = 0x00, EVENT = 0x01, MEASURE_REPORT = 0x02, RAW_REPORT = 0x03, CALIBRATION = 0x04
 } packetPayloadType_t;
 
 typedef enum
@@ -74,6 +82,63 @@ typedef union
     };
 } packetMeasureReport_t;
 
+typedef union
+{
+    struct
+    {
+        packetHeader_t packetHeader;
+
+        uint8_t rawTempMSB;
+        uint8_t rawTempLSB;
+        uint8_t rawRHMSB;
+        uint8_t rawRHLSB;
+        uint8_t rawPresHSB;
+        uint8_t rawPresMSB;
+        uint8_t rawPresLSB;
+        uint8_t rawPresTempHSB;
+        uint8_t rawPresTempMSB;
+        uint8_t rawPresTempLSB;
+    };
+    struct
+    {
+        uint8_t bytes[PACKET_LENGTH_RAWREPORT];
+    };
+} packetRawReport_t;
+
+typedef union
+{
+    struct
+    {
+        packetHeader_t packetHeader;
+
+        uint8_t oversampling;
+        uint8_t c0MSB;
+        uint8_t c0LSB;
+        uint8_t c1MSB;
+        uint8_t c1LSB;
+        uint8_t c00HSB;
+        uint8_t c00MSB;
+        uint8_t c00LSB;
+        uint8_t c10HSB;
+        uint8_t c10MSB;
+        uint8_t c10LSB;
+        uint8_t c01MSB;
+        uint8_t c01LSB;
+        uint8_t c11MSB;
+        uint8_t c11LSB;
+        uint8_t c20MSB;
+        uint8_t c20LSB;
+        uint8_t c21MSB;
+        uint8_t c21LSB;
+        uint8_t c30MSB;
+        uint8_t c30LSB;
+    };
+    struct
+    {
+        uint8_t bytes[PACKET_LENGTH_CALIBRATION];
+    };
+} packetCalibration_t;
+
 
 //Define any variables that are external to this file
 extern volatile uint16_t globalFrameCount;  //Used to determine what the frame number of the next packet will be
@@ -88,9 +153,18 @@ extern void newEventPacket(packetEvent_t *packetBuffer,                  //New E
                            packetEventType_t eventType,
                            uint8_t argument);
 extern void newMeasureReportPacket(packetMeasureReport_t *packetBuffer,  //New Measure Report Packet Function, generates a new measurement report packet at the provided address
-                                   const float *temperature,
-                                   const float *humidity,
-                                   const float *pressure);
+                                   const int32_t *temperature,
+                                   const int32_t *humidity,
+                                   const int32_t *pressure);
+extern void newRawReportPacket(packetRawReport_t *packetBuffer,          //New Raw Report Packet Function, generates a new raw report packet at the provided address from the unconverted sensor results
+                               const uint16_t *rawTemperature,
+                               const uint16_t *rawHumidity,
+                               const uint32_t *rawPressure,
+                               const uint32_t *rawPresTemperature);
+extern void newCalibrationPacket(packetCalibration_t *packetBuffer,      //New Calibration Packet Function, generates a new calibration packet at the provided address from the DPS368 calibration context
+                                 const calibrationDPS368_t *calibration,
+                                 precisionDPS368_t presOversample,
+                                 precisionDPS368_t tempOversample);
 
 
 #endif
@@ -0,0 +1,154 @@
+/**************************************************************************************
+ *  Yellowcard - Example firmware for the Yellowcard RF Development Kit               *
+ * ---------------------------------------------------------------------------------- *
+ *  Profiler.c - Cycle counting probes around tasks, bus transactions and interrupts  *
+ **************************************************************************************/
+
+#include "Logging.h"
+
+
+
+#ifdef PROFILER_PROBES
+/***************
+ *  Variables  *
+ ***************/
+
+
+//Probe Table
+uint32_t profilerEntryCycles[PROFILER_PROBE_COUNT];       //Count at which the current pass through each probe started, indexed by profilerProbe_t
+profilerProbeStats_t profilerStats[PROFILER_PROBE_COUNT];  //Statistics gathered by each probe since the last reset, indexed by profilerProbe_t
+
+//Overhead
+uint32_t profilerBiasCycles = 0x00000000;   //Count cycles an empty pass records, taken off every sample
+uint32_t profilerProbeCycles = 0x00000000;  //Count cycles each pass adds to the code around the probe
+
+
+
+/************************
+ *  Profiler Functions  *
+ ************************/
+
+
+//Initialize Profiler Function, times empty probes to find the overhead of a probe and then clears the table
+void initializeProfiler()
+{
+    uint32_t interruptState;           //Create a variable to use for preserving the state of the interrupts
+    uint32_t startCycles;              //Count at the start of the timed section
+    uint32_t elapsedCycles;            //Count cycles taken by the timed section
+    uint32_t readCycles = 0xFFFFFFFF;  //Fewest Count cycles taken by reading Count twice in a row
+    uint32_t passCycles = 0xFFFFFFFF;  //Fewest Count cycles taken by an empty probe along with the two reads around it
+
+    resetProfiler();                  //Start the calibration probe off from nothing
+    profilerBiasCycles = 0x00000000;  //Leave the samples of the calibration untouched
+
+    asm volatile ("di %0" : "=r" (interruptState));  //Disable interrupts so that nothing lands in the middle of the timed sections
+
+    //Time reading Count on its own and an empty probe between two reads of Count, keeping the fastest of several passes
+    for (uint32_t pass = 0x00000000; pass < PROFILER_CALIBRATION_PASSES; pass++)
+    {
+        startCycles = _CP0_GET_COUNT();                              //Read Count to start the first timed section
+        elapsedCycles = _CP0_GET_COUNT() - startCycles;              //Read Count again straight away, the difference being the cost of a read
+        if (elapsedCycles < readCycles) readCycles = elapsedCycles;  //Keep the fastest pass
+
+        startCycles = _CP0_GET_COUNT();                              //Read Count to start the second timed section
+        PROFILE_ENTER(PROBE_TASK(0x00000000));                       //Open a pass through the calibration probe
+        PROFILE_EXIT(PROBE_TASK(0x00000000));                        //Close it straight away, recording an empty pass
+        elapsedCycles = _CP0_GET_COUNT() - startCycles;              //Read Count again, the difference being the cost of the probe along with the two reads
+        if (elapsedCycles < passCycles) passCycles = elapsedCycles;  //Keep the fastest pass
+    }
+
+    if (interruptState & 0x00000001) asm volatile ("ei");  //Restore the interrupts if they were enabled before entering the function
+
+    profilerBiasCycles = profilerStats[PROBE_TASK(0x00000000)].minCycles;  //What an empty pass records is the part of the overhead that lands within every sample
+    profilerProbeCycles = passCycles - readCycles;                          //Everything the probe added between the two reads of Count is its full cost
+
+    resetProfiler();  //Clear the calibration probe back out of the table
+}
+
+//Reset Profiler Function, clears the statistics of every probe
+void resetProfiler()
+{
+    uint32_t interruptState;  //Create a variable to use for preserving the state of the interrupts
+
+    asm volatile ("di %0" : "=r" (interruptState));  //Disable interrupts so that no probe in an ISR records a pass while the table is being cleared
+
+    memset(profilerStats, 0x00, sizeof(profilerStats));                                                                     //Clear every count, total and bucket
+    for (uint32_t probe = 0x00000000; probe < PROFILER_PROBE_COUNT; probe++) profilerStats[probe].minCycles = 0xFFFFFFFF;  //Any pass is faster than none at all
+
+    if (interruptState & 0x00000001) asm volatile ("ei");  //Restore the interrupts if they were enabled before entering the function
+}
+
+//Record Probe Function, adds the pass through the given probe ending at the provided Count onto its statistics
+void recordProbeProfiler(profilerProbe_t probe, uint32_t exitCycles)
+{
+    profilerProbeStats_t *stats = &profilerStats[probe];        //Statistics of the probe
+    uint32_t cycles = exitCycles - profilerEntryCycles[probe];  //Count cycles taken by the pass, Count wrapping around in between doesn't matter
+    uint32_t bucket = 0x00000000;                               //Histogram bucket the pass falls into
+    uint32_t interruptState;                                    //Create a variable to use for preserving the state of the interrupts
+
+    cycles = (cycles > profilerBiasCycles) ? cycles - profilerBiasCycles : 0x00000000;  //Take the overhead of the probe itself back off
+
+    //Find the power of 2 range the pass falls into, CLZ does this in a single instruction
+    if (cycles >> PROFILER_HISTOGRAM_SHIFT) bucket = 0x00000020 - __builtin_clz(cycles >> PROFILER_HISTOGRAM_SHIFT);
+    if (bucket >= PROFILER_HISTOGRAM_BUCKETS) bucket = PROFILER_HISTOGRAM_BUCKETS - 0x00000001;  //Everything longer lands in the last bucket
+
+    asm volatile ("di %0" : "=r" (interruptState));  //Disable interrupts while updating, SPI transactions end both within tasks and within ISRs
+
+    stats->count++;                                                      //Count the pass
+    if (cycles < stats->minCycles) stats->minCycles = cycles;            //Keep the fewest cycles
+    if (cycles > stats->maxCycles) stats->maxCycles = cycles;            //Keep the most cycles
+    stats->totalCycles += cycles;                                        //Add onto the total for the mean
+    if (stats->histogram[bucket] != 0xFFFF) stats->histogram[bucket]++;  //Stop counting rather than wrapping back around to 0
+
+    if (interruptState & 0x00000001) asm volatile ("ei");  //Restore the interrupts if they were enabled before entering the function
+}
+
+//Take Probe Function, copies out the statistics of the given probe without a pass landing halfway through the copy
+void takeProbeProfiler(profilerProbe_t probe, profilerProbeStats_t *stats)
+{
+    uint32_t interruptState;  //Create a variable to use for preserving the state of the interrupts
+
+    asm volatile ("di %0" : "=r" (interruptState));        //Disable interrupts while copying, probes in ISRs record their passes from within them
+    *stats = profilerStats[probe];                         //Copy the statistics out
+    if (interruptState & 0x00000001) asm volatile ("ei");  //Restore the interrupts if they were enabled before entering the function
+}
+
+//Dump Profiler Function, logs the overhead of a probe followed by the statistics of every probe that has been passed through
+void dumpProfiler()
+{
+#if LOG_ENABLED(LOG_CATEGORY_TIMING, LOG_LEVEL_DEBUG)
+    profilerProbeStats_t stats;  //Copy of the statistics of the probe being logged
+    uint32_t logsQueued;         //Number of logs queued since the log queue was last emptied
+
+    if (!LOG_CONSOLE_PRESENT()) return;  //Nobody is listening for the dump
+
+    //The dump takes more logs than the queue has slots, so it waits for the queue to empty out whenever it has filled every slot
+    flushLogQueue();                                       //Start off with every slot free
+    LOG_PROFILE(profilerProbeCycles, profilerBiasCycles);  //Lead with the overhead of a probe
+    logsQueued = 0x00000001;                               //Count the overhead log as taking up the first slot
+
+    for (uint32_t probe = 0x00000000; probe < PROFILER_PROBE_COUNT; probe++)
+    {
+        takeProbeProfiler(probe, &stats);  //Take a copy of the statistics of the probe
+        if (!stats.count) continue;        //Leave out probes that haven't been passed through
+
+        //Wait for the queue to empty out once every slot has been filled
+        if (logsQueued == LOG_QUEUE_SLOTS)
+        {
+            flushLogQueue();          //Wait for every queued log to be sent, freeing up all of the slots
+            logsQueued = 0x00000000;  //Start counting the slots again from empty
+        }
+
+        LOG_PROBE(probe, &stats);  //Log the statistics of the probe
+        logsQueued++;              //Count the slot the log has taken up
+    }
+#endif
+}
+#endif
+
+
+
+
+
+
+//END OF FILE
\ No newline at end of file
@@ -0,0 +1,96 @@
+/**************************************************************************************
+ *  Yellowcard - Example firmware for the Yellowcard RF Development Kit               *
+ * ---------------------------------------------------------------------------------- *
+ *  Profiler.h - Cycle counting probes around tasks, bus transactions and interrupts  *
+ **************************************************************************************/
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+//Import any libraries used by this file
+#include <xc.h>  //Include the main header file for the XC32 compiler, provides register definitions and access to CP0 Count
+
+
+//Define any constants that are used within this file
+#ifndef PROFILER_TASK_PROBES
+#define PROFILER_TASK_PROBES    0x00000008  //Number of scheduler tasks given a probe each, has to cover SCHEDULER_MAX_TASKS
+#endif
+
+#define PROFILER_HISTOGRAM_BUCKETS     0x00000010  //Number of buckets in the histogram of each probe
+#define PROFILER_HISTOGRAM_SHIFT       0x00000004  //Bucket 0 holds passes under 2^PROFILER_HISTOGRAM_SHIFT cycles
+#define PROFILER_CALIBRATION_PASSES    0x00000008  //Number of empty probes timed at startup, the fastest of them is taken as the overhead
+
+//Define PROFILER_PROBES to time every scheduler task, every SX1231H chip-select window, every I2C transaction and every ISR in Interrupts.c with the
+//CP0 Count register (SYSCLK / 2). Each probe keeps its pass count, the fewest, most and total cycles (giving the mean) and a histogram of powers of 2
+//in a RAM table of ~1.2KB. Bucket 0 holds passes under 16 cycles, bucket n passes from 2^(n+3) up to 2^(n+4) cycles and the last bucket everything
+//from 2^18 cycles on. Without PROFILER_PROBES the probes compile away to nothing and the table and its code aren't built.
+
+//Count only advances while the core executes, so the time spent in WAIT (IDLE or SLEEP) is left out of every probe. Transactions are timed from
+//their start to their end, which for the interrupt driven I2C engine and the DMA driven SPI transfers is the CPU time spent on them rather than the
+//time spent on the bus, along with anything else that ran in between. Probes on tasks include the interrupts that preempted them and the probes
+//nested inside them, probes on ISRs leave out the context save and restore generated by the compiler. Cycles are counted at whatever operating
+//point the code ran at, so a task moved to a faster clock by the clock policy takes more of them for the same time.
+
+//PROFILE_ENTER() reads Count and stores it (2-3 instructions). PROFILE_EXIT() reads Count and calls recordProbeProfiler(), which takes ~50 more
+//instructions to update the table with interrupts disabled, so each pass adds ~55 instructions (~30 Count cycles with no flash wait states, more at
+//40MHz) to the code around the probe. Only the few instructions between the two reads of Count fall within the pass itself. initializeProfiler()
+//times empty probes at startup, taking what lands within the pass back off every sample and reporting the full cost of a probe in every dump.
+#ifdef PROFILER_PROBES
+#define PROFILE_ENTER(probe)    (profilerEntryCycles[(probe)] = _CP0_GET_COUNT())  //Marks the start of a pass through the given probe
+#define PROFILE_EXIT(probe)     recordProbeProfiler((probe), _CP0_GET_COUNT())     //Marks the end of a pass through the given probe and adds it onto the table
+#else
+#define PROFILE_ENTER(probe)
+#define PROFILE_EXIT(probe)
+#endif
+
+#define PROBE_TASK(task)    (task)  //Probe of the given scheduler task, tasks take up the first PROFILER_TASK_PROBES probes
+
+
+//Define any enums used within this file, the probes of the scheduler tasks come first
+typedef enum
+{
+    PROBE_I2C_TRANSACTION = PROFILER_TASK_PROBES, PROBE_SPI_TRANSACTION, PROBE_ISR_I2C2, PROBE_ISR_DMA0, PROBE_ISR_DMA1, PROBE_ISR_SPI1, PROBE_ISR_TIMER1,
+    PROBE_ISR_RTCC, PROBE_ISR_INT3, PROBE_ISR_DMA2, PROBE_ISR_UART2, PROBE_ISR_INT4, PROBE_ISR_CHANGE_NOTICE, PROFILER_PROBE_COUNT
+} profilerProbe_t;
+
+
+//Define any structs used within this file
+typedef struct
+{
+    uint32_t count;                                  //Number of passes through the probe
+    uint32_t minCycles;                              //Fewest Count cycles taken by a pass, 0xFFFFFFFF until the first pass
+    uint32_t maxCycles;                              //Most Count cycles taken by a pass
+    uint64_t totalCycles;                            //Count cycles taken by every pass together, divided by count for the mean
+    uint16_t histogram[PROFILER_HISTOGRAM_BUCKETS];  //Number of passes within each bucket, saturating at 0xFFFF
+} profilerProbeStats_t;
+
+
+//Define any variables that are external to this file
+#ifdef PROFILER_PROBES
+extern uint32_t profilerEntryCycles[];        //Count at which the current pass through each probe started, indexed by profilerProbe_t
+extern profilerProbeStats_t profilerStats[];  //Statistics gathered by each probe since the last reset, indexed by profilerProbe_t
+extern uint32_t profilerBiasCycles;           //Count cycles an empty pass records, taken off every sample
+extern uint32_t profilerProbeCycles;          //Count cycles each pass adds to the code around the probe
+#endif
+
+
+//Profiler Functions
+#ifdef PROFILER_PROBES
+extern void initializeProfiler();                       //Initialize Profiler Function, times empty probes to find the overhead of a probe and then clears the table
+extern void resetProfiler();                            //Reset Profiler Function, clears the statistics of every probe
+extern void recordProbeProfiler(profilerProbe_t probe,  //Record Probe Function, adds the pass through the given probe ending at the provided Count onto its statistics
+                                uint32_t exitCycles);
+extern void takeProbeProfiler(profilerProbe_t probe,    //Take Probe Function, copies out the statistics of the given probe without a pass landing halfway through the copy
+                              profilerProbeStats_t *stats);
+extern void dumpProfiler();                             //Dump Profiler Function, logs the overhead of a probe followed by the statistics of every probe that has been passed through
+#endif
+
+
+#endif
+
+
+
+
+
+
+//END OF FILE
\ No newline at end of file
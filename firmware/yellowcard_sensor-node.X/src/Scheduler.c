@@ -0,0 +1,411 @@
+/*******************************************************************************************
+ *  Yellowcard - Example firmware for the Yellowcard RF Development Kit                    *
+ * --------------------------------------------------------------------------------------- *
+ *  Scheduler.c - Cooperative tickless task scheduler driven by Timer 1 and the interrupts  *
+ *******************************************************************************************/
+
+#include "Scheduler.h"
+
+
+
+/***************
+ *  Variables  *
+ ***************/
+
+
+//Task Table
+const taskFunction_t *taskTableScheduler;  //Table of task functions, indexed by task number
+uint32_t taskCountScheduler = 0x00000000;  //Number of entries within the task table
+
+//Task State
+volatile uint32_t pendingTasksScheduler = 0x00000000;  //One bit per task, set when the task is ready to run
+volatile uint32_t timedTasksScheduler = 0x00000000;    //One bit per task, set while the task is waiting for its deadline to pass
+uint32_t deadlinesScheduler[SCHEDULER_MAX_TASKS];      //Scheduler time in Timer 1 ticks at which each timed task becomes ready
+volatile uint32_t awakeLocksScheduler = 0x00000000;    //Number of holds currently keeping the core out of SLEEP while nothing is runnable
+
+//Delay State
+volatile uint32_t delayActiveScheduler = 0x00000000;  //Set while a delay is waiting for its deadline to pass
+uint32_t delayDeadlineScheduler;                      //Scheduler time in Timer 1 ticks at which the active delay ends
+
+//Time Keeping
+volatile uint32_t timeBaseScheduler = 0x00000000;  //Scheduler time in Timer 1 ticks at the point TMR1 last started counting up from 0
+volatile uint32_t timeHoldsScheduler = 0x00000000;  //Number of holds currently keeping Timer 1 counting while nothing is waiting on a deadline
+
+//Clock Policy
+const SysClkSpeed_t *taskSpeedsScheduler = NULL;  //Operating point of each task, indexed by task number, NULL while the clock is left alone
+SysClkSpeed_t idleSpeedScheduler;                 //Operating point to rest the core at while nothing is runnable
+
+#ifdef SCHEDULER_ACCOUNT_CLOCK
+//Clock Accounting
+clockAccountScheduler_t clockAccountScheduler;  //Time spent at each operating point since the account was last taken
+#endif
+
+
+
+/******************************
+ *  Initialization Functions  *
+ ******************************/
+
+
+//Initialize Scheduler Function, hands the scheduler the table of tasks it is to run, indexed by task number
+void initializeScheduler(const taskFunction_t *taskTable, uint32_t taskCount)
+{
+    if (taskCount > SCHEDULER_MAX_TASKS) taskCount = SCHEDULER_MAX_TASKS;  //Ignore any tasks that the scheduler has no room to keep track of
+
+    taskTableScheduler = taskTable;  //Keep hold of the task table
+    taskCountScheduler = taskCount;  //Take note of how many tasks are in it
+
+    pendingTasksScheduler = 0x00000000;  //Nothing is ready to run yet
+    timedTasksScheduler = 0x00000000;    //Nothing is waiting on a deadline yet
+    T1CONCLR = 0x00008000;               //Make sure Timer 1 is stopped, it only runs while there are timed tasks
+}
+
+//Set Clock Policy Function, hands the scheduler the operating point of each task, indexed by task number, along with the one to rest the core at, NULL leaves the clock alone
+void setClockPolicyScheduler(const SysClkSpeed_t *taskSpeeds, SysClkSpeed_t idleSpeed)
+{
+    taskSpeedsScheduler = taskSpeeds;  //Keep hold of the operating point table, it needs an entry for every task in the task table
+    idleSpeedScheduler = idleSpeed;    //Take note of where to rest the core
+}
+
+
+
+/****************************
+ *  Task Control Functions  *
+ ****************************/
+
+
+//Signal Task Function, marks the given task as ready to run, safe to call from within interrupts
+void signalTask(uint32_t task)
+{
+    uint32_t interruptState;  //Create a variable to use for preserving the state of the interrupts, allowing this function to be called from within interrupts
+
+    if (task >= taskCountScheduler) return;  //Ignore any attempts to signal a task that doesn't exist
+
+    asm volatile ("di %0" : "=r" (interruptState));        //Disable interrupts while modifying the ready set, saving the previous interrupt state
+    pendingTasksScheduler |= 0x00000001 << task;           //Mark the task as ready to run
+    if (interruptState & 0x00000001) asm volatile ("ei");  //Restore the interrupts if they were enabled before entering the function
+}
+
+//Schedule Task Function, arranges for the given task to become ready once the provided number of Timer 1 ticks have passed
+void scheduleTask(uint32_t task, uint32_t ticks)
+{
+    uint32_t interruptState;  //Create a variable to use for preserving the state of the interrupts, allowing this function to be called from within interrupts
+
+    if (task >= taskCountScheduler) return;  //Ignore any attempts to schedule a task that doesn't exist
+
+    asm volatile ("di %0" : "=r" (interruptState));  //Disable interrupts while modifying the timed set, saving the previous interrupt state
+
+    deadlinesScheduler[task] = getTimeScheduler() + ticks;  //Work out the scheduler time at which the task becomes ready
+    timedTasksScheduler |= 0x00000001 << task;              //Add the task to the timed set
+    armTimerScheduler();                                    //Set Timer 1 up for whichever deadline is now the nearest
+
+    if (interruptState & 0x00000001) asm volatile ("ei");  //Restore the interrupts if they were enabled before entering the function
+}
+
+//Cancel Task Function, removes the given task from both the ready and timed sets
+void cancelTask(uint32_t task)
+{
+    uint32_t interruptState;  //Create a variable to use for preserving the state of the interrupts, allowing this function to be called from within interrupts
+
+    if (task >= taskCountScheduler) return;  //Ignore any attempts to cancel a task that doesn't exist
+
+    asm volatile ("di %0" : "=r" (interruptState));        //Disable interrupts while modifying the task sets, saving the previous interrupt state
+    pendingTasksScheduler &= ~(0x00000001 << task);        //Remove the task from the ready set
+    timedTasksScheduler &= ~(0x00000001 << task);          //Remove the task from the timed set, Timer 1 is left to run out and re-armed from its interrupt
+    if (interruptState & 0x00000001) asm volatile ("ei");  //Restore the interrupts if they were enabled before entering the function
+}
+
+//Hold Awake Function, keeps the core in IDLE rather than SLEEP while nothing is runnable until released
+void holdAwake()
+{
+    uint32_t interruptState;  //Create a variable to use for preserving the state of the interrupts
+
+    asm volatile ("di %0" : "=r" (interruptState));        //Disable interrupts while modifying the lock count, saving the previous interrupt state
+    awakeLocksScheduler++;                                 //Add another hold onto the count
+    if (interruptState & 0x00000001) asm volatile ("ei");  //Restore the interrupts if they were enabled before entering the function
+}
+
+//Release Awake Function, drops a hold placed by holdAwake(), safe to call from within interrupts
+void releaseAwake()
+{
+    uint32_t interruptState;  //Create a variable to use for preserving the state of the interrupts, allowing this function to be called from within interrupts
+
+    asm volatile ("di %0" : "=r" (interruptState));        //Disable interrupts while modifying the lock count, saving the previous interrupt state
+    if (awakeLocksScheduler) awakeLocksScheduler--;        //Take a hold off of the count, never letting it wrap around
+    if (interruptState & 0x00000001) asm volatile ("ei");  //Restore the interrupts if they were enabled before entering the function
+}
+
+//Hold Time Function, keeps Timer 1 counting even while nothing is waiting on a deadline so that getTimeScheduler() follows the time of day, until released
+void holdTimeScheduler()
+{
+    uint32_t interruptState;  //Create a variable to use for preserving the state of the interrupts
+
+    asm volatile ("di %0" : "=r" (interruptState));        //Disable interrupts while modifying the hold count, saving the previous interrupt state
+    timeHoldsScheduler++;                                  //Add another hold onto the count
+    armTimerScheduler();                                   //Start Timer 1 in case nothing else has it running
+    if (interruptState & 0x00000001) asm volatile ("ei");  //Restore the interrupts if they were enabled before entering the function
+}
+
+//Release Time Function, drops a hold placed by holdTimeScheduler(), Timer 1 stops at the end of its current period when nothing else needs it
+void releaseTimeScheduler()
+{
+    uint32_t interruptState;  //Create a variable to use for preserving the state of the interrupts
+
+    asm volatile ("di %0" : "=r" (interruptState));        //Disable interrupts while modifying the hold count, saving the previous interrupt state
+    if (timeHoldsScheduler) timeHoldsScheduler--;          //Take a hold off of the count, never letting it wrap around
+    if (interruptState & 0x00000001) asm volatile ("ei");  //Restore the interrupts if they were enabled before entering the function
+}
+
+//Run Scheduler Function, runs ready tasks in order of their task number forever, sleeping whenever there is nothing to do
+void runScheduler()
+{
+    uint32_t readyTasks;  //Copy of the ready set taken with interrupts disabled
+    uint32_t task;        //Task number of the task to run next
+#ifdef SCHEDULER_ACCOUNT_CLOCK
+    uint32_t startTicks;   //Scheduler time at which the task or rest being accounted for started
+    uint32_t startCycles;  //CP0 Count at which the task being accounted for started
+    uint32_t sleeping;     //Non-zero when the core was rested in SLEEP rather than IDLE
+#endif
+
+    while (0xFFFFFFFF)
+    {
+        //Put the core to rest whenever there is nothing ready to run
+        if (!pendingTasksScheduler)
+        {
+            if (taskSpeedsScheduler) changeClockSpeed(idleSpeedScheduler);  //Drop down to the idle operating point before resting the core
+
+#ifdef SCHEDULER_ACCOUNT_CLOCK
+            startTicks = getTimeScheduler();  //Take note of when the rest started
+            sleeping = !awakeLocksScheduler;  //Take note of which low-power mode the rest is in
+#endif
+            allowSleepMode(!awakeLocksScheduler);  //Go into SLEEP when nothing needs the peripheral clocks, otherwise only IDLE the CPU
+
+            asm volatile ("di");                                //Disable interrupts so that a task can't be signalled between checking the ready set and executing WAIT
+            if (!pendingTasksScheduler) asm volatile ("wait");  //Halt the core, a pending interrupt still wakes it even though interrupts are disabled
+            asm volatile ("ei");                                //Enable interrupts to let the pending interrupt get serviced
+            asm volatile ("ehb");                               //Clear the execution hazard so the interrupt is taken before continuing
+
+            allowSleepMode(0x00000000);  //Tasks expect WAIT to only IDLE the CPU while they wait on a peripheral
+
+#ifdef SCHEDULER_ACCOUNT_CLOCK
+            //Add the rest onto the account, SLEEP stops SYSCLK so it doesn't belong to any operating point
+            if (sleeping) clockAccountScheduler.sleepTicks += getTimeScheduler() - startTicks;
+            else clockAccountScheduler.awakeTicks[currentClockSpeed] += getTimeScheduler() - startTicks;
+#endif
+            continue;
+        }
+
+        //Take the lowest numbered ready task out of the ready set
+        asm volatile ("di");                                                    //Disable interrupts while modifying the ready set
+        readyTasks = pendingTasksScheduler;                                     //Take a copy of the ready set
+        for (task = 0x00000000; !(readyTasks & (0x00000001 << task)); task++);  //Find the lowest numbered task that is ready to run
+        pendingTasksScheduler = readyTasks & ~(0x00000001 << task);             //Remove it from the ready set, it can be signalled again while running
+        asm volatile ("ei");                                                    //Enable interrupts again
+
+#ifdef SCHEDULER_ACCOUNT_CLOCK
+        startTicks = getTimeScheduler();  //Take note of when the task started, the switch to its operating point is counted as part of it
+#endif
+        if (taskSpeedsScheduler) changeClockSpeed(taskSpeedsScheduler[task]);  //Move to the operating point the task asks for
+#ifdef SCHEDULER_ACCOUNT_CLOCK
+        startCycles = _CP0_GET_COUNT();  //Count only advances while the core is executing, so it leaves out the time the task spends in WAIT
+#endif
+
+        PROFILE_ENTER(PROBE_TASK(task));  //Start timing the task, leaving out the switch to its operating point
+        taskTableScheduler[task]();       //Run the task to completion
+        PROFILE_EXIT(PROBE_TASK(task));   //Stop timing the task
+
+#ifdef SCHEDULER_ACCOUNT_CLOCK
+        //Add the task onto the account of the operating point it ran at
+        clockAccountScheduler.activeCycles[currentClockSpeed] += _CP0_GET_COUNT() - startCycles;
+        clockAccountScheduler.awakeTicks[currentClockSpeed] += getTimeScheduler() - startTicks;
+#endif
+    }
+}
+
+
+
+/*********************
+ *  Delay Functions  *
+ *********************/
+
+
+//Delay Ticks Function, sleeps the core until the provided number of Timer 1 ticks have passed
+void delayTicks(uint32_t ticks)
+{
+    uint32_t interruptState;  //Create a variable to use for preserving the state of the interrupts
+
+    if (!ticks) return;  //Nothing to wait for
+
+    asm volatile ("di %0" : "=r" (interruptState));  //Disable interrupts while modifying the delay state, saving the previous interrupt state
+
+    delayDeadlineScheduler = getTimeScheduler() + ticks;  //Work out the scheduler time at which the delay ends
+    delayActiveScheduler = 0xFFFFFFFF;                    //Mark the delay as active, the Timer 1 interrupt clears this once it ends
+    armTimerScheduler();                                  //Set Timer 1 up for whichever deadline is now the nearest
+
+    if (interruptState & 0x00000001) asm volatile ("ei");  //Restore the interrupts if they were enabled before entering the function
+
+    restWhileBusy(&delayActiveScheduler);  //Rest the core until the Timer 1 interrupt reports the end of the delay
+}
+
+//Delay Milliseconds Function, sleeps the core for at least the provided number of milliseconds
+void delayMilliseconds(uint32_t milliseconds)
+{
+    delayTicks(SCHEDULER_TICKS_FROM_US(milliseconds * 1000ULL));  //Convert the delay into Timer 1 ticks and wait them out
+}
+
+//Delay Microseconds Function, sleeps the core for at least the provided number of microseconds, rounded up to whole Timer 1 ticks
+void delayMicroseconds(uint32_t microseconds)
+{
+    delayTicks(SCHEDULER_TICKS_FROM_US(microseconds));  //Convert the delay into Timer 1 ticks and wait them out
+}
+
+//Rest While Busy Function, rests the core until the provided flag is cleared by an interrupt, in SLEEP while no awake hold is taken and in IDLE otherwise
+void restWhileBusy(volatile uint32_t *flag)
+{
+    uint32_t callerSleepMode = OSCCON & 0x00000010;  //WAIT mode selected by the caller, put back once the flag has been cleared
+    uint32_t sleepMode;                              //Non-zero while WAIT is set to enter SLEEP
+
+    //Pick the low-power mode the same way runScheduler() does every time the core wakes, as holds can be taken or released by the interrupts that wake it
+    while (*flag)
+    {
+        sleepMode = !awakeLocksScheduler;  //Go into SLEEP when nothing needs the peripheral clocks, otherwise only IDLE the CPU
+        allowSleepMode(sleepMode);         //Select that mode for the WAIT instruction
+
+        asm volatile ("di");                                                      //Disable interrupts so that neither the flag nor the holds can change between checking them and executing WAIT
+        if (*flag && (sleepMode == !awakeLocksScheduler)) asm volatile ("wait");  //Halt the core, going back round to pick the mode again if a hold was taken or released in the meantime
+        asm volatile ("ei");                                                      //Enable interrupts to let the pending interrupt get serviced
+        asm volatile ("ehb");                                                     //Clear the execution hazard so the interrupt is taken before checking the flag again
+    }
+
+    allowSleepMode(callerSleepMode);  //Return WAIT to whichever mode the caller had selected
+}
+
+
+
+/****************************
+ *  Time Keeping Functions  *
+ ****************************/
+
+
+//Get Time Function, returns the scheduler time in Timer 1 ticks, only advancing while a timed task or delay is waiting
+uint32_t getTimeScheduler()
+{
+    uint32_t interruptState;  //Create a variable to use for preserving the state of the interrupts, allowing this function to be called from within interrupts
+    uint32_t currentTime;     //Scheduler time to be returned
+    uint32_t matchPending;    //State of the Timer 1 interrupt flag before TMR1 was read
+
+    asm volatile ("di %0" : "=r" (interruptState));  //Disable interrupts so that the time base can't change partway through, saving the previous interrupt state
+
+    currentTime = timeBaseScheduler;  //Start with the time at which TMR1 last started counting from 0
+
+    //Add on the current count of Timer 1 when it's running, including a period match that hasn't been serviced yet
+    if (T1CON & 0x00008000)
+    {
+        matchPending = IFS0 & 0x00000010;  //Check for a period match before reading TMR1
+        currentTime += TMR1;               //Add on the number of ticks since TMR1 last started counting from 0
+
+        //Account for a period match that happened before, or just after, TMR1 was read
+        if (!matchPending && (IFS0 & 0x00000010))
+        {
+            currentTime = timeBaseScheduler + TMR1 + PR1 + 0x00000001;  //TMR1 rolled over while being read, so read it again now that it has been reset
+        }
+        else if (matchPending)
+        {
+            currentTime += PR1 + 0x00000001;  //TMR1 had already rolled over, so the whole period has passed on top of its count
+        }
+    }
+
+    if (interruptState & 0x00000001) asm volatile ("ei");  //Restore the interrupts if they were enabled before entering the function
+
+    return currentTime;
+}
+
+//Service Timer Function, called from the Timer 1 interrupt when the nearest deadline has been reached
+void serviceTimerScheduler()
+{
+    timeBaseScheduler += PR1 + 0x00000001;  //A full period of Timer 1 has passed since TMR1 last started counting from 0
+    armTimerScheduler();                    //Ready any tasks that are now due and set Timer 1 up for the next deadline
+}
+
+//Arm Timer Function, readies any timed tasks that are due, ends any delay that is due and sets Timer 1 up for the next nearest deadline, must be called with interrupts disabled
+void armTimerScheduler()
+{
+    uint32_t currentTime = getTimeScheduler();  //Take note of the current time before stopping Timer 1
+    uint32_t timedTasks = timedTasksScheduler;  //Work on a copy of the timed set
+    uint32_t nearest = 0xFFFFFFFF;              //Number of ticks until the nearest deadline
+    uint32_t remaining;                         //Number of ticks until the deadline of the task being looked at
+    uint32_t task;                              //Task number of the task being looked at
+
+    //Stop Timer 1 and fold its count into the time base so that it can be restarted from 0
+    T1CONCLR = 0x00008000;            //Stop Timer 1
+    timeBaseScheduler = currentTime;  //Move the time base up to the current time
+    TMR1 = 0x00000000;                //Clear the Timer 1 count register
+    IFS0CLR = 0x00000010;             //Clear any period match that the current time already accounts for
+
+    //Ready every task whose deadline has passed and find the nearest deadline among the rest
+    for (task = 0x00000000; task < taskCountScheduler; task++)
+    {
+        if (!(timedTasks & (0x00000001 << task))) continue;  //Skip any tasks that aren't waiting on a deadline
+
+        remaining = deadlinesScheduler[task] - currentTime;  //Work out how many ticks are left until the deadline
+
+        //Deadlines that have been reached show up as a difference of 0 or one that has wrapped around past the halfway point
+        if (!remaining || (remaining & 0x80000000))
+        {
+            timedTasks &= ~(0x00000001 << task);           //Remove the task from the timed set
+            pendingTasksScheduler |= 0x00000001 << task;  //Mark the task as ready to run
+        }
+        else if (remaining < nearest)
+        {
+            nearest = remaining;  //Keep track of the nearest deadline
+        }
+    }
+
+    //Treat an active delay as one more deadline
+    if (delayActiveScheduler)
+    {
+        remaining = delayDeadlineScheduler - currentTime;  //Work out how many ticks are left until the delay ends
+
+        if (!remaining || (remaining & 0x80000000))
+        {
+            delayActiveScheduler = 0x00000000;  //End the delay, releasing whoever is waiting on it
+        }
+        else if (remaining < nearest)
+        {
+            nearest = remaining;  //Keep track of the nearest deadline
+        }
+    }
+
+    timedTasksScheduler = timedTasks;                    //Store the updated timed set
+    if (!timedTasks && !delayActiveScheduler && !timeHoldsScheduler) return;  //Leave Timer 1 stopped when nothing is waiting on a deadline or holding the time, there is no periodic tick
+
+    //Deadlines further out than a single Timer 1 period are reached over several periods
+    if (nearest > 0x00010000) nearest = 0x00010000;  //Limit the period to what PR1 can hold
+    if (nearest < 0x00000002) nearest = 0x00000002;  //Keep the period long enough for the asynchronous period match to be seen
+
+    PR1 = nearest - 0x00000001;  //Set Timer 1 to match once the nearest deadline has been reached
+    T1CONSET = 0x00008000;       //Start Timer 1 counting up from 0
+}
+
+
+
+#ifdef SCHEDULER_ACCOUNT_CLOCK
+/********************************
+ *  Clock Accounting Functions  *
+ ********************************/
+
+
+//Take Clock Account Function, copies out the time spent at each operating point since the last call and starts counting again from 0
+void takeClockAccountScheduler(clockAccountScheduler_t *account)
+{
+    *account = clockAccountScheduler;                                       //Hand the account over to the caller
+    memset(&clockAccountScheduler, 0x00, sizeof(clockAccountScheduler_t));  //Start the next account off from nothing
+}
+#endif
+
+
+
+
+
+
+//END OF FILE
\ No newline at end of file
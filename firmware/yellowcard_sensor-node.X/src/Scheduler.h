@@ -0,0 +1,104 @@
+/*******************************************************************************************
+ *  Yellowcard - Example firmware for the Yellowcard RF Development Kit                    *
+ * --------------------------------------------------------------------------------------- *
+ *  Scheduler.h - Cooperative tickless task scheduler driven by Timer 1 and the interrupts  *
+ *******************************************************************************************/
+
+#ifndef _SCHEDULER_H_
+#define _SCHEDULER_H_
+
+//Import any libraries used by this file
+#include <xc.h>         //Include the main header file for the XC32 compiler, provides register definitions
+#include <string.h>     //Include the default string library, provides NULL and memset for clearing the clock account
+#include "drv/HAL.h"    //Include the HAL header which provides the means of switching the WAIT instruction between IDLE and SLEEP modes and the clock speed
+
+
+//Define any constants that are used within this file
+#define SCHEDULER_TICK_RATE    0x00008000  //Timer 1 counts the 32.768kHz secondary oscillator directly, giving ticks of ~30.5us
+
+#ifndef SCHEDULER_MAX_TASKS
+#define SCHEDULER_MAX_TASKS    0x00000008  //Maximum number of tasks the scheduler can keep track of, can't be more than 32
+#endif
+
+#if defined(PROFILER_PROBES) && (SCHEDULER_MAX_TASKS > PROFILER_TASK_PROBES)
+#error "PROFILER_TASK_PROBES has to give every one of the SCHEDULER_MAX_TASKS tasks a probe"
+#endif
+
+//Converts a time in milliseconds or microseconds to Timer 1 ticks, rounding up so that a task or delay never finishes early
+#define SCHEDULER_TICKS_FROM_MS(ms)    ((((ms) * SCHEDULER_TICK_RATE) + 999) / 1000)
+#define SCHEDULER_TICKS_FROM_US(us)    (((((uint64_t) (us)) * SCHEDULER_TICK_RATE) + 999999) / 1000000)
+
+//Tasks are plain functions that run to completion, anything that has to wait on hardware is split into separate tasks which are either signalled
+//from the interrupt that ends the wait or scheduled for when the hardware is known to be done. Timer 1 only runs while a timed task is waiting,
+//with PR1 set to the nearest deadline rather than ticking periodically. When nothing is runnable the core is put into SLEEP, or into IDLE while
+//any awake locks are held by something that needs the peripheral clocks to keep running (DMA transfers, UART transmissions, etc).
+
+//Delays share Timer 1 with the timed tasks and sleep the core the same way, so they don't depend on the clock speed or optimization level. Their
+//resolution is a single ~30.5us tick with a minimum of 2 ticks, since the asynchronous Timer 1 needs that long to see a period match. Delays taken
+//before the secondary oscillator has started up after power on run long rather than short, as Timer 1 doesn't count until it does.
+
+//Once given a clock policy the scheduler moves the system clock to the operating point each task asks for right before running it, and to the idle
+//operating point before resting the core, so that bursts of work can run fast while the waits on sensors, the radio and the UART run slow. Waits
+//that a task does from within itself (I2C reads, polled SPI, delays) happen at the operating point of that task. Switches wait for the buses to go
+//quiet first (see changeClockSpeed()), so they are cheapest between bursts rather than in the middle of them.
+
+//Define SCHEDULER_ACCOUNT_CLOCK to have the scheduler keep track of where the time goes at each operating point, counting both the CP0 Count cycles
+//spent executing tasks and the Timer 1 ticks spent awake (running tasks or resting in IDLE), along with the Timer 1 ticks spent in SLEEP. Timer 1
+//only counts while a timed task or delay is waiting or the time is held, and delays taken inside a task are counted as awake time of that task.
+
+
+//Define any types that are used within this file
+typedef void (*taskFunction_t)();
+
+#ifdef SCHEDULER_ACCOUNT_CLOCK
+typedef struct
+{
+    uint32_t activeCycles[SYSCLK_SPEED_COUNT];  //CP0 Count cycles (SYSCLK / 2) spent executing tasks at each operating point
+    uint32_t awakeTicks[SYSCLK_SPEED_COUNT];    //Timer 1 ticks spent at each operating point either running tasks or resting in IDLE
+    uint32_t sleepTicks;                        //Timer 1 ticks spent resting in SLEEP
+} clockAccountScheduler_t;
+#endif
+
+
+//Initialization Functions
+extern void initializeScheduler(const taskFunction_t *taskTable,  //Initialize Scheduler Function, hands the scheduler the table of tasks it is to run, indexed by task number
+                                uint32_t taskCount);
+extern void setClockPolicyScheduler(const SysClkSpeed_t *taskSpeeds,  //Set Clock Policy Function, hands the scheduler the operating point of each task, indexed by task number, along with the one to rest the core at, NULL leaves the clock alone
+                                    SysClkSpeed_t idleSpeed);
+
+//Task Control Functions
+extern void signalTask(uint32_t task);                 //Signal Task Function, marks the given task as ready to run, safe to call from within interrupts
+extern void scheduleTask(uint32_t task,                //Schedule Task Function, arranges for the given task to become ready once the provided number of Timer 1 ticks have passed
+                         uint32_t ticks);
+extern void cancelTask(uint32_t task);                 //Cancel Task Function, removes the given task from both the ready and timed sets
+extern void holdAwake();                               //Hold Awake Function, keeps the core in IDLE rather than SLEEP while nothing is runnable until released
+extern void releaseAwake();                            //Release Awake Function, drops a hold placed by holdAwake(), safe to call from within interrupts
+extern void runScheduler();                            //Run Scheduler Function, runs ready tasks in order of their task number forever, sleeping whenever there is nothing to do
+
+//Delay Functions
+extern void delayTicks(uint32_t ticks);                //Delay Ticks Function, sleeps the core until the provided number of Timer 1 ticks have passed
+extern void delayMilliseconds(uint32_t milliseconds);  //Delay Milliseconds Function, sleeps the core for at least the provided number of milliseconds
+extern void delayMicroseconds(uint32_t microseconds);  //Delay Microseconds Function, sleeps the core for at least the provided number of microseconds, rounded up to whole Timer 1 ticks
+extern void restWhileBusy(volatile uint32_t *flag);    //Rest While Busy Function, rests the core until the provided flag is cleared by an interrupt, in SLEEP while no awake hold is taken and in IDLE otherwise
+
+//Time Keeping Functions
+extern uint32_t getTimeScheduler();                    //Get Time Function, returns the scheduler time in Timer 1 ticks, only advancing while a timed task or delay is waiting or the time is held
+extern void serviceTimerScheduler();                   //Service Timer Function, called from the Timer 1 interrupt when the nearest deadline has been reached
+extern void armTimerScheduler();                       //Arm Timer Function, readies any timed tasks that are due, ends any delay that is due and sets Timer 1 up for the next nearest deadline
+extern void holdTimeScheduler();                       //Hold Time Function, keeps Timer 1 counting even while nothing is waiting on a deadline so that getTimeScheduler() follows the time of day
+extern void releaseTimeScheduler();                    //Release Time Function, drops a hold placed by holdTimeScheduler()
+
+//Clock Accounting Functions
+#ifdef SCHEDULER_ACCOUNT_CLOCK
+extern void takeClockAccountScheduler(clockAccountScheduler_t *account);  //Take Clock Account Function, copies out the time spent at each operating point since the last call and starts counting again from 0
+#endif
+
+
+#endif
+
+
+
+
+
+
+//END OF FILE
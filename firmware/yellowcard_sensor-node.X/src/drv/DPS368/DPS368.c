@@ -12,30 +12,15 @@
  *  Variables  *
  ***************/
 
-//Measurement Scaling Factors
-uint32_t presScalingFactorDPS368;  //Scaling factor to be applied to all raw pressure data
-uint32_t tempScalingFactorDPS368;  //Scaling factor to be applied to all raw temperature data
-
-//Sensor Calibration Coefficients
-int16_t dps368Cal_c0;
-int16_t dps368Cal_c1;
-int32_t dps368Cal_c00;
-int32_t dps368Cal_c10;
-int16_t dps368Cal_c01;
-int16_t dps368Cal_c11;
-int16_t dps368Cal_c20;
-int16_t dps368Cal_c21;
-int16_t dps368Cal_c30;
-
-//Scaling factor lookup table
-const uint32_t dps368Cal_scalingFactors[] = {0x00080000,   //No oversampling
-                                             0x00180000,   //2x oversampling
-                                             0x00380000,   //4x oversampling
-                                             0x00780000,   //8x oversampling
-                                             0x0003E000,   //16x oversampling
-                                             0x0007E000,   //32x oversampling
-                                             0x000FE000,   //64x oversampling
-                                             0x001FE000};  //128x oversampling
+//Scaling factor reciprocal lookup table, generated at compile time from the scaling factors of each oversampling rate given in the datasheet
+const uint32_t dps368Cal_reciprocals[] = {DPS368_RECIPROCAL(0x00080000),   //No oversampling
+                                          DPS368_RECIPROCAL(0x00180000),   //2x oversampling
+                                          DPS368_RECIPROCAL(0x00380000),   //4x oversampling
+                                          DPS368_RECIPROCAL(0x00780000),   //8x oversampling
+                                          DPS368_RECIPROCAL(0x0003E000),   //16x oversampling
+                                          DPS368_RECIPROCAL(0x0007E000),   //32x oversampling
+                                          DPS368_RECIPROCAL(0x000FE000),   //64x oversampling
+                                          DPS368_RECIPROCAL(0x001FE000)};  //128x oversampling
 
 
 
@@ -45,13 +30,14 @@ const uint32_t dps368Cal_scalingFactors[] = {0x00080000,   //No oversampling
 
 
 //Initialize DPS368 Function, configures the sensor to behave with the desired operating traits
-uint32_t initializeDPS368(precisionDPS368_t presOversample, backgroundDPS368_t presMeasureRate, precisionDPS368_t tempOversample, backgroundDPS368_t tempMeasureRate, uint32_t enableFIFO)
+uint32_t initializeDPS368(calibrationDPS368_t *calibration, precisionDPS368_t presOversample, backgroundDPS368_t presMeasureRate, precisionDPS368_t tempOversample, backgroundDPS368_t tempMeasureRate, uint32_t enableFIFO, uint32_t interruptConfig)
 {
     presOversample &= 0x00000007;  //Keep only the 3 least significant bits of the provided pressure oversampling setting
     tempOversample &= 0x00000007;  //Keep only the 3 least significant bits of the provided temperature oversampling setting
     
-    presScalingFactorDPS368 = dps368Cal_scalingFactors[presOversample];  //Use the lookup table to set the scaling factor for pressure results based on the given oversampling setting
-    tempScalingFactorDPS368 = dps368Cal_scalingFactors[tempOversample];  //Use the lookup table to set the scaling factor for temperature results based on the given oversampling setting
+    calibration->presReciprocal = dps368Cal_reciprocals[presOversample];  //Use the lookup table to set the reciprocal of the pressure scaling factor for the given oversampling setting
+    calibration->tempReciprocal = dps368Cal_reciprocals[tempOversample];  //Use the lookup table to set the reciprocal of the temperature scaling factor for the given oversampling setting
+    prepareTempTermsDPS368(calibration);                                  //Fold the new temperature reciprocal into the temperature terms of the calibration context
 
     uint8_t dataBuffer[0x00000005];                   //Create a 5 byte long array for buffering the bytes that shall be sent to the sensor to configure it as specified by the application
     uint8_t *arrayPointer = dataBuffer + 0x00000002;  //Declare a pointer that points to the array
@@ -66,7 +52,7 @@ uint32_t initializeDPS368(precisionDPS368_t presOversample, backgroundDPS368_t p
     *arrayPointer++ = ((presMeasureRate & 0x00000007) << 0x00000004) | (presOversample);                           //Form the configuration byte for the PRS_CFG register
     *arrayPointer++ = ((tempMeasureRate & 0x00000007) << 0x00000004) | (tempOversample) | (*arrayPointer & 0x80);  //Form the configuration byte for the TMP_CFG register
     *arrayPointer++ = 0x00;                                                                                        //Form the configuration byte for the MEAS_CFG register
-    *arrayPointer = 0x00;                                                                                          //Form the starting configuration byte for the CFG_REG register
+    *arrayPointer = interruptConfig & 0xF0;                                                                        //Form the starting configuration byte for the CFG_REG register from the requested interrupt sources and polarity
 
     if (enableFIFO) *arrayPointer |= 0x02;                    //Set Bit-1 in CFG_REG to enable the use of the FIFO buffer
     if (presOversample >= 0x00000004) *arrayPointer |= 0x04;  //Set Bit-2 in CFG_REG to activate the pressure result bit-shift mode when oversampling 8 or more times per measurement
@@ -99,6 +85,22 @@ resultStatusDPS368_t getResultStatusDPS368()
     return (resultStatusDPS368_t) (dataBuffer & 0x30) >> 0x00000004;  //Return the obtained measurement status enum
 }
 
+//Read Interrupt Status Function, obtains the INT_STS bits of the sensor, clearing them and releasing its interrupt pin
+uint32_t readInterruptStatusDPS368(uint8_t *status)
+{
+    *status = 0x0A;  //Address of the INT_STS register on the sensor
+
+    return readFromI2C(DPS368_I2C_ADDR, status, 0x00000001, 0x00000001);  //Read the contents of the INT_STS register and return whether the read was successful
+}
+
+//Read Product ID Function, obtains the product and revision ID byte of the sensor
+uint32_t readProductIdDPS368(uint8_t *productId)
+{
+    *productId = 0x0D;  //Address of the Product ID register on the sensor
+
+    return readFromI2C(DPS368_I2C_ADDR, productId, 0x00000001, 0x00000001);  //Read the contents of the Product ID register and return whether the read was successful
+}
+
 //Clear FIFO Function, clears the contents of the FIFO buffer on the sensor
 uint32_t clearFifoDPS368()
 {
@@ -125,6 +127,23 @@ uint32_t getResultsFromFifoDPS368(uint32_t *rawResults, uint32_t count)
     return getResultsAtAddressDPS368(0x00, rawResults, count);  //Read the desired number of 24-bit result values from the sensors FIFO buffer
 }
 
+//Drain FIFO Function, reads results out of the sensor's FIFO until it runs empty or the array is full, returning how many were obtained
+uint32_t drainFifoDPS368(uint32_t *rawResults, uint32_t maxCount)
+{
+    uint32_t count = 0x00000000;  //Number of results obtained from the FIFO so far
+
+    //The FIFO only presents its results through the PRS_Bx registers, so every result is a 3 byte read of its own rather than one long burst
+    while (count < maxCount)
+    {
+        if (!getResultsAtAddressDPS368(0x00, rawResults + count, 0x00000001)) break;  //Stop at the first read that fails
+        if (rawResults[count] == DPS368_FIFO_EMPTY) break;                          //Stop once the FIFO reports that it has run out of results
+
+        count++;  //Keep the result and move on to the next one
+    }
+
+    return count;  //Return the number of results placed into the array
+}
+
 
 
 /*********************
@@ -132,30 +151,78 @@ uint32_t getResultsFromFifoDPS368(uint32_t *rawResults, uint32_t count)
  *********************/
 
 
+//Convert To Centi-Celsius From DPS368, returns the temperature in hundredths of a degree Celsius from the provided raw DPS368 sensor data
+int32_t convertToCentiCFromDPS368(const calibrationDPS368_t *calibration, uint32_t rawTemperature)
+{
+    forceSign32((int32_t *) &rawTemperature, 0x00000018);  //Convert the provided 24-bit unsigned 2's complemented temperature value into a signed 32-bit integer
+
+    //c0 * 0.5 + c1 * Traw_sc as demonstrated by the DPS368 datasheet, with the scaling by 100 and the division by kT already folded into tempOffset and tempGain
+    return calibration->tempOffset + (int32_t) ((((int64_t) calibration->tempGain * (int32_t) rawTemperature) + 0x08000000) >> 0x0000001C);
+}
+
+//Convert To Centi-Pascals From DPS368, returns the pressure in hundredths of a Pascal from the provided raw DPS368 sensor data
+int32_t convertToCentiPaFromDPS368(const calibrationDPS368_t *calibration, uint32_t rawPressure, uint32_t rawTemperature)
+{
+    int32_t scaledPres = scaleRawDPS368(rawPressure, calibration->presReciprocal);     //Calculate the scaled pressure result in Q24 based on the pressure oversampling configuration
+    int32_t scaledTemp = scaleRawDPS368(rawTemperature, calibration->tempReciprocal);  //Calculate the scaled temperature result in Q24 based on the temperature oversampling configuration
+    int64_t presTerms;                                                                 //Accumulator for the terms of the polynomial that only depend on the pressure, in Q24 Pascals
+    int64_t tempTerms;                                                                 //Accumulator for the terms of the polynomial that depend on the temperature, in Q24 Pascals
+
+    //Evaluate c00 + Praw_sc * (c10 + Praw_sc * (c20 + Praw_sc * c30)) using Horner's method
+    presTerms = ((int64_t) calibration->c30 * scaledPres) + calibration->c20;  //c20 + Praw_sc * c30
+    presTerms = mulQ24DPS368(presTerms, scaledPres) + calibration->c10;       //c10 + Praw_sc * (...)
+    presTerms = mulQ24DPS368(presTerms, scaledPres) + calibration->c00;       //c00 + Praw_sc * (...)
+
+    //Evaluate Traw_sc * (c01 + Praw_sc * (c11 + Praw_sc * c21)) using Horner's method
+    tempTerms = ((int64_t) calibration->c21 * scaledPres) + calibration->c11;  //c11 + Praw_sc * c21
+    tempTerms = mulQ24DPS368(tempTerms, scaledPres) + calibration->c01;       //c01 + Praw_sc * (...)
+    tempTerms = mulQ24DPS368(tempTerms, scaledTemp);                          //Traw_sc * (...)
+
+    presTerms += tempTerms;  //Add both halves of the polynomial together to get the compensated pressure in Q24 Pascals
+
+    //Scale the result up by 100 and round it to the nearest hundredth, dropping 8 of the fraction bits first so that the multiplication can't overflow
+    presTerms = (((presTerms >> 0x00000008) * 0x00000064) + 0x00008000) >> 0x00000010;
+
+    //Clamp the result to what an int32_t can hold, only nonsensical raw values can get anywhere near these limits
+    if (presTerms > 0x000000007FFFFFFFLL) return 0x7FFFFFFF;
+    if (presTerms < -0x0000000080000000LL) return (int32_t) 0x80000000;
+
+    return (int32_t) presTerms;  //Return the calculated compensated pressure
+}
+
+#ifdef DPS368_FLOAT_REFERENCE
 //Convert To Temperature Celsius From DPS368, returns the temperature in Celsius from the provided raw DPS368 sensor data
-float convertToTempCFromDPS368(uint32_t rawTemperature)
+float convertToTempCFromDPS368(const calibrationDPS368_t *calibration, uint32_t rawTemperature)
 {
-    forceSign32(&rawTemperature, 0x00000018);                                       //Convert the provided 24-bit unsigned 2's complemented temperature value into a signed 32-bit integer
-    float scaledTemp = (float) (int32_t) rawTemperature / tempScalingFactorDPS368;  //Calculate the scaled temperature result based on the temperature oversampling configuration
+    forceSign32((int32_t *) &rawTemperature, 0x00000018);                                                      //Convert the provided 24-bit unsigned 2's complemented temperature value into a signed 32-bit integer
+    float scaledTemp = (float) (int32_t) rawTemperature * (calibration->tempReciprocal / 281474976710656.0F);  //Calculate the scaled temperature result based on the temperature oversampling configuration
 
-    return (scaledTemp * dps368Cal_c1) + (dps368Cal_c0 * 0.5F);  //Calculate the compensated temperature in Celsius as demonstrated by the DPS368 datasheet
+    return (scaledTemp * calibration->c1) + (calibration->c0 * 0.5F);  //Calculate the compensated temperature in Celsius as demonstrated by the DPS368 datasheet
 }
 
 //Convert To Pressure From DPS368, returns the pressure in Pascals from the provided raw DPS368 sensor data
-float convertToPressureFromDPS368(uint32_t rawPressure, uint32_t rawTemperature)
+float convertToPressureFromDPS368(const calibrationDPS368_t *calibration, uint32_t rawPressure, uint32_t rawTemperature)
 {
-    forceSign32(&rawPressure, 0x00000018);     //Convert the provided 24-bit unsigned 2's complemented pressure value into a signed 32-bit integer
-    forceSign32(&rawTemperature, 0x00000018);  //Convert the provided 24-bit unsigned 2's complemented temperature value into a signed 32-bit integer
+    forceSign32((int32_t *) &rawPressure, 0x00000018);     //Convert the provided 24-bit unsigned 2's complemented pressure value into a signed 32-bit integer
+    forceSign32((int32_t *) &rawTemperature, 0x00000018);  //Convert the provided 24-bit unsigned 2's complemented temperature value into a signed 32-bit integer
 
-    float scaledPres = (float) (int32_t) rawPressure / presScalingFactorDPS368;     //Calculate the scaled pressure result based on the pressure oversampling configuration
-    float scaledTemp = (float) (int32_t) rawTemperature / tempScalingFactorDPS368;  //Calculate the scaled temperature result based on the temperature oversampling configuration
+    float scaledPres = (float) (int32_t) rawPressure * (calibration->presReciprocal / 281474976710656.0F);     //Calculate the scaled pressure result based on the pressure oversampling configuration
+    float scaledTemp = (float) (int32_t) rawTemperature * (calibration->tempReciprocal / 281474976710656.0F);  //Calculate the scaled temperature result based on the temperature oversampling configuration
 
-    //Calculate the compensated pressure in Pascals as demonstrated by the DPS368 datasheet 
-    float compensatedPres = (((scaledPres * dps368Cal_c30 + dps368Cal_c20) * scaledPres + dps368Cal_c10) * scaledPres) +
-                            ((scaledPres * dps368Cal_c21 + dps368Cal_c11) * scaledPres * scaledTemp) + (scaledTemp + dps368Cal_c01) + dps368Cal_c00;
+    //Recover the coefficients as read from the sensor, the Q24 ones have nothing below their 24 fraction bits so the shifts are exact
+    float c00 = (float) (calibration->c00 >> 0x00000018);
+    float c10 = (float) (calibration->c10 >> 0x00000018);
+    float c20 = (float) (calibration->c20 >> 0x00000018);
+    float c01 = (float) (calibration->c01 >> 0x00000018);
+    float c11 = (float) (calibration->c11 >> 0x00000018);
+
+    //Calculate the compensated pressure in Pascals as demonstrated by the DPS368 datasheet
+    float compensatedPres = (((scaledPres * calibration->c30 + c20) * scaledPres + c10) * scaledPres) +
+                            ((scaledPres * calibration->c21 + c11) * scaledPres * scaledTemp) + (scaledTemp * c01) + c00;
 
     return compensatedPres;  //Return the calculated compensated pressure
 }
+#endif
 
 
 
@@ -164,14 +231,14 @@ float convertToPressureFromDPS368(uint32_t rawPressure, uint32_t rawTemperature)
  ***********************/
 
 
-//Get Calibration Coefficients Function, reads the calibration coefficients from the sensor to use for processing the results
-uint32_t readCalCoeffsDPS368()
+//Get Calibration Coefficients Function, reads the calibration coefficients from the sensor and prepares the calibration context from them
+uint32_t readCalCoeffsDPS368(calibrationDPS368_t *calibration)
 {
     uint8_t dataBuffer[0x00000012];  //Create an array of 18 bytes to use as a buffer for reading data from the sensor
 
     //Verify that the calibration coefficients are ready to be retrieved from the sensor
-    *dataBuffer = 0x08;                                                      //Select the MEAS_CFG register on the sensor
-    if (!readFromI2C(DPS368_I2C_ADDR, dataBuffer, 0x00000001, 0x00000001));  //Attempt to read the contents of the MEAS_CFG register on the sensor, leave if no response is received
+    *dataBuffer = 0x08;                                                                        //Select the MEAS_CFG register on the sensor
+    if (!readFromI2C(DPS368_I2C_ADDR, dataBuffer, 0x00000001, 0x00000001)) return 0x00000000;  //Attempt to read the contents of the MEAS_CFG register on the sensor, leave if no response is received
 
     if (!(*dataBuffer & 0x80)) return 0x00;  //Leave the function if the coefficients aren't available yet
 
@@ -179,28 +246,40 @@ uint32_t readCalCoeffsDPS368()
     *dataBuffer = 0x10;                                                                        //Set the start address of the read sequence to the first byte of the calibration coefficients
     if (!readFromI2C(DPS368_I2C_ADDR, dataBuffer, 0x00000012, 0x00000001)) return 0x00000000;  //Read the memory space in which the calibration data lives in from the sensor into the dataBuffer array
 
-    uint8_t *arrayPointer = dataBuffer;  //Declare a pointer to the dataBuffer array to use for iterating through each index of the array while extracting the coefficients
-
-    //Extract the data from the byte array into their respective variables
-    dps368Cal_c0 = (*arrayPointer++ << 0x00000004) | ((*arrayPointer & 0xF0) >> 0x00000004);
-    dps368Cal_c1 = ((*arrayPointer++ & 0x0F) << 0x00000008) | (*arrayPointer++);
-    dps368Cal_c00 = (*arrayPointer++ << 0x0000000C) | (*arrayPointer++ << 0x00000004) | ((*arrayPointer & 0xF0) >> 0x00000004);
-    dps368Cal_c10 = ((*arrayPointer++ & 0x0F) << 0x00000010) | (*arrayPointer++ << 0x00000008) | (*arrayPointer++);
-    dps368Cal_c01 = (*arrayPointer++ << 0x00000008) | (*arrayPointer++);
-    dps368Cal_c11 = (*arrayPointer++ << 0x00000008) | (*arrayPointer++);
-    dps368Cal_c20 = (*arrayPointer++ << 0x00000008) | (*arrayPointer++);
-    dps368Cal_c21 = (*arrayPointer++ << 0x00000008) | (*arrayPointer++);
-    dps368Cal_c30 = (*arrayPointer++ << 0x00000008) | (*arrayPointer);
-
-    //Correct the sign of the values stored in the variables when required
-    forceSign16(&dps368Cal_c0, 0x0000000C);   //Apply 12-bit 2's complements to the number to correct the sign
-    forceSign16(&dps368Cal_c1, 0x0000000C);   //Apply 12-bit 2's complements to the number to correct the sign
-    forceSign32(&dps368Cal_c00, 0x00000014);  //Apply 20-bit 2's complements to the number to correct the sign
-    forceSign32(&dps368Cal_c10, 0x00000014);  //Apply 20-bit 2's complements to the number to correct the sign
+    //Extract the 12 and 20-bit coefficients, correcting their sign with the matching 2's complement bit-depth
+    int32_t c00 = (dataBuffer[0x03] << 0x0000000C) | (dataBuffer[0x04] << 0x00000004) | (dataBuffer[0x05] >> 0x00000004);
+    int32_t c10 = ((dataBuffer[0x05] & 0x0F) << 0x00000010) | (dataBuffer[0x06] << 0x00000008) | dataBuffer[0x07];
+    calibration->c0 = (dataBuffer[0x00] << 0x00000004) | (dataBuffer[0x01] >> 0x00000004);
+    calibration->c1 = ((dataBuffer[0x01] & 0x0F) << 0x00000008) | dataBuffer[0x02];
+
+    forceSign16(&calibration->c0, 0x0000000C);  //Apply 12-bit 2's complements to the number to correct the sign
+    forceSign16(&calibration->c1, 0x0000000C);  //Apply 12-bit 2's complements to the number to correct the sign
+    forceSign32(&c00, 0x00000014);              //Apply 20-bit 2's complements to the number to correct the sign
+    forceSign32(&c10, 0x00000014);              //Apply 20-bit 2's complements to the number to correct the sign
+
+    //Store the pressure coefficients in the form the Horner chains add them in, the 16-bit ones already carry their sign
+    calibration->c00 = (int64_t) c00 << 0x00000018;                                                              //c00 in Q24
+    calibration->c10 = (int64_t) c10 << 0x00000018;                                                              //c10 in Q24
+    calibration->c01 = (int64_t) (int16_t) ((dataBuffer[0x08] << 0x00000008) | dataBuffer[0x09]) << 0x00000018;  //c01 in Q24
+    calibration->c11 = (int64_t) (int16_t) ((dataBuffer[0x0A] << 0x00000008) | dataBuffer[0x0B]) << 0x00000018;  //c11 in Q24
+    calibration->c20 = (int64_t) (int16_t) ((dataBuffer[0x0C] << 0x00000008) | dataBuffer[0x0D]) << 0x00000018;  //c20 in Q24
+    calibration->c21 = (int16_t) ((dataBuffer[0x0E] << 0x00000008) | dataBuffer[0x0F]);                          //c21 as read
+    calibration->c30 = (int16_t) ((dataBuffer[0x10] << 0x00000008) | dataBuffer[0x11]);                          //c30 as read
+
+    prepareTempTermsDPS368(calibration);  //Fold the temperature reciprocal into the freshly read c0 and c1 coefficients
 
     return 0xFFFFFFFF;  //Return a non-negative value to indicate the coefficients were read successfully
 }
 
+//Prepare Temperature Terms Function, folds the temperature reciprocal into the c0 and c1 coefficients of the calibration context
+void prepareTempTermsDPS368(calibrationDPS368_t *calibration)
+{
+    calibration->tempOffset = calibration->c0 * 0x00000032;  //c0 * 0.5 scaled up to hundredths of a degree Celsius
+
+    //c1 * 100 / kT in Q28, the reciprocal is 2^48 / kT so 20 bits are dropped, at most 2^28 for the smallest scaling factor so it fits comfortably
+    calibration->tempGain = (int32_t) ((((int64_t) (calibration->c1 * 0x00000064) * calibration->tempReciprocal) + 0x00080000) >> 0x00000014);
+}
+
 //Get Results At Address Function, obtains the requested number of 24-bit results from the sensor at the provided start address
 uint32_t getResultsAtAddressDPS368(uint32_t address, uint32_t *results, uint32_t count)
 {
@@ -221,6 +300,24 @@ uint32_t getResultsAtAddressDPS368(uint32_t address, uint32_t *results, uint32_t
     return 0xFFFFFFFF;  //Return a non-negative value to indicate the results were obtained successfully
 }
 
+//Scale Raw Function, sign extends the provided 24-bit raw result and divides it by its scaling factor using the reciprocal, returning the result in Q24
+int32_t scaleRawDPS368(uint32_t rawValue, uint32_t reciprocal)
+{
+    forceSign32((int32_t *) &rawValue, 0x00000018);  //Convert the provided 24-bit unsigned 2's complemented value into a signed 32-bit integer
+
+    return (int32_t) (((int64_t) (int32_t) rawValue * (int32_t) reciprocal) >> 0x00000018);  //Multiply by 2^48 / k and drop 24 bits, leaving raw / k in Q24
+}
+
+//Multiply Q24 Function, multiplies a 64-bit value by a Q24 value returning the result shifted back down by 24 bits, using two 32x32 to 64-bit multiplies
+int64_t mulQ24DPS368(int64_t value, int32_t factorQ24)
+{
+    int64_t upperProduct = (int64_t) (int32_t) (value >> 0x00000020) * factorQ24;        //Multiply the signed upper word of the value by the factor
+    uint64_t lowerProduct = (uint64_t) (uint32_t) value * (uint32_t) factorQ24;           //Multiply the unsigned lower word of the value by the factor treated as unsigned
+    if (factorQ24 < 0x00000000) lowerProduct -= (uint64_t) (uint32_t) value << 0x00000020;  //Correct the lower product for the sign of the factor
+
+    return (upperProduct << 0x00000008) + ((int64_t) lowerProduct >> 0x00000018);  //Recombine both halves, the upper product already sits 32 bits up so it only moves up by 8
+}
+
 //Force Sign 16 Function, forces the given value into it's 16-bit signed equivalent using the provided bit-depth
 void forceSign16(int16_t *value, uint32_t bitDepth)
 {
@@ -17,6 +17,44 @@
 #define DPS368_I2C_ADDR    0x76  //Sets the I2C address of the device
 #endif
 
+#ifndef DPS368_INT_PORTB_MASK
+#define DPS368_INT_PORTB_MASK    0x00000001  //Port B pin that the SDO/INT pin of the sensor is wired to, watched through the change notice interrupt, 0x01 selects RB0
+#endif
+
+//CFG_REG bits selecting which events assert the interrupt on the SDO pin of the sensor, ORed together and handed to initializeDPS368(). In I2C mode
+//the SDO pin also selects the address, so with it pulled low for address 0x76 the interrupt has to be active high to not fight the address strap.
+#define DPS368_INT_ACTIVE_HIGH    0x80  //INT_HL, the interrupt pin is driven high while an interrupt is pending
+#define DPS368_INT_FIFO_FULL      0x40  //INT_FIFO, interrupt when the FIFO buffer is full
+#define DPS368_INT_TEMP_READY     0x20  //INT_TMP, interrupt when a temperature measurement is ready
+#define DPS368_INT_PRES_READY     0x10  //INT_PRS, interrupt when a pressure measurement is ready
+
+//INT_STS bits telling which of the events caused the interrupt, reading INT_STS clears them and releases the interrupt pin
+#define DPS368_STS_FIFO_FULL     0x04  //INT_FIFO_FULL, the FIFO buffer is full
+#define DPS368_STS_TEMP_READY    0x02  //INT_TMP, a temperature measurement is ready
+#define DPS368_STS_PRES_READY    0x01  //INT_PRS, a pressure measurement is ready
+
+#define DPS368_SENSOR_READY_MS    0x0000000C  //Time in milliseconds after power on until the sensor is ready to communicate and be configured
+#define DPS368_COEF_READY_MS      0x00000028  //Time in milliseconds after power on until the calibration coefficients can be read out of the sensor
+
+#define DPS368_FIFO_SIZE     0x00000020  //Number of results the FIFO buffer of the sensor can hold
+#define DPS368_FIFO_EMPTY    0x00800000  //Value read back from the FIFO buffer once it has run out of results
+
+//Generates the reciprocal of a scaling factor in the form 2^48 / k at compile time, turning the per sample division by k into a 32x32 to 64-bit multiply
+#define DPS368_RECIPROCAL(k)    ((uint32_t) ((0x0001000000000000ULL + ((k) >> 1)) / (k)))
+
+//The integer conversions keep Traw_sc and Praw_sc in Q24 (24-bit raw values divided by k, so at most ~33 for the smallest scaling factor) and carry
+//the polynomial in 64-bit Q24 Pascals. Every multiply is a 32x32 to 64-bit MULT/MULTU on the M4K core, keeping each conversion to a few dozen cycles
+//instead of the thousands spent in soft float. For typical coefficients the pressure stays within 0.02Pa of the double precision reference over the
+//300 to 1200hPa the sensor is specified for, and within 0.2Pa over the full raw range, as checked by host/Dps368AccuracyTest.c.
+//Define DPS368_FLOAT_REFERENCE to also build the float conversions from the datasheet for comparison.
+
+//Everything the conversions need that only changes with the coefficients or the oversampling settings is worked out once into a calibrationDPS368_t
+//by readCalCoeffsDPS368() and initializeDPS368(), leaving each sample with two reciprocal multiplies, the Horner chains and a single multiply for the
+//temperature. Each sensor instance gets its own context, none of the conversion functions touch any state outside of the one they are handed.
+
+//Time in microseconds taken by a single measurement at the given oversampling rate, fits the 3.6ms, 5.2ms, 8.4ms ... 206.8ms figures from the datasheet
+#define DPS368_MEASURE_TIME_US(precision)    (2000 + (1600 << (precision)))
+
 
 //Define any enum types used within this file
 typedef enum
@@ -40,35 +78,74 @@ typedef enum
 } resultStatusDPS368_t;
 
 
+//Define any structs used within this file
+typedef struct
+{
+    int64_t c00;              //c00 in Q24 Pascals, ready to be added onto the Horner chain
+    int64_t c10;              //c10 in Q24
+    int64_t c20;              //c20 in Q24
+    int64_t c01;              //c01 in Q24
+    int64_t c11;              //c11 in Q24
+    int32_t c30;              //c30 as read, its product with the Q24 Praw_sc is already in Q24
+    int32_t c21;              //c21 as read, its product with the Q24 Praw_sc is already in Q24
+    uint32_t presReciprocal;  //2^48 divided by the pressure scaling factor of the configured oversampling rate
+    uint32_t tempReciprocal;  //2^48 divided by the temperature scaling factor of the configured oversampling rate
+    int32_t tempOffset;       //c0 * 0.5 in hundredths of a degree Celsius
+    int32_t tempGain;         //c1 * 100 / kT in Q28, turns the sign extended raw temperature into hundredths of a degree Celsius with a single multiply
+    int16_t c0;               //c0 as read, kept for rebuilding the temperature terms when the oversampling changes
+    int16_t c1;               //c1 as read, kept for rebuilding the temperature terms when the oversampling changes
+} calibrationDPS368_t;
+
+
 //Initialization Functions
-extern uint32_t initializeDPS368(precisionDPS368_t presOversample,    //Initialize DPS368 Function, configures the sensor to behave with the desired operating traits
+extern uint32_t initializeDPS368(calibrationDPS368_t *calibration,    //Initialize DPS368 Function, configures the sensor to behave with the desired operating traits and updates the calibration context to match
+                                 precisionDPS368_t presOversample,
                                  backgroundDPS368_t presMeasureRate,
                                  precisionDPS368_t tempOversample,
                                  backgroundDPS368_t tempMeasureRate,
-                                 uint32_t enableFIFO);
+                                 uint32_t enableFIFO,
+                                 uint32_t interruptConfig);
 
 //Interaction Functions
 extern uint32_t setModeDPS368(sensorModeDPS368_t newMode);             //Set Mode Function, changes the operating mode of the sensor to the given mode
 extern resultStatusDPS368_t getResultStatusDPS368();                   //Get Result Status Function, provides the status of whether measurement results are ready or not
+extern uint32_t readInterruptStatusDPS368(uint8_t *status);            //Read Interrupt Status Function, obtains the INT_STS bits of the sensor, clearing them and releasing its interrupt pin
+extern uint32_t readProductIdDPS368(uint8_t *productId);               //Read Product ID Function, obtains the product and revision ID byte of the sensor
 extern uint32_t clearFifoDPS368();                                     //Clear FIFO Function, clears the contents of the FIFO buffer on the sensor
 extern uint32_t getPressureResultDPS368(uint32_t *rawPressure);        //Get Pressure Result Function, obtains the raw pressure measurement from the sensor
 extern uint32_t getTemperatureResultDPS368(uint32_t *rawTemperature);  //Get Temperature Result Function, obtains the raw temperature measurement from the sensor
 extern uint32_t getResultsFromFifoDPS368(uint32_t *rawResults,         //Get Results From FIFO Function, reads the specified number of results from the sensor's FIFO into the provided array
                                          uint32_t count);
+extern uint32_t drainFifoDPS368(uint32_t *rawResults,                  //Drain FIFO Function, reads results out of the sensor's FIFO until it runs empty or the array is full, returning how many were obtained
+                                uint32_t maxCount);
 
 //Data Conversion Functions
-extern float convertToTempCFromDPS368(uint32_t rawTemperature);     //Convert To Temperature Celsius From DPS368, returns the temperature in Celsius from the provided raw DPS368 sensor data
-extern float convertToPressureFromDPS368(uint32_t rawPressure,      //Convert To Pressure From DPS368, returns the pressure in Pascals from the provided raw DPS368 sensor data
+extern int32_t convertToCentiCFromDPS368(const calibrationDPS368_t *calibration,    //Convert To Centi-Celsius From DPS368, returns the temperature in hundredths of a degree Celsius from the provided raw DPS368 sensor data
+                                         uint32_t rawTemperature);
+extern int32_t convertToCentiPaFromDPS368(const calibrationDPS368_t *calibration,   //Convert To Centi-Pascals From DPS368, returns the pressure in hundredths of a Pascal from the provided raw DPS368 sensor data
+                                          uint32_t rawPressure,
+                                          uint32_t rawTemperature);
+#ifdef DPS368_FLOAT_REFERENCE
+extern float convertToTempCFromDPS368(const calibrationDPS368_t *calibration,      //Convert To Temperature Celsius From DPS368, returns the temperature in Celsius from the provided raw DPS368 sensor data
+                                      uint32_t rawTemperature);
+extern float convertToPressureFromDPS368(const calibrationDPS368_t *calibration,   //Convert To Pressure From DPS368, returns the pressure in Pascals from the provided raw DPS368 sensor data
+                                         uint32_t rawPressure,
                                          uint32_t rawTemperature);
+#endif
 
 //Utility Functions
-extern uint32_t readCalCoeffsDPS368();                        //Get Calibration Coefficients Function, reads the calibration coefficients from the sensor to use for processing the results
-extern uint32_t getResultsAtAddressDPS368(uint32_t address,   //Get Results At Address Function, obtains the requested number of 24-bit results from the sensor at the provided start address
+extern uint32_t readCalCoeffsDPS368(calibrationDPS368_t *calibration);  //Get Calibration Coefficients Function, reads the calibration coefficients from the sensor and prepares the calibration context from them
+extern void prepareTempTermsDPS368(calibrationDPS368_t *calibration);   //Prepare Temperature Terms Function, folds the temperature reciprocal into the c0 and c1 coefficients of the calibration context
+extern uint32_t getResultsAtAddressDPS368(uint32_t address,             //Get Results At Address Function, obtains the requested number of 24-bit results from the sensor at the provided start address
                                           uint32_t *results,
                                           uint32_t count);
-extern void forceSign16(int16_t *value, uint32_t bitDepth);   //Force Sign 16 Function, forces the given value into it's 16-bit signed equivalent using the provided bit-depth
-extern void forceSign32(int32_t *value, uint32_t bitDepth);   //Force Sign 32 Function, forces the given value into it's 32-bit signed equivalent using the provided bit-depth
-extern uint32_t isPressureDPS368(uint32_t *rawSensorValue);   //Is Pressure Function, gives boolean status as to whether a given value obtained from the sensors FIFO is a pressure measurement
+extern int32_t scaleRawDPS368(uint32_t rawValue,                        //Scale Raw Function, sign extends the provided 24-bit raw result and divides it by its scaling factor using the reciprocal, returning the result in Q24
+                              uint32_t reciprocal);
+extern int64_t mulQ24DPS368(int64_t value,                              //Multiply Q24 Function, multiplies a 64-bit value by a Q24 value returning the result shifted back down by 24 bits, using two 32x32 to 64-bit multiplies
+                            int32_t factorQ24);
+extern void forceSign16(int16_t *value, uint32_t bitDepth);             //Force Sign 16 Function, forces the given value into it's 16-bit signed equivalent using the provided bit-depth
+extern void forceSign32(int32_t *value, uint32_t bitDepth);             //Force Sign 32 Function, forces the given value into it's 32-bit signed equivalent using the provided bit-depth
+extern uint32_t isPressureDPS368(uint32_t *rawSensorValue);             //Is Pressure Function, gives boolean status as to whether a given value obtained from the sensors FIFO is a pressure measurement
 
 
 #endif
@@ -13,8 +13,34 @@
  ***************/
 
 
-//DMA Buffer
-volatile uint8_t dmaBufferTxUART[0x000000FF];  //Create a 256 byte array to use for storing the message to be transmitting out of UART
+//System Oscillator
+const operatingPointSysClk_t sysClkOperatingPoints[] = {{0x13010702, 0x00000002, 0x0000000C, 0x00000000, 1000000},    //1MHz, FRC / 8 with PBCLK at 1MHz
+                                                        {0x11010702, 0x00000003, 0x00000033, 0x00000000, 4000000},    //4MHz, FRC / 2 with PBCLK at 4MHz
+                                                        {0x13090102, 0x00000008, 0x00000067, 0x00000001, 16000000},   //16MHz, FRC / 2 x16 / 4 with PBCLK at 8MHz
+                                                        {0x0B0D0102, 0x00000017, 0x00000103, 0x00000004, 40000000}};  //40MHz, FRC / 2 x20 / 2 with PBCLK at 20MHz
+SysClkSpeed_t currentClockSpeed = SYSCLK_16MHZ;                                                                        //The configuration fuses start the system clock off at 16MHz
+
+//Peripheral Power
+const peripheralDescriptor_t peripheralDescriptors[] = {{&PMD5CLR, 0x00020000, {&I2C2CON}, 0x00000001, &I2C2BRG, __builtin_offsetof(operatingPointSysClk_t, brgI2C)},             //I2C2
+                                                        {&PMD5CLR, 0x00000100, {&SPI1CON2, &SPI1CON}, 0x00000002, &SPI1BRG, __builtin_offsetof(operatingPointSysClk_t, brgSPI)},  //SPI1
+                                                        {&PMD5CLR, 0x00000002, {&U2STA, &U2MODE}, 0x00000002, &U2BRG, __builtin_offsetof(operatingPointSysClk_t, brgUART)},       //UART2
+                                                        {NULL, 0x00000000, {&DMACON}, 0x00000001, NULL, 0x00000000}};                                                             //DMA
+uint32_t peripheralUsers[PERIPHERAL_COUNT];                            //Number of users currently holding each managed module, the module is switched off while this is 0
+uint32_t peripheralImages[PERIPHERAL_COUNT][PERIPHERAL_IMAGE_LENGTH];  //Configuration of each managed module, saved as it was switched off
+
+//I2C Transaction Engine
+transactionI2C_t *queueI2C[I2C_QUEUE_LENGTH];                 //Ring buffer of transactions waiting to be processed by the I2C2 peripheral, the head entry is the active transaction
+volatile uint32_t queueHeadI2C = 0x00000000;                  //Index of the transaction currently at the front of the queue
+volatile uint32_t queueCountI2C = 0x00000000;                 //Number of transactions currently held within the queue, including the active one
+volatile engineStateI2C_t engineStateI2C = I2C_STATE_IDLE;    //Tracks which bus event the transaction engine is expecting to complete next
+volatile uint32_t byteIndexI2C;                               //Index of the next byte to be written or read within the active transaction
+
+//SPI Block Transfers
+volatile uint32_t transferActiveSPI = 0x00000000;  //Non-zero while a DMA driven SPI1 block transfer is in progress
+void (*onCompleteSPI)();                          //Callback to invoke from the interrupt that finishes the active SPI1 block transfer
+
+//UART Transmissions
+volatile uint32_t transferActiveUART = 0x00000000;  //Non-zero from the first startTxUART() until completeTxUART(), spanning every block chained in between and the drain of the last one
 
 
 
@@ -40,39 +66,175 @@ void allowSleepMode(uint32_t enabled)
     asm volatile ("ei");  //Enable interrupts now that everything is ready to go
 }
 
-//Change Clock Speed Function, changes the system clock speed and reconfigures peripherals so that they are unaffected
+//Change Clock Speed Function, changes the system clock speed once the buses are quiet and reconfigures peripherals so that they are unaffected
 void changeClockSpeed(SysClkSpeed_t newClockSpeed)
 {
-    DMACON = 0x00009000;  //Put the DMA peripheral into suspend mode to prevent weird behaviour while switching clocks
-    asm volatile ("di");  //Disable interrupts before doing anything else
+    const operatingPointSysClk_t *newPoint = &sysClkOperatingPoints[newClockSpeed];  //Operating point that the system clock is moving to
+    uint32_t interruptState;                                                          //Create a variable to use for preserving the state of the interrupts
+
+    if ((newClockSpeed == currentClockSpeed) || (newClockSpeed >= SYSCLK_SPEED_COUNT)) return;  //Nothing to do when already running at the requested operating point
+
+    //Let anything already on the buses finish at the bit rate it started at, the baud rate generators can't be changed underneath a transfer
+    waitWhileBusy(&queueCountI2C);      //Idle the CPU until every queued I2C2 transaction has completed
+    waitWhileBusy(&transferActiveSPI);  //Idle the CPU until any DMA driven SPI1 block transfer has completed
+
+    DMACONSET = 0x00001000;                                   //Suspend the DMA so that no more bytes are handed to UART2 while switching clocks
+    while (DMACON & 0x00000800);                              //Wait for any cell transfer that is already under way to finish
+    if (U2MODE & 0x00008000) while (!(U2STA & 0x00000100));  //Wait for the bytes already in the UART2 transmit buffer to go out at the old clock speed
+
+    asm volatile ("di %0" : "=r" (interruptState));  //Disable interrupts before touching the oscillator, saving the previous interrupt state
 
     SYSKEY = 0x00000000;  //Reset the register lock state machine by writing a 0 to it
     SYSKEY = 0xAA996655;  //Write the first unlock key to the SYSKEY register
     SYSKEY = 0x556699AA;  //Write the second unlock key to the register to finally unlock all protected registers
 
-    //Configure the oscillator to move to the desired clock frequency
-    OSCCON = (uint32_t) newClockSpeed;  //Write the appropriate words to OSCCON to select the new desired clock configuration
-    OSCCONSET = 0x00000001;             //Start the switch-over process by setting the OSWEN bit
-    while (OSCCON & 0x00000001);        //Wait until the system is operating on the new clock settings
-//    while (!(OSCCON & 0x00000020));
+    //Step off of the PLL onto the divided down FRC first when moving between the two PLL operating points, PLLMULT is locked while the PLL is in use
+    if (((sysClkOperatingPoints[currentClockSpeed].oscconValue & 0x00000700) == SYSCLK_OSCCON_NOSC_PLL) && ((newPoint->oscconValue & 0x00000700) == SYSCLK_OSCCON_NOSC_PLL))
+    {
+        switchOscillator(sysClkOperatingPoints[SYSCLK_4MHZ].oscconValue);
+    }
+
+    switchOscillator(newPoint->oscconValue);  //Move the system clock over to the new operating point
 
     SYSKEY = 0x00000000;  //Lock the protected registers now that the switch has completed
 
     //Reconfigure peripherals as required to maintain proper operation
-    switch (newClockSpeed)
+    I2C2BRG = newPoint->brgI2C;         //Keep the bus speed of I2C2 where it was
+    U2BRG = newPoint->brgUART;          //Keep the baud rate of UART2 at 19200bps
+    SPI1BRG = newPoint->brgSPI;         //Keep the clock frequency of SPI1 where it was
+    currentClockSpeed = newClockSpeed;  //Take note of the operating point now in use
+
+    if (interruptState & 0x00000001) asm volatile ("ei");  //Restore the interrupts if they were enabled before entering the function
+    DMACONCLR = 0x00001000;                                //Put the DMA back into normal operation
+}
+
+//Switch Oscillator Function, moves the system clock over to the provided OSCCON word, called with interrupts disabled and the registers unlocked
+void switchOscillator(uint32_t oscconValue)
+{
+    while (!(OSCCON & 0x00200000));                 //Wait until the peripheral bus clock divider is ready to accept a new value
+    OSCCON = oscconValue | (OSCCON & 0x00000010);  //Write the new word to OSCCON, keeping whichever low-power mode WAIT was set to enter
+    OSCCONSET = 0x00000001;                         //Start the switch-over process by setting the OSWEN bit
+    while (OSCCON & 0x00000001);                    //Wait until the system is operating on the new clock settings
+
+    if ((oscconValue & 0x00000700) == SYSCLK_OSCCON_NOSC_PLL) while (!(OSCCON & 0x00000020));  //Wait until the PLL reports that it has locked when running from it
+}
+
+//Wait While Busy Function, keeps the CPU in its low-power WAIT state until the provided flag is cleared by an interrupt
+void waitWhileBusy(volatile uint32_t *busyFlag)
+{
+    asm volatile ("di");  //Disable interrupts so that the flag can't be cleared between checking it and executing WAIT
+
+    //Keep going back to sleep until the interrupt responsible for the flag clears it
+    while (*busyFlag)
     {
-        case SYSCLK_1MHZ:
-            I2C2BRG = 0x00000004;
-            U2BRG = 0x0000000C;
-            break;
-        case SYSCLK_16MHZ:
-            I2C2BRG = 0x00000008;  //Set the bus speed of I2C2 to ~429kHz
-            U2BRG = 0x00000019;    //Set the baud rate of UART2 to operate at roughly 19200bps
-            break;
+        asm volatile ("wait");  //Halt the CPU, a pending interrupt still wakes it even though interrupts are disabled
+        asm volatile ("ei");    //Briefly enable interrupts to let the pending interrupt get serviced
+        asm volatile ("ehb");   //Clear the execution hazard so the interrupt is taken before disabling interrupts again
+        asm volatile ("di");    //Disable interrupts again before re-checking the flag
     }
 
-    asm volatile ("ei");  //Enable interrupts now that everything is ready to go
-    DMACON = 0x00008000;  //Put the DMA back into normal operation
+    asm volatile ("ei");  //Enable interrupts now that the flag has been cleared
+}
+
+
+
+/**********************
+ *  Peripheral Power  *
+ **********************/
+
+
+//Initialize Peripheral Power Function, switches off every unused module for good and every managed module until it gains a user, called once every module has been configured
+void initializePeripheralPower()
+{
+#ifdef HAL_KEEP_PERIPHERALS_ON
+    for (uint32_t module = 0x00000000; module < PERIPHERAL_COUNT; module++) peripheralUsers[module] = 0x00000001;  //Hold a user on every managed module for good so that none of them is ever switched off
+#else
+    //Switch off every module that the application has no use for
+    writePMD(&PMD1CLR, PMD_UNUSED_MODULES_1, 0xFFFFFFFF);
+    writePMD(&PMD2CLR, PMD_UNUSED_MODULES_2, 0xFFFFFFFF);
+    writePMD(&PMD3CLR, PMD_UNUSED_MODULES_3, 0xFFFFFFFF);
+    writePMD(&PMD4CLR, PMD_UNUSED_MODULES_4, 0xFFFFFFFF);
+    writePMD(&PMD5CLR, PMD_UNUSED_MODULES_5, 0xFFFFFFFF);
+    writePMD(&PMD6CLR, PMD_UNUSED_MODULES_6, 0xFFFFFFFF);
+
+    //Switch off the managed modules until something needs them, keeping hold of the configuration they were just given
+    for (uint32_t module = 0x00000000; module < PERIPHERAL_COUNT; module++)
+    {
+        peripheralUsers[module] = 0x00000000;  //Nothing is using the module yet
+        gatePeripheral(module);                //Save its configuration and switch it off
+    }
+#endif
+}
+
+//Acquire Peripheral Function, adds a user onto the given module, powering it up and restoring its configuration when it was off, safe to call from within interrupts
+void acquirePeripheral(peripheralModule_t module)
+{
+    uint32_t interruptState;  //Create a variable to use for preserving the state of the interrupts, allowing this function to be called from within interrupts
+
+    asm volatile ("di %0" : "=r" (interruptState));           //Disable interrupts while modifying the user count, saving the previous interrupt state
+    if (!peripheralUsers[module]++) restorePeripheral(module);  //Power the module up when this is its first user
+    if (interruptState & 0x00000001) asm volatile ("ei");     //Restore the interrupts if they were enabled before entering the function
+}
+
+//Release Peripheral Function, drops a user from the given module, saving its configuration and switching it off after the last one, safe to call from within interrupts
+void releasePeripheral(peripheralModule_t module)
+{
+    uint32_t interruptState;  //Create a variable to use for preserving the state of the interrupts, allowing this function to be called from within interrupts
+
+    asm volatile ("di %0" : "=r" (interruptState));                                //Disable interrupts while modifying the user count, saving the previous interrupt state
+    if (peripheralUsers[module] && !--peripheralUsers[module]) gatePeripheral(module);  //Switch the module off once its last user lets go, never letting the count wrap around
+    if (interruptState & 0x00000001) asm volatile ("ei");                          //Restore the interrupts if they were enabled before entering the function
+}
+
+//Gate Peripheral Function, saves the configuration of the given module into its image and switches it off, called with interrupts disabled
+void gatePeripheral(peripheralModule_t module)
+{
+    const peripheralDescriptor_t *descriptor = &peripheralDescriptors[module];  //Where the registers of the module are
+
+    for (uint32_t index = 0x00000000; index < descriptor->imageLength; index++) peripheralImages[module][index] = *descriptor->imageRegisters[index];  //Save the configuration of the module
+
+    //Switch the module off through its PMD bit, which also resets its registers, or through its ON bit when it has no PMD bit
+    if (descriptor->pmdClear) writePMD(descriptor->pmdClear, descriptor->pmdMask, 0xFFFFFFFF);
+    else *(descriptor->imageRegisters[descriptor->imageLength - 0x00000001] + 0x00000001) = 0x00008000;  //Step from the register on to its CLR register to clear the ON bit
+}
+
+//Restore Peripheral Function, switches the given module back on and restores its configuration from its image, called with interrupts disabled
+void restorePeripheral(peripheralModule_t module)
+{
+    const peripheralDescriptor_t *descriptor = &peripheralDescriptors[module];  //Where the registers of the module are
+    uint32_t lastIndex = descriptor->imageLength - 0x00000001;                  //Index of the register holding the ON bit of the module
+
+    if (descriptor->pmdClear) writePMD(descriptor->pmdClear, descriptor->pmdMask, 0x00000000);  //Power the module back up, it comes back with all of its registers reset
+
+    //Reload the baud rate generator for the clock speed running right now, the one saved may have been for a different operating point
+    if (descriptor->brgRegister) *descriptor->brgRegister = *(const uint32_t *) ((const uint8_t *) &sysClkOperatingPoints[currentClockSpeed] + descriptor->brgOffset);
+
+    //Write the configuration back, holding the ON bit until last so that the module only starts once it has been set up
+    for (uint32_t index = 0x00000000; index < lastIndex; index++) *descriptor->imageRegisters[index] = peripheralImages[module][index];
+    *descriptor->imageRegisters[lastIndex] = peripheralImages[module][lastIndex] & ~0x00008000;
+    *descriptor->imageRegisters[lastIndex] = peripheralImages[module][lastIndex];
+}
+
+//Write PMD Function, sets or clears the given bits of a PMD register, unlocking them for the write
+void writePMD(volatile uint32_t *pmdClear, uint32_t mask, uint32_t disable)
+{
+    uint32_t interruptState;  //Create a variable to use for preserving the state of the interrupts
+
+    if (disable) pmdClear += 0x00000001;  //Add an offset of 1 register to pmdClear such that it points at the SET register when the modules are to be switched off
+
+    asm volatile ("di %0" : "=r" (interruptState));  //Disable interrupts so that nothing gets in between the unlock sequence, saving the previous interrupt state
+
+    SYSKEY = 0x00000000;     //Reset the register lock state machine by writing a 0 to it
+    SYSKEY = 0xAA996655;     //Write the first unlock key to the SYSKEY register
+    SYSKEY = 0x556699AA;     //Write the second unlock key to the register to finally unlock all protected registers
+    CFGCONCLR = 0x00001000;  //Clear PMDLOCK so that the PMD registers accept writes
+
+    *pmdClear = mask;  //Write the bits to the SET or CLR register of the PMD register to switch the modules off or on
+
+    CFGCONSET = 0x00001000;  //Set PMDLOCK again now that the write is done
+    SYSKEY = 0x00000000;     //Lock the protected registers now that the PMD register has been written
+
+    if (interruptState & 0x00000001) asm volatile ("ei");  //Restore the interrupts if they were enabled before entering the function
 }
 
 
@@ -82,74 +244,254 @@ void changeClockSpeed(SysClkSpeed_t newClockSpeed)
  *********/
 
 
-//Write To I2C Function, sends the provided array of bytes to the provided slave address using the I2C2 peripheral
-uint32_t writeToI2C(uint32_t address, const uint8_t *bytes, uint32_t length)
+//Queue Transaction I2C Function, adds the provided transaction to the I2C2 queue, starting the bus right away when it is idle
+uint32_t queueTransactionI2C(transactionI2C_t *transaction)
 {
-    //Start condition generation
-    I2C2CONSET = 0x00000001;       //Generate a start condition on the I2C bus, this signals that new data is about to be sent to all slaves on the line
-    while (I2C2CON & 0x00000001);  //Wait until the start condition is done sending to conform to I2C timing specifications
+    uint32_t interruptState;  //Create a variable to use for preserving the state of the interrupts, allowing this function to be called from within a callback
 
-    //Sending address and write flag
-    I2C2TRN = (address << 0x00000001);             //Shift the value of the address over to the left by 1 bit, then write it to the transmit register
-    while (I2C2STAT & 0x00004000);                 //Wait until the address and write flag have finished being sent, and the ACK flag has been read by the master.
-    if (I2C2STAT & 0x00008000) return 0x00000000;  //Leave the function early in cases where no acknowledge is returned by the slave device
+    transaction->inProgress = 0xFFFFFFFF;  //Flag the transaction as in progress before it can be picked up by the interrupt
+    transaction->succeeded = 0x00000000;   //Assume failure until the engine reports otherwise
 
-    //Transmit each byte to the I2C bus
-    while (length--)
+    asm volatile ("di %0" : "=r" (interruptState));  //Disable interrupts while modifying the queue, saving the previous interrupt state
+
+    //Refuse the transaction whenever the queue has no room left for it
+    if (queueCountI2C == I2C_QUEUE_LENGTH)
+    {
+        if (interruptState & 0x00000001) asm volatile ("ei");  //Restore the interrupts if they were enabled before entering the function
+        transaction->inProgress = 0x00000000;                  //The transaction will never be processed, so clear the in progress flag
+
+        return 0x00000000;  //Return zero to indicate that the transaction was not queued
+    }
+
+    queueI2C[(queueHeadI2C + queueCountI2C++) & (I2C_QUEUE_LENGTH - 0x00000001)] = transaction;  //Place the transaction at the back of the queue
+
+    //Kick off the bus when no other transaction is currently being processed
+    if (engineStateI2C == I2C_STATE_IDLE)
     {
-        I2C2TRN = *bytes++;                            //Send the next byte in the array out to the I2C bus
-        while (I2C2STAT & 0x00004000);                 //Wait until the byte has finished transmitting before checking for acknowledgement
-        if (I2C2STAT & 0x00008000) return 0x00000000;  //Leave the function early, the acknowledge bit was not received from the slave device
+        acquirePeripheral(PERIPHERAL_I2C2);    //Power I2C2 up for as long as the queue holds transactions
+        byteIndexI2C = 0x00000000;             //Start at the first byte of the transaction
+        engineStateI2C = I2C_STATE_START;      //The next interrupt will signal the end of the start condition
+        PROFILE_ENTER(PROBE_I2C_TRANSACTION);  //Start timing the transaction from its start condition
+        I2C2CONSET = 0x00000001;               //Generate a start condition on the I2C bus, the I2C2 master interrupt takes it from here
     }
 
-    //Stop condition generation
-    I2C2CONSET = 0x00000004;       //Generate a stop condition on the I2C bus, this signals the end of the transmission to the slave device
-    while (I2C2CON & 0x00000004);  //Wait until the stop condition is done sending
+    if (interruptState & 0x00000001) asm volatile ("ei");  //Restore the interrupts if they were enabled before entering the function
 
-    return 0xFFFFFFFF;  //Return a non-zero value to indicate a successful transmission
+    return 0xFFFFFFFF;  //Return a non-zero value to indicate that the transaction was queued
 }
 
-//Read from I2C Function, reads the desired number of bytes from the slave device at the provided address using the I2C2 peripheral
-uint32_t readFromI2C(uint32_t address, uint8_t *bytes, uint32_t readLength, uint32_t addressLength)
+//Service Transaction I2C Function, advances the I2C2 transaction engine by one step, called from the I2C2 master interrupt
+void serviceTransactionI2C()
 {
-    //Determine whether or not an address shall be requested first prior to reading
-    if (addressLength)
+    transactionI2C_t *transaction = queueI2C[queueHeadI2C];  //Grab the transaction at the front of the queue, this is the one on the bus
+
+    switch (engineStateI2C)
     {
-        if (!writeToI2C(address, bytes, addressLength)) return 0x00000000;  //Inform the device of the desired register address to read from using the address passed through *bytes
+        //Start condition has finished, send the address along with the appropriate direction flag
+        case I2C_STATE_START:
+            if (transaction->writeLength || !transaction->readLength)
+            {
+                I2C2TRN = transaction->address << 0x00000001;  //Shift the address over to the left by 1 bit, leaving the write flag cleared
+                engineStateI2C = I2C_STATE_WRITE;             //Acknowledgement of the address is handled the same as any written byte
+            }
+            else
+            {
+                I2C2TRN = (transaction->address << 0x00000001) | 0x00000001;  //Shift the address over to the left by 1 bit, setting Bit-0 to indicate a read request
+                engineStateI2C = I2C_STATE_READ_ADDRESS;                     //The next interrupt signals that the read request has been acknowledged or not
+            }
+            return;
+
+        //Previous byte was written to the bus, check the acknowledgement and then send the next byte
+        case I2C_STATE_WRITE:
+            if (I2C2STAT & 0x00008000) break;  //Give up on the transaction when the slave device doesn't acknowledge the byte
+
+            //Keep writing until every byte has been sent
+            if (byteIndexI2C < transaction->writeLength)
+            {
+                I2C2TRN = transaction->writeBytes[byteIndexI2C++];  //Send the next byte in the array out to the I2C bus
+                return;
+            }
+
+            //Turn the bus around with a repeated start when there is data to be read back from the slave
+            if (transaction->readLength)
+            {
+                I2C2CONSET = 0x00000002;              //Generate a repeated start condition by setting the RSEN bit
+                engineStateI2C = I2C_STATE_RESTART;  //The next interrupt will signal the end of the repeated start condition
+                return;
+            }
+
+            transaction->succeeded = 0xFFFFFFFF;  //Every byte was acknowledged, so the transaction was a success
+            break;
+
+        //Repeated start condition has finished, send the address with the read flag set
+        case I2C_STATE_RESTART:
+            I2C2TRN = (transaction->address << 0x00000001) | 0x00000001;  //Shift the address over to the left by 1 bit, setting Bit-0 to indicate a read request
+            engineStateI2C = I2C_STATE_READ_ADDRESS;                     //The next interrupt signals that the read request has been acknowledged or not
+            return;
+
+        //Read request was sent, start receiving when the slave device acknowledged it
+        case I2C_STATE_READ_ADDRESS:
+            if (I2C2STAT & 0x00008000) break;  //Give up on the transaction when the slave device doesn't acknowledge the read request
+
+            byteIndexI2C = 0x00000000;           //Start storing bytes at the beginning of the read buffer
+            I2C2CONSET = 0x00000008;             //Start the receive process by setting the RCEN bit
+            engineStateI2C = I2C_STATE_RECEIVE;  //The next interrupt signals that a byte has been received
+            return;
+
+        //A byte was received from the slave, store it and respond with either an ACK or a NACK
+        case I2C_STATE_RECEIVE:
+            transaction->readBytes[byteIndexI2C++] = I2C2RCV;  //Write the byte received from the slave device into the next available byte of the read buffer
+
+            //Send a NACK after the final byte to let the slave know that we're done, otherwise send an ACK
+            if (byteIndexI2C == transaction->readLength)
+            {
+                I2C2CONSET = 0x00000020;  //Set the ACKDT bit so that a NACK is sent
+            }
+            else
+            {
+                I2C2CONCLR = 0x00000020;  //Clear the ACKDT bit so that an ACK is sent
+            }
+
+            I2C2CONSET = 0x00000010;                 //Send the acknowledge sequence by setting the ACKEN bit
+            engineStateI2C = I2C_STATE_ACKNOWLEDGE;  //The next interrupt signals that the acknowledge sequence has finished
+            return;
+
+        //Acknowledge sequence has finished, either receive the next byte or wrap things up
+        case I2C_STATE_ACKNOWLEDGE:
+            if (byteIndexI2C < transaction->readLength)
+            {
+                I2C2CONSET = 0x00000008;             //Start receiving the next byte by setting the RCEN bit
+                engineStateI2C = I2C_STATE_RECEIVE;  //The next interrupt signals that a byte has been received
+                return;
+            }
+
+            I2C2CONCLR = 0x00000020;              //Clear the ACKDT bit of the I2C control register now that sending NACK responses is no longer required
+            transaction->succeeded = 0xFFFFFFFF;  //Every requested byte has been received, so the transaction was a success
+            break;
+
+        //Stop condition has finished, retire the transaction and move on to the next one
+        case I2C_STATE_STOP:
+            PROFILE_EXIT(PROBE_I2C_TRANSACTION);                                           //Stop timing the transaction now that its stop condition has finished
+            queueHeadI2C = (queueHeadI2C + 0x00000001) & (I2C_QUEUE_LENGTH - 0x00000001);  //Pop the finished transaction off the front of the queue
+            queueCountI2C--;                                                               //One less transaction is waiting in the queue
+
+            transaction->inProgress = 0x00000000;                               //Let anyone waiting on the transaction know that it has finished
+            if (transaction->onComplete) transaction->onComplete(transaction);  //Invoke the completion callback when one was provided
+
+            //Start the next transaction in the queue right away, or let the engine go idle when the queue is empty
+            if (queueCountI2C)
+            {
+                byteIndexI2C = 0x00000000;             //Start at the first byte of the next transaction
+                engineStateI2C = I2C_STATE_START;      //The next interrupt will signal the end of the start condition
+                PROFILE_ENTER(PROBE_I2C_TRANSACTION);  //Start timing the next transaction from its start condition
+                I2C2CONSET = 0x00000001;               //Generate a start condition on the I2C bus for the next transaction
+            }
+            else
+            {
+                engineStateI2C = I2C_STATE_IDLE;      //Nothing left to do, the bus is now idle
+                releasePeripheral(PERIPHERAL_I2C2);  //Switch I2C2 off until the next transaction is queued
+            }
+            return;
+
+        default:
+            return;
     }
 
-    //Start condition generation
-    I2C2CONSET = 0x00000001;       //Generate a start condition on the I2C bus, this signals that new data is about to be sent to all slaves on the line
-    while (I2C2CON & 0x00000001);  //Wait until the start condition is done sending to conform to I2C timing specifications
+    //Generate the stop condition, reached on both the success and failure paths of the transaction
+    I2C2CONSET = 0x00000004;          //Generate a stop condition on the I2C bus, this signals the end of the transmission to the slave device
+    engineStateI2C = I2C_STATE_STOP;  //The next interrupt will signal the end of the stop condition
+}
 
-    //Sending address and read request flag
-    I2C2TRN = (address << 0x00000001) | 0x00000001;  //Shift the address byte to the left by 1 bit, forcing setting Bit-0 to indicate a read request, finally writing it all to the transmit register
-    while (I2C2STAT & 0x00004000);                   //Wait until the address and read request flag have finished being sent, and the ACK flag has been read by the master
-    if (I2C2STAT & 0x00008000) return 0x00000000;    //Leave the function early in cases where no acknowledge is returned by the slave device
+//Abort Transaction I2C Function, fails the active I2C2 transaction after a bus collision and moves on to the next one
+void abortTransactionI2C()
+{
+    I2C2CONCLR = 0x0000003F;   //Cancel any start, stop, receive or acknowledge sequence that was still pending
+    I2C2STATCLR = 0x00000400;  //Clear the bus collision flag so that the peripheral accepts new requests
 
-    uint8_t *ptrStop = bytes + readLength;  //Calculate the address of the bytes pointer to stop the read process at
+    if (engineStateI2C == I2C_STATE_IDLE) return;  //Nothing to clean up when no transaction was being processed
 
-    //Read the next byte from the slave and store it in the provided buffer
-    while (bytes != ptrStop)
-    {
-        I2C2CONSET = 0x00000008;       //Start the receive process by setting the RCEN bit
-        while (I2C2CON & 0x00000008);  //Wait until the receive process has completed
+    queueI2C[queueHeadI2C]->succeeded = 0x00000000;  //The transaction lost the bus, so mark it as failed
+    engineStateI2C = I2C_STATE_STOP;                 //Pretend the stop condition has just finished to reuse the retirement logic
+    serviceTransactionI2C();                         //Retire the failed transaction and start the next one in the queue
+}
+
+//Write To I2C Function, sends the provided array of bytes to the provided slave address using the I2C2 peripheral
+uint32_t writeToI2C(uint32_t address, const uint8_t *bytes, uint32_t length)
+{
+    transactionI2C_t transaction = {address, bytes, length, 0x00000000, 0x00000000, 0x00000000};  //Describe the write operation as a transaction with no read phase
+
+    if (!queueTransactionI2C(&transaction)) return 0x00000000;  //Leave the function early when the queue has no room for the transaction
+    waitWhileBusy(&transaction.inProgress);                     //Idle the CPU while the I2C2 interrupt drives the bus
+
+    return transaction.succeeded;  //Return a non-zero value to indicate a successful transmission
+}
+
+//Read from I2C Function, reads the desired number of bytes from the slave device at the provided address using the I2C2 peripheral
+uint32_t readFromI2C(uint32_t address, uint8_t *bytes, uint32_t readLength, uint32_t addressLength)
+{
+    transactionI2C_t transaction = {address, bytes, addressLength, bytes, readLength, 0x00000000};  //Describe the read operation as a transaction, writing the register address in *bytes first when one is given
+
+    if (!queueTransactionI2C(&transaction)) return 0x00000000;  //Leave the function early when the queue has no room for the transaction
+    waitWhileBusy(&transaction.inProgress);                     //Idle the CPU while the I2C2 interrupt drives the bus
+
+    return transaction.succeeded;  //Return a non-zero value to indicate a successful reception
+}
+
+
+
+/*********
+ *  SPI  *
+ *********/
 
-        *bytes++ = I2C2RCV;  //Write the byte received from the slave device into the next available byte of the provided buffer array
 
-        if (bytes == ptrStop) I2C2CONSET = 0x00000020;  //Configure the I2C peripheral to send an NACK response next if we've just received the last byte
+//Start Block Transfer SPI Function, streams the provided bytes through SPI1 using DMA 1 for TX and DMA 0 for RX, rxBytes may be NULL for write-only transfers
+void startBlockTransferSPI(const uint8_t *txBytes, uint8_t *rxBytes, uint32_t length, void (*onComplete)())
+{
+    transferActiveSPI = 0xFFFFFFFF;     //Flag the transfer as active before any of the DMA interrupts have a chance to fire
+    onCompleteSPI = onComplete;         //Remember the callback to invoke once the transfer has completed
+    acquirePeripheral(PERIPHERAL_DMA);  //Power the DMA up until the transfer completes, SPI1 is already held by whoever is driving the transfer
 
-        I2C2CONSET = 0x00000010;       //Send an ACK response to the slave device on the I2C bus to confirm that the byte was received
-        while (I2C2CON & 0x00000010);  //Wait until the ACK condition is done sending
+    //Arm the RX channel first so that no received byte is missed, its block complete interrupt finishes the transfer
+    if (rxBytes)
+    {
+        DCH0SSA = KVA_TO_PA(&SPI1BUF);  //Assign the source address of DMA0 to the receive buffer of SPI1
+        DCH0DSA = KVA_TO_PA(rxBytes);   //Assign the destination address of DMA0 to the physical address of the provided buffer
+        DCH0SSIZ = 0x00000001;          //Source pointer has a size of 1 byte
+        DCH0DSIZ = length;              //Set the length of the destination location to the number of bytes being transferred
+        DCH0CSIZ = 0x00000001;          //Use a cell size of 1, ensuring only 1 byte is transfered at a time
+        DCH0INT = 0x00080000;           //Clear the interrupt flags of DMA 0 and enable block transfer complete interrupts
+        DCH0CON = 0x00000083;           //Enable channel 0 of the DMA peripheral with the highest DMA priority
     }
 
-    I2C2CONCLR = 0x00000020;  //Clear the ACKDT bit of the I2C control register now that sending NACK responses is no longer required
+    //Arm the TX channel, it only needs to interrupt on completion when no RX channel is tracking the transfer
+    DCH1SSA = KVA_TO_PA(txBytes);                   //Assign the source address of DMA1 to the physical address of the provided buffer
+    DCH1DSA = KVA_TO_PA(&SPI1BUF);                  //Assign the destination address of DMA1 to the transmit buffer of SPI1
+    DCH1SSIZ = length;                              //Set the length of the source location to the number of bytes being transferred
+    DCH1DSIZ = 0x00000001;                          //Destination pointer has a size of 1 byte
+    DCH1CSIZ = 0x00000001;                          //Use a cell size of 1, ensuring only 1 byte is transfered at a time
+    DCH1INT = (rxBytes) ? 0x00000000 : 0x00080000;  //Clear the interrupt flags of DMA 1, enabling block transfer complete interrupts for write-only transfers
+    DCH1CON = 0x00000082;                           //Enable channel 1 of the DMA peripheral, the SPI1 TX interrupt starts pushing bytes right away
+}
+
+//Drain Transfer SPI Function, waits for the last bytes of a write-only transfer to leave the SPI1 shift register, called when DMA 1 completes
+void drainTransferSPI()
+{
+    SPI1CONCLR = 0x0000000C;  //Switch the SPI1 TX interrupt over to firing once the last byte has been shifted out
+    IFS1CLR = 0x00000040;     //Clear the SPI1 TX interrupt flag, it gets set again once the shift register is empty
+    IEC1SET = 0x00000040;     //Enable the SPI1 TX interrupt so that the CPU is notified when the transfer is truly complete
+}
+
+//Complete Transfer SPI Function, finishes off the active SPI1 block transfer, called once the final byte has been clocked out
+void completeTransferSPI()
+{
+    SPI1CONSET = 0x0000000C;  //Return the SPI1 TX interrupt to firing whenever the transmit buffer has room, as required by DMA 1
 
-    //Stop condition generation
-    I2C2CONSET = 0x00000004;       //Generate a stop condition on the I2C bus, this signals the end of transmission to the slave device
-    while (I2C2CON & 0x00000004);  //Wait until the stop condition is done sending
+    while (!(SPI1STAT & 0x00000020)) SPI1BUF;  //Empty any bytes that a write-only transfer left behind in the receive buffer
+    SPI1STATCLR = 0x00000040;                  //Clear the Read Buffer Overflow flag that write-only transfers are allowed to trigger
 
-    return 0xFFFFFFFF;  //Return a non-zero value to indicate a successful reception
+    releasePeripheral(PERIPHERAL_DMA);   //The DMA is no longer needed for the transfer
+    transferActiveSPI = 0x00000000;      //Let anyone waiting on the transfer know that it has finished
+    if (onCompleteSPI) onCompleteSPI();  //Invoke the completion callback when one was provided
 }
 
 
@@ -162,24 +504,135 @@ uint32_t readFromI2C(uint32_t address, uint8_t *bytes, uint32_t readLength, uint
 //Write to UART Function, sends the provided array of bytes out the serial port through UART2
 void writeToUART(const uint8_t *bytes, uint32_t length)
 {
+    acquirePeripheral(PERIPHERAL_UART2);  //Power UART2 up for the duration of the transmission
+
     while (length--)
     {
         while (U2STA & 0x00000200);  //Wait until there is room in the UART2 transmit FIFO buffer before writing the next byte
         U2TXREG = *bytes++;          //Put the next byte in the array into the transmit buffer of UART2
     }
 
-    while (!(U2STA & 0x00000100));  //Wait until the transmission has completed fully before leaving
+    while (!(U2STA & 0x00000100));        //Wait until the transmission has completed fully before leaving
+    releasePeripheral(PERIPHERAL_UART2);  //Switch UART2 back off now that everything has gone out
 }
 
-//Start Transmission UART Function, begins sending the provided string over UART
+//Start Transmission UART Function, begins sending the provided string over UART, chaining it straight onto the end of a transmission that is still going
 void startTxUART(const uint8_t *bytes, const uint32_t *length)
 {
+    if (!transferActiveUART)
+    {
+        acquirePeripheral(PERIPHERAL_UART2);  //Power UART2 up until completeTxUART() is called for the transmission
+        acquirePeripheral(PERIPHERAL_DMA);    //Power the DMA up along with it, DMA 2 feeds the bytes to UART2
+        transferActiveUART = 0x00000001;      //Blocks chained on from the DMA 2 and UART2 interrupts reuse the same users
+    }
+
+    U2STACLR = 0x00004000;       //Return the UART2 TX interrupt to asserting on an empty transmit buffer as DMA 2 needs, in case drainTxUART() left it waiting on the shift register
+    U2STASET = 0x00008000;       //UTXISEL of 10, as set up by Main.c
     DCH2SSA = KVA_TO_PA(bytes);  //Assign the source address of DMA2 to the physical address of the provided buffer
     DCH2SSIZ = *length;          //Set the length of the source location to the provided length value
     DCH2CON = 0x00000080;        //Enable channel 2 of the DMA peripheral
-    DCH2ECON = 0x000037B0;       //Start the transfer process by forcing the first cell transfer on DMA2
+    DCH2ECONSET = 0x00000080;    //Start the transfer process by forcing the first cell transfer on DMA2, keeping the start event and pattern match set up by Main.c
+}
+
+//Drain Transmission UART Function, waits for the last bytes of the DMA driven UART2 transmission to leave the shift register, called once DMA 2 has completed the last block queued for it
+void drainTxUART()
+{
+    U2STACLR = 0x00008000;                           //Switch the UART2 TX interrupt over to asserting once every byte has been shifted out
+    U2STASET = 0x00004000;                           //UTXISEL of 01
+    IFS1CLR = 0x00800000;                            //Clear the UART2 TX interrupt flag, it gets set again once the shift register is empty
+    if (U2STA & 0x00000100) IFS1SET = 0x00800000;  //Raise the flag straight away when the last byte has already gone out
+    IEC1SET = 0x00800000;                            //Enable the UART2 TX interrupt so that the CPU is notified when the transmission is truly complete
+}
+
+//Complete Transmission UART Function, finishes off the DMA driven UART2 transmission, called from the UART2 TX interrupt once its last byte has left the shift register
+void completeTxUART()
+{
+    U2STACLR = 0x00004000;                //Return the UART2 TX interrupt to asserting on an empty transmit buffer, as required by DMA 2
+    U2STASET = 0x00008000;                //UTXISEL of 10, as set up by Main.c
+    releasePeripheral(PERIPHERAL_DMA);    //The DMA is no longer needed for the transmission
+    releasePeripheral(PERIPHERAL_UART2);  //Switch UART2 back off now that everything has gone out
+    transferActiveUART = 0x00000000;      //The next startTxUART() has to power everything back up
+}
+
+//Detect Console UART Function, returns whether a console is attached to UART2, sensed through U2RX being held at its idle high level against the pull-down on RB5
+uint32_t detectConsoleUART()
+{
+    return (PORTB & 0x00000020) ? 0xFFFFFFFF : 0x00000000;  //RB5 only reads high while something is driving it, the pull-down holds it low otherwise
+}
+
+
+
+/*********
+ *  NVM  *
+ *********/
+
+
+//Erase Page NVM Function, erases the 1KB page of flash memory that contains the provided address, returning whether the erase succeeded
+uint32_t erasePageNVM(const volatile void *page)
+{
+    NVMADDR = KVA_TO_PA(page);  //Point the NVM controller at the physical address of the page to erase
+
+    return operateNVM(0x00000004);  //Perform a page erase operation
+}
+
+//Write Word NVM Function, programs a single 32-bit word into erased flash memory at the provided address, returning whether the write succeeded
+uint32_t writeWordNVM(const volatile void *address, uint32_t value)
+{
+    NVMADDR = KVA_TO_PA(address);  //Point the NVM controller at the physical address of the word to program
+    NVMDATA = value;               //Load the value to be programmed into the word
+
+    return operateNVM(0x00000001);  //Perform a word program operation
+}
+
+//Operate NVM Function, carries out the given NVMOP operation on the flash memory using the unlock sequence, returning whether it completed without errors
+uint32_t operateNVM(uint32_t operation)
+{
+    uint32_t interruptState;  //Interrupt enable state from before the unlock sequence, restored once the operation has been started
+
+    NVMCON = 0x00004000 | operation;  //Select the operation to perform along with setting the WREN bit to enable writes to the flash memory
+
+    //Give the low-voltage detect circuit the 6us it needs to settle after WREN is set, 256 CP0 Count ticks covers this at every clock speed used
+    uint32_t startCount = _CP0_GET_COUNT();
+    while ((_CP0_GET_COUNT() - startCount) < 0x00000100);
+
+    asm volatile ("di %0" : "=r" (interruptState));  //Disable interrupts so that nothing can get between the writes of the unlock sequence
+
+    NVMKEY = 0xAA996655;     //Write the first unlock key to the NVMKEY register
+    NVMKEY = 0x556699AA;     //Write the second unlock key to the NVMKEY register
+    NVMCONSET = 0x00008000;  //Start the operation by setting the WR bit
+
+    if (interruptState & 0x00000001) asm volatile ("ei");  //Enable interrupts again only when they were enabled to begin with
+
+    while (NVMCON & 0x00008000);  //Wait until the operation has finished, the CPU stalls on any flash fetches in the meantime anyway
+    NVMCONCLR = 0x00004000;       //Clear the WREN bit to protect the flash memory from any further writes
+
+    return (NVMCON & 0x00003000) ? 0x00000000 : 0xFFFFFFFF;  //Report failure when either the WRERR or LVDERR bit is set
+}
+
+
+
+/*********
+ *  CRC  *
+ *********/
+
+
+//Calculate CRC16 Function, returns the CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF) of the provided bytes
+uint16_t calculateCRC16(const uint8_t *bytes, uint32_t length)
+{
+    uint16_t crc = 0xFFFF;  //Start from the initial value of the CRC
+
+    while (length--)
+    {
+        crc ^= *bytes++ << 0x00000008;  //Bring the next byte into the top of the CRC
+
+        //Shift the byte through the CRC one bit at a time, applying the polynomial whenever a one falls out of the top
+        for (uint32_t bit = 0x00000008; bit; bit--)
+        {
+            crc = (crc & 0x8000) ? (crc << 0x00000001) ^ 0x1021 : crc << 0x00000001;
+        }
+    }
 
-//    while (DCH2CON & 0x00008000);  //Wait until the block transfer has fully completed
+    return crc;  //Return the calculated CRC
 }
 
 
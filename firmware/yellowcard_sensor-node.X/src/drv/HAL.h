@@ -8,26 +8,122 @@
 #define	_HAL_H_
 
 //Import any libraries used by this file
-#include <xc.h>        //Include the main header file for the XC32 compiler, provides register definitions
-#include <sys/kmem.h>  //Include the kmem header, provides address translation macros between virtual and physical addresses
+#include <xc.h>           //Include the main header file for the XC32 compiler, provides register definitions
+#include <sys/kmem.h>     //Include the kmem header, provides address translation macros between virtual and physical addresses
+#include "../Profiler.h"  //Include the profiler header, provides the probes placed around the bus transactions
 
 
 //Define any enums that are used within this file
 typedef enum
 {
-    SYSCLK_1MHZ = 0x13090702, SYSCLK_16MHZ = 0x13090102
+    SYSCLK_1MHZ, SYSCLK_4MHZ, SYSCLK_16MHZ, SYSCLK_40MHZ, SYSCLK_SPEED_COUNT
 } SysClkSpeed_t;
 
+typedef enum
+{
+    PERIPHERAL_I2C2, PERIPHERAL_SPI1, PERIPHERAL_UART2, PERIPHERAL_DMA, PERIPHERAL_COUNT
+} peripheralModule_t;
+
+typedef enum
+{
+    I2C_STATE_IDLE, I2C_STATE_START, I2C_STATE_WRITE, I2C_STATE_RESTART, I2C_STATE_READ_ADDRESS, I2C_STATE_RECEIVE, I2C_STATE_ACKNOWLEDGE, I2C_STATE_STOP
+} engineStateI2C_t;
+
+
+//Define any constants that are used within this file
+#ifndef I2C_QUEUE_LENGTH
+#define I2C_QUEUE_LENGTH    0x00000004  //Maximum number of I2C transactions that can be waiting in the queue at once, must be a power of 2
+#endif
+
+#define NVM_PAGE_SIZE    0x00000400  //Size in bytes of the smallest block of flash memory that can be erased at once
+
+#define SYSCLK_OSCCON_NOSC_PLL    0x00000100  //NOSC field of the OSCCON words that run the system clock from the PLL (FRCPLL)
+
+//Each operating point pairs an OSCCON word with the baud rate generator values that keep the buses where the drivers expect them, I2C2 at ~370kHz
+//(~120kHz at 1MHz where I2C2BRG bottoms out), UART2 at 19200bps with BRGH set and SPI1 at 2MHz (500kHz at 1MHz). 1MHz and 4MHz divide the FRC
+//down directly and run PBCLK 1:1, so waking from SLEEP at either of them doesn't wait on the PLL to lock. 16MHz and 40MHz run the FRC through the
+//PLL (8MHz / 2 from FPLLIDIV, then x16 / 4 or x20 / 2) with PBCLK at half of SYSCLK, 40MHz being the rated maximum of the PIC32MX120F032B. PLLMULT
+//can't be changed while the PLL is the clock source, so moving between the two PLL points passes through the FRC on the way.
+
+//Every module the application has no use for is switched off through the PMD registers at startup and stays off. The modules it does use are
+//reference counted instead, each one is powered up with its configuration restored from a saved register image when it gains its first user, then
+//switched off again with its image saved once its last user lets go. The I2C2 queue holds I2C2 for as long as it has transactions, the SX1231H
+//driver holds SPI1 for each chip-select window, and DMA driven transfers hold the DMA along with UART2 or SPI1 until they complete. The DMA has no
+//PMD bit on this part, so it is only turned off through its ON bit. Define HAL_KEEP_PERIPHERALS_ON to leave everything powered as before, for
+//measuring the SLEEP current with and without the gating.
+#define PMD_UNUSED_MODULES_1    0x00001101  //ADC, CTMU and comparator voltage reference
+#define PMD_UNUSED_MODULES_2    0x00000007  //Comparators 1 to 3
+#define PMD_UNUSED_MODULES_3    0x001F001F  //Input captures 1 to 5 and output compares 1 to 5
+#define PMD_UNUSED_MODULES_4    0x0000001E  //Timers 2 to 5, Timer 1 runs the scheduler
+#define PMD_UNUSED_MODULES_5    0x01010201  //UART1, SPI2, I2C1 and USB
+#define PMD_UNUSED_MODULES_6    0x00010002  //Reference clock output and parallel master port, the RTCC wakes the node
+
+#define PERIPHERAL_IMAGE_LENGTH    0x00000003  //Largest number of registers making up the saved configuration of a module
+
+
+//Define any structs that are used within this file
+typedef struct transactionI2C_s
+{
+    uint32_t address;                                          //7-bit address of the slave device the transaction is directed at
+    const uint8_t *writeBytes;                                 //Bytes to send to the slave device before any reading takes place
+    uint32_t writeLength;                                      //Number of bytes to send from writeBytes
+    uint8_t *readBytes;                                        //Buffer to store the bytes received from the slave device in
+    uint32_t readLength;                                       //Number of bytes to read from the slave device after writing, a repeated start is used between the two
+    void (*onComplete)(struct transactionI2C_s *transaction);  //Optional callback invoked from the I2C interrupt once the transaction has finished, NULL when unused
+    volatile uint32_t inProgress;                              //Non-zero while the transaction is waiting in the queue or being processed
+    volatile uint32_t succeeded;                               //Non-zero when the transaction finished with every byte acknowledged by the slave device
+} transactionI2C_t;
+
+
+typedef struct
+{
+    uint32_t oscconValue;  //Word written to OSCCON to select the operating point (PLLODIV, FRCDIV, PBDIV, PLLMULT, NOSC and SOSCEN)
+    uint32_t brgI2C;       //I2C2BRG value at the operating point
+    uint32_t brgUART;      //U2BRG value at the operating point, UART2 runs with BRGH set
+    uint32_t brgSPI;       //SPI1BRG value at the operating point
+    uint32_t frequency;    //SYSCLK frequency in Hz at the operating point
+} operatingPointSysClk_t;
+
+typedef struct
+{
+    volatile uint32_t *pmdClear;                                 //PMDxCLR register of the module, NULL for modules that can only be turned off through their ON bit
+    uint32_t pmdMask;                                            //Disable bit of the module within its PMD register
+    volatile uint32_t *imageRegisters[PERIPHERAL_IMAGE_LENGTH];  //Registers making up the configuration of the module, restored in order with the last holding the ON bit
+    uint32_t imageLength;                                        //Number of registers within imageRegisters
+    volatile uint32_t *brgRegister;                              //Baud rate generator of the module, reloaded from the current operating point on restore, NULL when it has none
+    uint32_t brgOffset;                                          //Offset of the baud rate generator value within operatingPointSysClk_t
+} peripheralDescriptor_t;
+
 
 //Define any variables that are external to this
-extern volatile uint8_t dmaBufferTxUART[];  //Used as a buffer for UART transmissions that occur using the DMA
+extern volatile uint32_t transferActiveSPI;                   //Non-zero while a DMA driven SPI1 block transfer is in progress
+extern volatile uint32_t transferActiveUART;                  //Non-zero while a DMA driven UART2 transmission is in progress, including any blocks chained onto it
+extern volatile uint32_t queueCountI2C;                       //Number of transactions currently held within the I2C2 queue, including the active one
+extern const operatingPointSysClk_t sysClkOperatingPoints[];  //Stores the OSCCON word and baud rate generator values of each operating point, indexed by SysClkSpeed_t
+extern SysClkSpeed_t currentClockSpeed;                       //Operating point that the system clock is currently running at
+extern const peripheralDescriptor_t peripheralDescriptors[];  //Stores where the PMD bit, configuration and baud rate generator of each managed module are, indexed by peripheralModule_t
 
 
 //System Oscillator Functions
 extern void allowSleepMode(uint32_t enabled);               //Allow Sleep Mode Function, selects which low-power mode the CPU will enter on the WAIT instruction, zero forces IDLE mode
-extern void changeClockSpeed(SysClkSpeed_t newClockSpeed);  //Change Clock Speed Function, changes the system clock speed and reconfigures peripherals so that they are unaffected
+extern void changeClockSpeed(SysClkSpeed_t newClockSpeed);  //Change Clock Speed Function, changes the system clock speed once the buses are quiet and reconfigures peripherals so that they are unaffected
+extern void switchOscillator(uint32_t oscconValue);         //Switch Oscillator Function, moves the system clock over to the provided OSCCON word, called with interrupts disabled and the registers unlocked
+extern void waitWhileBusy(volatile uint32_t *busyFlag);     //Wait While Busy Function, keeps the CPU in its low-power WAIT state until the provided flag is cleared by an interrupt
+
+//Peripheral Power Functions
+extern void initializePeripheralPower();                  //Initialize Peripheral Power Function, switches off every unused module for good and every managed module until it gains a user
+extern void acquirePeripheral(peripheralModule_t module);  //Acquire Peripheral Function, adds a user onto the given module, powering it up and restoring its configuration when it was off, safe to call from within interrupts
+extern void releasePeripheral(peripheralModule_t module);  //Release Peripheral Function, drops a user from the given module, saving its configuration and switching it off after the last one, safe to call from within interrupts
+extern void gatePeripheral(peripheralModule_t module);     //Gate Peripheral Function, saves the configuration of the given module into its image and switches it off
+extern void restorePeripheral(peripheralModule_t module);  //Restore Peripheral Function, switches the given module back on and restores its configuration from its image
+extern void writePMD(volatile uint32_t *pmdClear,          //Write PMD Function, sets or clears the given bits of a PMD register, unlocking them for the write
+                     uint32_t mask,
+                     uint32_t disable);
 
 //I2C Functions
+extern uint32_t queueTransactionI2C(transactionI2C_t *transaction);  //Queue Transaction I2C Function, adds the provided transaction to the I2C2 queue, starting the bus right away when it is idle
+extern void serviceTransactionI2C();                               //Service Transaction I2C Function, advances the I2C2 transaction engine by one step, called from the I2C2 master interrupt
+extern void abortTransactionI2C();                                 //Abort Transaction I2C Function, fails the active I2C2 transaction after a bus collision and moves on to the next one
 extern uint32_t writeToI2C(uint32_t address,         //Write To I2C Function, sends the provided array of bytes to the provided slave address using the I2C2 peripheral
                            const uint8_t *bytes,
                            uint32_t length);
@@ -36,11 +132,32 @@ extern uint32_t readFromI2C(uint32_t address,         //Read from I2C Function,
                             uint32_t readLength,
                             uint32_t addressLength);
 
+//SPI Functions
+extern void startBlockTransferSPI(const uint8_t *txBytes,  //Start Block Transfer SPI Function, streams the provided bytes through SPI1 using DMA 1 for TX and DMA 0 for RX, rxBytes may be NULL for write-only transfers
+                                  uint8_t *rxBytes,
+                                  uint32_t length,
+                                  void (*onComplete)());
+extern void drainTransferSPI();                           //Drain Transfer SPI Function, waits for the last bytes of a write-only transfer to leave the SPI1 shift register, called when DMA 1 completes
+extern void completeTransferSPI();                        //Complete Transfer SPI Function, finishes off the active SPI1 block transfer, called once the final byte has been clocked out
+
 //UART Functions
 extern void writeToUART(const uint8_t *bytes,  //Write to UART Function, sends the provided array of bytes out the serial port through UART2
                         uint32_t length);
-extern void startTxUART(const uint8_t *bytes,     //Start Transmission UART Function, begins sending the provided string over UART
+extern void startTxUART(const uint8_t *bytes,     //Start Transmission UART Function, begins sending the provided string over UART, chaining it straight onto the end of a transmission that is still going
                         const uint32_t *length);
+extern void drainTxUART();                        //Drain Transmission UART Function, waits for the last bytes of the DMA driven UART2 transmission to leave the shift register, called once DMA 2 has completed the last block queued for it
+extern void completeTxUART();                     //Complete Transmission UART Function, finishes off the DMA driven UART2 transmission, called from the UART2 TX interrupt once its last byte has left the shift register
+extern uint32_t detectConsoleUART();              //Detect Console UART Function, returns whether a console is attached to UART2, sensed through U2RX being held at its idle high level against the pull-down on RB5
+
+//NVM Functions
+extern uint32_t erasePageNVM(const volatile void *page);    //Erase Page NVM Function, erases the 1KB page of flash memory that contains the provided address, returning whether the erase succeeded
+extern uint32_t writeWordNVM(const volatile void *address,  //Write Word NVM Function, programs a single 32-bit word into erased flash memory at the provided address, returning whether the write succeeded
+                             uint32_t value);
+extern uint32_t operateNVM(uint32_t operation);             //Operate NVM Function, carries out the given NVMOP operation on the flash memory using the unlock sequence, returning whether it completed without errors
+
+//CRC Functions
+extern uint16_t calculateCRC16(const uint8_t *bytes,  //Calculate CRC16 Function, returns the CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF) of the provided bytes
+                               uint32_t length);
 
 
 #endif
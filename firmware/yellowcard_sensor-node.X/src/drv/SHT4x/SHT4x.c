@@ -8,6 +8,14 @@
 
 
 
+/*******************************
+ *  CRC-8 Nibble Lookup Table  *
+ *******************************/
+
+const uint8_t sht4xCRC8Table[] = {0x00, 0x31, 0x62, 0x53, 0xC4, 0xF5, 0xA6, 0x97, 0xB9, 0x88, 0xDB, 0xEA, 0x7D, 0x4C, 0x1F, 0x2E};
+
+
+
 /************************
  *  Sensor Interaction  *
  ************************/
@@ -55,14 +63,42 @@ uint32_t getResultsSHT4X(uint16_t *rawTemperature, uint16_t *rawHumidity)
 
     if (!readFromI2C(SHT4X_I2C_ADDR, dataBuffer, 0x00000006, 0x00)) return 0x00;  //Attempt to read from the sensors FIFO buffer, exit the function with 0x00 if the sensor is non-responsive
 
+    //Reject the results when either of them has been corrupted on its way over the bus
+    if (calculateCRC8SHT4X(dataBuffer, 0x00000002) != dataBuffer[0x00000002]) return 0x00;
+    if (calculateCRC8SHT4X(dataBuffer + 0x00000003, 0x00000002) != dataBuffer[0x00000005]) return 0x00;
+
     *rawTemperature = (dataBuffer[0x00000000] << 0x00000008) + dataBuffer[0x00000001];  //Consolidate the raw temperature measurement from the byte array obtained from the sensor
     *rawHumidity = (dataBuffer[0x00000003] << 0x00000008) + dataBuffer[0x00000004];     //Consolidate the raw humidity measurement from the byte array obtained from the sensor
 
-    //TODO: Calculate checksum and determine if it's accurate
-
     return 0xFF;  //Indicate a successful FIFO read by returning 0xFF
 }
 
+//Get Measure Time Function, returns the maximum time in microseconds the sensor takes to finish the given measurement type
+uint32_t getMeasureTimeSHT4X(measurementTypeSHT4X_t operation)
+{
+    switch (operation)
+    {
+        case LOW_PRECISION_NO_HEATER:
+            return SHT4X_MEASURE_TIME_LOW_US;
+
+        case MED_PRECISION_NO_HEATER:
+            return SHT4X_MEASURE_TIME_MED_US;
+
+        case HIGH_PRECISION_20MW_HEATER_100MS:
+        case HIGH_PRECISION_110MW_HEATER_100MS:
+        case HIGH_PRECISION_200MW_HEATER_100MS:
+            return SHT4X_MEASURE_TIME_HEATER_SHORT_US;
+
+        case HIGH_PRECISION_20MW_HEATER_1S:
+        case HIGH_PRECISION_110MW_HEATER_1S:
+        case HIGH_PRECISION_200MW_HEATER_1S:
+            return SHT4X_MEASURE_TIME_HEATER_LONG_US;
+
+        default:
+            return SHT4X_MEASURE_TIME_HIGH_US;
+    }
+}
+
 
 
 /*********************
@@ -70,6 +106,29 @@ uint32_t getResultsSHT4X(uint16_t *rawTemperature, uint16_t *rawHumidity)
  *********************/
 
 
+//Convert To Centi-Celsius From SHT4X, returns the temperature in hundredths of a degree Celsius from the provided raw SHT4X sensor data
+int32_t convertToCentiCFromSHT4X(const uint16_t *rawSensorValue)
+{
+    return (int32_t) scaleRawSHT4X(*rawSensorValue, SHT4X_SPAN_CENTI_C) + SHT4X_OFFSET_CENTI_C;  //Calculate the temperature in hundredths of a degree Celsius
+}
+
+//Convert To Centi-Fahrenheit From SHT4X, returns the temperature in hundredths of a degree Fahrenheit from the provided raw SHT4X sensor data
+int32_t convertToCentiFFromSHT4X(const uint16_t *rawSensorValue)
+{
+    return (int32_t) scaleRawSHT4X(*rawSensorValue, SHT4X_SPAN_CENTI_F) + SHT4X_OFFSET_CENTI_F;  //Calculate the temperature in hundredths of a degree Fahrenheit
+}
+
+//Convert To Centi-RH From SHT4X, returns the relative humidity in hundredths of a percent from the provided raw SHT4X sensor data, bounded to 0-100%
+int32_t convertToCentiRHFromSHT4X(const uint16_t *rawSensorValue)
+{
+    int32_t returnValue = (int32_t) scaleRawSHT4X(*rawSensorValue, SHT4X_SPAN_CENTI_RH) + SHT4X_OFFSET_CENTI_RH;  //Calculate the actual humidity in hundredths of a percent
+    if (returnValue > 10000) returnValue = 10000;  //Bound the calculated relative humidity to an upper limit of 100% RH
+    if (returnValue < 0) returnValue = 0;          //Bound the calculated relative humidity to a lower limit of 0% RH
+
+    return returnValue;  //Return the calculated relative humidity
+}
+
+#ifdef SHT4X_FLOAT_REFERENCE
 //Convert To Temperature Celsius From SHT4X, returns the temperature in Celsius from the provided raw STH4X sensor data
 float convertToTempCFromSHT4X(const uint16_t *rawSensorValue)
 {
@@ -79,7 +138,7 @@ float convertToTempCFromSHT4X(const uint16_t *rawSensorValue)
 //Convert To Temperature Fahrenheit From SHT4X, returns the temperature in Fahrenheit from the provided raw SHT4X sensor data
 float converttoTempFFromSHT4X(const uint16_t *rawSensorValue)
 {
-    return ((float) *rawSensorValue / 65535.0F * 315.0F) - -49.0F;  //Calculate the temperature in Fahrenheit
+    return ((float) *rawSensorValue / 65535.0F * 315.0F) - 49.0F;  //Calculate the temperature in Fahrenheit
 }
 
 //Convert To Relative Humidity From SHT4X, returns the relative humidity in % from the provided raw SHT4X sensor data
@@ -91,6 +150,7 @@ float convertToRHFromSHT4X(const uint16_t *rawSensorValue)
 
     return returnValue;  //Return the calculated relative humidity
 }
+#endif
 
 
 
@@ -99,6 +159,30 @@ float convertToRHFromSHT4X(const uint16_t *rawSensorValue)
  ***********************/
 
 
+//Calculate CRC8 Function, returns the CRC-8 of the provided bytes as used by the sensor to protect its results
+uint8_t calculateCRC8SHT4X(const uint8_t *dataBytes, uint32_t length)
+{
+    uint32_t crc = SHT4X_CRC_INIT;  //Start the CRC off with its initial value
+
+    //Feed each byte through the CRC, the upper nibble first and then the lower nibble
+    while (length--)
+    {
+        crc ^= *dataBytes++;
+        crc = ((crc << 0x00000004) & 0x000000FF) ^ sht4xCRC8Table[crc >> 0x00000004];
+        crc = ((crc << 0x00000004) & 0x000000FF) ^ sht4xCRC8Table[crc >> 0x00000004];
+    }
+
+    return (uint8_t) crc;  //Return the final CRC, no output XOR is applied
+}
+
+//Scale Raw Function, returns span * rawValue / 65535 rounded to the nearest whole number without a division
+uint32_t scaleRawSHT4X(uint32_t rawValue, uint32_t span)
+{
+    uint32_t numerator = (span * rawValue * 0x00000002) + 0x0000FFFF;  //Twice the product plus the divisor, halving the quotient afterwards rounds it to the nearest
+
+    return ((numerator + (numerator >> 0x00000010) + 0x00000001) >> 0x00000010) >> 0x00000001;  //Divide by 65535 and then by 2, the numerator stays below 65535 * 65536 for spans up to 32767
+}
+
 
 
 
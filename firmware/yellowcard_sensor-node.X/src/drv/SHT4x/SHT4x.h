@@ -17,8 +17,34 @@
 #define SHT4X_I2C_ADDR    0x44  //Sets the I2C address of the device
 #endif
 
+//Maximum time in microseconds taken by each type of measurement (datasheet table 4), the heater pulses are followed by a high precision measurement
+#define SHT4X_MEASURE_TIME_LOW_US            0x00000640  //Low precision measurement without the heater (1.6ms)
+#define SHT4X_MEASURE_TIME_MED_US            0x00001194  //Medium precision measurement without the heater (4.5ms)
+#define SHT4X_MEASURE_TIME_HIGH_US           0x0000206C  //High precision measurement without the heater (8.3ms)
+#define SHT4X_MEASURE_TIME_HEATER_SHORT_US   (0x0001ADB0 + SHT4X_MEASURE_TIME_HIGH_US)  //0.1s heater pulse (at most 0.11s) and the measurement after it
+#define SHT4X_MEASURE_TIME_HEATER_LONG_US    (0x0010C8E0 + SHT4X_MEASURE_TIME_HIGH_US)  //1s heater pulse (at most 1.1s) and the measurement after it
+
+#define SHT4X_CRC_INIT    0xFF  //Initial value of the CRC-8 protecting each word of the results, the polynomial is 0x31 (x^8 + x^5 + x^4 + 1)
+
+//The conversions work in hundredths of a degree or of a percent, each being an offset plus span * raw / 65535 rounded to the nearest hundredth. The
+//division by 65535 is done with a shift and add (exact for numerators below 65535 * 65536), so a conversion costs one multiply and a few adds rather
+//than a soft float divide and multiply. Every one of the 65536 raw values gives the exact datasheet conversion rounded to the nearest hundredth, the
+//single precision float conversions land a hundredth off for a few dozen of them.
+//Define SHT4X_FLOAT_REFERENCE to also build the float conversions for comparison.
+#define SHT4X_SPAN_CENTI_C       0x0000445C  //Span of the temperature conversion in hundredths of a degree Celsius (175C)
+#define SHT4X_OFFSET_CENTI_C     (-4500)     //Offset of the temperature conversion in hundredths of a degree Celsius (-45C)
+#define SHT4X_SPAN_CENTI_F       0x00007B0C  //Span of the temperature conversion in hundredths of a degree Fahrenheit (315F)
+#define SHT4X_OFFSET_CENTI_F     (-4900)     //Offset of the temperature conversion in hundredths of a degree Fahrenheit (-49F)
+#define SHT4X_SPAN_CENTI_RH      0x000030D4  //Span of the humidity conversion in hundredths of a percent (125%)
+#define SHT4X_OFFSET_CENTI_RH    (-600)      //Offset of the humidity conversion in hundredths of a percent (-6%)
+
+//The sensor NACKs any read while it is still busy with a measurement, so rather than polling it the results are read exactly once after the time
+//given by getMeasureTimeSHT4X() for the requested measurement type has passed. Each 16-bit result is followed by a CRC-8 of its two bytes, a result
+//that fails its CRC is rejected. The CRC is worked out a nibble at a time through a 16 entry table, two lookups per byte instead of eight shifts.
+
 
 //Define any variables that are external to this file
+extern const uint8_t sht4xCRC8Table[];  //Stores the CRC-8 remainder of every possible upper nibble, used to work through the CRC 4 bits at a time
 
 
 //Define any enum types used within this file
@@ -38,13 +64,25 @@ typedef enum
 
 //Sensor Interaction Functions
 extern uint32_t requestMeasurementSHT4X(measurementTypeSHT4X_t operation);  //Request Measurement Function, instructs the sensor to begin the requested measurement type
-extern uint32_t getResultsSHT4X(uint16_t *rawTemperature,                 //Get Results Function, reads the results out of the sensors FIFO buffer and writes them to the provided pointers
-                               uint16_t *rawHumidity);
+extern uint32_t getResultsSHT4X(uint16_t *rawTemperature,                  //Get Results Function, reads the results out of the sensors FIFO buffer, checks their CRCs and writes them to the provided pointers
+                                uint16_t *rawHumidity);
+extern uint32_t getMeasureTimeSHT4X(measurementTypeSHT4X_t operation);      //Get Measure Time Function, returns the maximum time in microseconds the sensor takes to finish the given measurement type
 
 //Data Conversion Functions
-extern float convertToTempCFromSHT4X(const uint16_t *rawSensorValue);  //Convert To Temperature Celsius From SHT4X, returns the temperature in Celsius from the provided raw STH4X sensor data
-extern float converttoTempFFromSHT4X(const uint16_t *rawSensorValue);  //Convert To Temperature Fahrenheit From SHT4X, returns the temperature in Fahrenheit from the provided raw SHT4X sensor data
-extern float convertToRHFromSHT4X(const uint16_t *rawSensorValue);     //Convert To Relative Humidity From SHT4X, returns the relative humidity in % from the provided raw SHT4X sensor data
+extern int32_t convertToCentiCFromSHT4X(const uint16_t *rawSensorValue);   //Convert To Centi-Celsius From SHT4X, returns the temperature in hundredths of a degree Celsius from the provided raw SHT4X sensor data
+extern int32_t convertToCentiFFromSHT4X(const uint16_t *rawSensorValue);   //Convert To Centi-Fahrenheit From SHT4X, returns the temperature in hundredths of a degree Fahrenheit from the provided raw SHT4X sensor data
+extern int32_t convertToCentiRHFromSHT4X(const uint16_t *rawSensorValue);  //Convert To Centi-RH From SHT4X, returns the relative humidity in hundredths of a percent from the provided raw SHT4X sensor data, bounded to 0-100%
+#ifdef SHT4X_FLOAT_REFERENCE
+extern float convertToTempCFromSHT4X(const uint16_t *rawSensorValue);      //Convert To Temperature Celsius From SHT4X, returns the temperature in Celsius from the provided raw STH4X sensor data
+extern float converttoTempFFromSHT4X(const uint16_t *rawSensorValue);      //Convert To Temperature Fahrenheit From SHT4X, returns the temperature in Fahrenheit from the provided raw SHT4X sensor data
+extern float convertToRHFromSHT4X(const uint16_t *rawSensorValue);         //Convert To Relative Humidity From SHT4X, returns the relative humidity in % from the provided raw SHT4X sensor data
+#endif
+
+//Utility Functions
+extern uint8_t calculateCRC8SHT4X(const uint8_t *dataBytes,  //Calculate CRC8 Function, returns the CRC-8 of the provided bytes as used by the sensor to protect its results
+                                  uint32_t length);
+extern uint32_t scaleRawSHT4X(uint32_t rawValue,              //Scale Raw Function, returns span * rawValue / 65535 rounded to the nearest whole number without a division
+                              uint32_t span);
 
 
 #endif
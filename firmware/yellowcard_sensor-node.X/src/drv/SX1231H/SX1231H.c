@@ -13,6 +13,20 @@
  ***************/
 
 //Configuration Settings
+const uint8_t sx1231hInit_Radio[] = {0x04,                                                              //RegOpMode, STANDBY
+                                     APPRF_MODULATION,                                                  //RegDataModul
+                                     SX1231H_BITRATE_TO_DIVIDER(APPRF_BIT_RATE) >> 0x00000008,          //RegBitrateMsb
+                                     SX1231H_BITRATE_TO_DIVIDER(APPRF_BIT_RATE) & 0x000000FF,           //RegBitrateLsb
+                                     SX1231H_FREQ_TO_STEPS(APPRF_FREQ_DEVIATION) >> 0x00000008,         //RegFdevMsb
+                                     SX1231H_FREQ_TO_STEPS(APPRF_FREQ_DEVIATION) & 0x000000FF,          //RegFdevLsb
+                                     SX1231H_FREQ_TO_STEPS(APPRF_CARRIER_FREQ) >> 0x00000010,           //RegFrfMsb
+                                     (SX1231H_FREQ_TO_STEPS(APPRF_CARRIER_FREQ) >> 0x00000008) & 0xFF,  //RegFrfMid
+                                     SX1231H_FREQ_TO_STEPS(APPRF_CARRIER_FREQ) & 0x000000FF};           //RegFrfLsb
+
+const uint8_t sx1231hInit_PowerAmplifier[] = {SX1231H_PALEVEL_VALUE(APPRF_TX_POWER),  //RegPaLevel
+                                              0x09,                                   //RegPaRamp
+                                              SX1231H_OCP_VALUE(APPRF_TX_POWER)};     //RegOcp
+
 const uint8_t sx1231hInit_PacketEngine[] = {0x00,   //RegPreambleMsb
                                             0x07,   //RegPreambleLsb
                                             0xA8,   //RegSyncConfig
@@ -32,6 +46,27 @@ const uint8_t sx1231hInit_PacketEngine[] = {0x00,   //RegPreambleMsb
                                             0x8F,   //RegFifoThresh
                                             0x02};  //RegPacketConfig2l
 
+//Register Shadow
+uint8_t sx1231hShadowRegisters[SX1231H_REGISTER_COUNT];                             //RAM copy of the transceiver's register map, setters only ever modify this copy
+uint32_t sx1231hShadowValid[(SX1231H_REGISTER_COUNT + 0x0000001F) >> 0x00000005];  //One bit per register, set when the shadow copy is known to match the transceiver
+uint32_t sx1231hShadowDirty[(SX1231H_REGISTER_COUNT + 0x0000001F) >> 0x00000005];  //One bit per register, set when the shadow copy holds a value not yet written to the transceiver
+
+//Transmitter State
+volatile uint32_t sx1231hTxActive = 0x00000000;                     //Set while a frame is on its way out of the transceiver, cleared from the INT4 interrupt once PacketSent is raised
+void (*sx1231hRestHook)(volatile uint32_t *flag) = &waitWhileBusy;  //Called to wait out a frame on air, the application can swap in a rest that lets the MCU go into SLEEP
+
+//Frame Streaming
+const segmentSX1231H_t *sx1231hStreamSegments;          //Next segment descriptor of the frame being streamed, only looked at once the current segment has been used up
+const uint8_t *sx1231hStreamCursor;                     //Next byte of the current segment to write into the FIFO buffer
+uint32_t sx1231hStreamLeft;                             //Number of bytes left in the current segment
+volatile uint32_t sx1231hStreamRemaining = 0x00000000;  //Number of bytes of the frame being streamed that have yet to be written into the FIFO buffer
+
+//Diagnostics
+#ifdef SX1231H_MEASURE_SPI_CYCLES
+volatile uint32_t sx1231hTransferCycles;  //CP0 Count cycles (SYSCLK / 2) taken by the most recent register or segment transfer, including chip-select handling
+volatile uint32_t sx1231hFifoCycles;      //CP0 Count cycles (SYSCLK / 2) taken by the most recent FIFO load or refill, kept apart as refills land from within the INT3 interrupt
+#endif
+
 
 
 /******************************
@@ -40,18 +75,21 @@ const uint8_t sx1231hInit_PacketEngine[] = {0x00,   //RegPreambleMsb
 
 
 //Initialize Function, configures the transceiver IC to operate as required for the application
-void initializeSX1231H(modSchemeSX1231H_t modulation)
+void initializeSX1231H()
 {
-    uint8_t configBytes[0x00000003];  //Create an array of bytes to use for writing the desired configuration settings to the transceiver IC
-    
-    //Common configuration registers
-    configBytes[0x00000000] = 0x04;        //Put the transceiver into STANDBY mode by default
-    configBytes[0x00000001] = modulation;  //Set the desired modulation scheme
+    invalidateShadowSX1231H();  //Nothing is known about the state of the transceiver's registers at this point
 
-    interactWithRegistersSX1231H(0x00000001, configBytes, 0x00000002, 0x00000000);  //Send the configuration bytes to the transceiver IC with a starting address of 0x01 (RegOpMode)
+    //Radio configuration registers, generated at compile time from the APPRF settings
+    setRegistersSX1231H(REGADDR_OPMODE, sx1231hInit_Radio, sizeof(sx1231hInit_Radio));                      //Load the mode, modulation, bit-rate, deviation and carrier frequency starting at 0x01 (RegOpMode)
+    setRegistersSX1231H(REGADDR_PALEVEL, sx1231hInit_PowerAmplifier, sizeof(sx1231hInit_PowerAmplifier));   //Load the power amplifier configuration starting at 0x11 (RegPaLevel)
+    setRegisterSX1231H(REGADDR_TESTPA1, SX1231H_TESTPA1_VALUE(APPRF_TX_POWER));                             //Load the high power settings of PA1
+    setRegisterSX1231H(REGADDR_TESTPA2, SX1231H_TESTPA2_VALUE(APPRF_TX_POWER));                             //Load the high power settings of PA2
 
     //Packet engine registers
-    interactWithRegistersSX1231H(0x0000002C, (uint8_t *) sx1231hInit_PacketEngine, 0x00000012, 0x00000000);  //Send the configuration bytes to the transceiver IC with a starting address of 0x2C (RegPreambleMsb)
+    setRegistersSX1231H(REGADDR_PREAMBLE_MSB, sx1231hInit_PacketEngine, sizeof(sx1231hInit_PacketEngine));  //Load the packet engine configuration into the shadow copy starting at 0x2C (RegPreambleMsb)
+    setRegisterSX1231H(REGADDR_DIOMAPPING1, SX1231H_DIOMAPPING1_VALUE);                                     //Map DIO0 to PacketSent while in TX mode so that INT4 fires once the frame has left the antenna
+
+    flushRegistersSX1231H();  //Send the entire configuration to the transceiver in as few bursts as possible
 }
 
 
@@ -64,17 +102,130 @@ void initializeSX1231H(modSchemeSX1231H_t modulation)
 //Write Packet Function, writes the desired packet to the FIFO buffer on the transceiver IC
 void writePacketSX1231H(const uint8_t *payloadBytes, uint32_t payloadLength)
 {
-    uint8_t formedFrame[0x00000101];     //Create a temporary buffer with the max number of bytes a frame can have
-    uint8_t *framePtr = formedFrame;     //Make a pointer to use for iterating through the addresses in the array above
-    uint32_t frameSize = payloadLength;  //Declare a variable to use for calculating the total size of the frame
+    segmentSX1231H_t frame = {payloadBytes, payloadLength};  //Describe the packet as a single segment, it is streamed straight out of the caller's buffer
+
+    writeFrameSX1231H(&frame, 0x00000001);  //Write the packet frame to the FIFO buffer of the transceiver
+}
+
+//Write Frame Function, streams a frame made up of several separate segments (header first, then the payload pieces) into the FIFO buffer without staging it
+void writeFrameSX1231H(const segmentSX1231H_t *segments, uint32_t segmentCount)
+{
+    writeSegmentsSX1231H(REGADDR_FIFO, segments, segmentCount);  //Write every segment to the FIFO buffer of the transceiver within a single chip-select window
+}
+
+//Transmit Packet Function, sends the desired packet over the air, returning as soon as it has been handed to the transceiver
+void transmitPacketSX1231H(const uint8_t *payloadBytes, uint32_t payloadLength)
+{
+    segmentSX1231H_t frame = {payloadBytes, payloadLength};  //Describe the packet as a single segment, it is streamed straight out of the caller's buffer
+
+    transmitFrameSX1231H(&frame, 0x00000001);  //Send the packet frame over the air
+}
+
+//Transmit Frame Function, sends a frame made up of several separate segments over the air, returning as soon as it has been handed to the transceiver
+void transmitFrameSX1231H(const segmentSX1231H_t *segments, uint32_t segmentCount)
+{
+    if (!segmentCount) return;  //Leave early when there is nothing to send, PacketSent would never arrive otherwise
+
+    waitForTxSX1231H();           //Let any frame that is still on air finish before loading the next one
+    //Start from STBY when wakeSX1231H() already has the crystal oscillator running, otherwise from SLEEP, the packet engine returns to this mode by itself once PacketSent is raised
+    if (sx1231hShadowRegisters[REGADDR_OPMODE] == (STBY << 0x00000002)) flushRegistersSX1231H();  //Stay in STBY, only committing any pending configuration
+    else setDeviceModeSX1231H(SLEEP);                                                               //Make sure the transceiver starts from SLEEP
+
+    IFS0CLR = 0x00800000;          //Clear any stale INT4 interrupt flag left behind from before the transmission
+    sx1231hTxActive = 0xFFFFFFFF;  //Mark the transmitter as busy before the FIFO is loaded, the interrupt may arrive at any point afterwards
+
+    //Prepare to stream the frame, adding up the length of every segment
+    sx1231hStreamSegments = segments;                                        //Start streaming from the first segment
+    sx1231hStreamLeft = 0x00000000;                                          //Nothing has been taken from the first segment yet
+    sx1231hStreamRemaining = 0x00000000;                                     //Start the running total of the frame length off at 0
+    while (segmentCount--) sx1231hStreamRemaining += (segments++)->length;  //Add the length of each segment onto the running total
+
+    //Loading the FIFO is all it takes to start the transmission, RegAutoModes switches the transceiver to TX on FifoNotEmpty and back to the starting mode on PacketSent
+    IFS0CLR = 0x00040000;                            //Clear the INT3 interrupt flag so that only a FifoLevel falling edge from this frame is acted upon
+    fillFifoSX1231H(SX1231H_FIFO_SIZE, 0x00000000);  //Preload as much of the frame as the FIFO buffer can hold
+
+    //Frames larger than the FIFO buffer are topped up from the INT3 interrupt each time DIO1 reports that the FIFO has drained down to its threshold
+    if (sx1231hStreamRemaining) IEC0SET = 0x00040000;  //Enable the INT3 interrupt while there is still more of the frame left to send
+}
+
+//Wake Function, moves the transceiver into STBY so that its crystal oscillator has started up (TS_OSC, ~250us) by the time the next frame is loaded
+void wakeSX1231H()
+{
+    if (sx1231hTxActive) return;  //Leave the transceiver alone while a frame is still on air, it is already awake
+
+    setDeviceModeSX1231H(STBY);  //Start the crystal oscillator, the next transmission then starts from STBY and returns to it once sent
+}
+
+//Wait For TX Function, rests the MCU through sx1231hRestHook until the frame currently on air has been sent
+void waitForTxSX1231H()
+{
+    if (!sx1231hTxActive) return;  //Nothing to wait for when the transmitter is already idle
+
+    sx1231hRestHook(&sx1231hTxActive);  //Rest until the INT4 interrupt reports that the frame has been sent, INT4 still wakes the MCU from SLEEP when DIO0 goes high
+}
 
-    //Add every byte of the payload to the frame buffer
-    while (payloadLength--)
+//Packet Sent Function, called from the INT4 interrupt when DIO0 signals that the transceiver has finished sending the frame
+void packetSentSX1231H()
+{
+    sx1231hTxActive = 0x00000000;  //The transceiver has already dropped itself back to the mode it started from, so all that's left is to release anyone waiting on it
+}
+
+//Refill FIFO Function, called from the INT3 interrupt when DIO1 signals that the FIFO has drained down to its threshold
+void refillFifoSX1231H()
+{
+    fillFifoSX1231H(SX1231H_FIFO_SIZE - SX1231H_FIFO_THRESHOLD, 0xFFFFFFFF);  //Top the FIFO buffer back up, it holds exactly SX1231H_FIFO_THRESHOLD bytes on the falling edge of FifoLevel
+
+    if (!sx1231hStreamRemaining) IEC0CLR = 0x00040000;  //Disable the INT3 interrupt once the whole frame has been handed to the transceiver
+}
+
+//Fill FIFO Function, writes up to room bytes of the frame being streamed into the FIFO buffer within a single chip-select window
+void fillFifoSX1231H(uint32_t room, uint32_t fromInterrupt)
+{
+    uint32_t chunkLength;  //Number of bytes to write out of the current segment
+
+    if (room > sx1231hStreamRemaining) room = sx1231hStreamRemaining;  //Never write past the end of the frame
+    if (!room) return;                                                  //Leave early when there is nothing left to write, otherwise the SS line would be left asserted
+
+#ifdef SX1231H_MEASURE_SPI_CYCLES
+    uint32_t startCount = _CP0_GET_COUNT();  //Take note of the CP0 Count at the start of the load
+#endif
+
+    sx1231hStreamRemaining -= room;                     //Account for the bytes about to be written
+    beginTransactionSX1231H(REGADDR_FIFO, 0x00000000);  //Select the transceiver and address the FIFO buffer
+
+    //Gather bytes from as many segments as needed to fill the requested room
+    while (room)
     {
-        *(framePtr++) = *(payloadBytes++);  //Copy the next byte from the payloadBytes array into the frame buffer
+        //Move on to the next segment descriptor once the current segment has been used up
+        while (!sx1231hStreamLeft)
+        {
+            sx1231hStreamCursor = sx1231hStreamSegments->bytes;  //Start at the beginning of the next segment
+            sx1231hStreamLeft = sx1231hStreamSegments->length;   //Take note of how many bytes it holds
+            sx1231hStreamSegments++;                             //Point at the segment descriptor after it for next time
+        }
+
+        chunkLength = (room < sx1231hStreamLeft) ? room : sx1231hStreamLeft;  //Write as much of the current segment as there is room for
+
+        //The DMA can't be waited on from within an interrupt, so refills are always polled through
+        if (fromInterrupt)
+        {
+            pollBytesSX1231H((uint8_t *) sx1231hStreamCursor, chunkLength, 0x00000000);  //Write the chunk to the FIFO buffer one byte at a time
+        }
+        else
+        {
+            transferBytesSX1231H((uint8_t *) sx1231hStreamCursor, chunkLength, 0x00000000, 0x00000000);  //Write the chunk to the FIFO buffer, keeping the SS line asserted afterwards
+        }
+
+        sx1231hStreamCursor += chunkLength;  //Advance past the bytes that were written
+        sx1231hStreamLeft -= chunkLength;    //Take them off of what's left in the current segment
+        room -= chunkLength;                 //Take them off of the room left in the FIFO buffer
     }
 
-    interactWithRegistersSX1231H(REGADDR_FIFO, formedFrame, frameSize, 0x00000000);  //Write the packet frame to the FIFO buffer of the transceiver
+    releaseChipSelectSX1231H();  //Bring the SS line back up to end the transaction
+
+#ifdef SX1231H_MEASURE_SPI_CYCLES
+    sx1231hFifoCycles = _CP0_GET_COUNT() - startCount;  //Record how long the load took
+#endif
 }
 
 
@@ -87,8 +238,7 @@ void writePacketSX1231H(const uint8_t *payloadBytes, uint32_t payloadLength)
 //Set Carrier Frequency Function, sets the RF transceiver to tune to the desired carrier frequency
 void setCarrierFreqSX1231H(uint32_t freqRF)
 {
-    float calculatedFrequency = (float) freqRF / SX1231H_F_STEP;  //Calculate the value of Frf to provide the transceiver IC to achieve the desired carrier frequency
-    uint32_t regFrfValue = calculatedFrequency;                   //Force cast the calculated value into an unsigned 32-bit integer to make byte separation easier
+    uint32_t regFrfValue = SX1231H_FREQ_TO_STEPS(freqRF);  //Calculate the value of Frf to provide the transceiver IC to achieve the desired carrier frequency
 
     uint8_t registerValues[0x00000003];  //Create an array of 3 bytes to use for splitting the contents of the register value across
 
@@ -98,14 +248,13 @@ void setCarrierFreqSX1231H(uint32_t freqRF)
     regFrfValue >>= 0x00000008;                             //Shift the contents of regFrfValue to the right by 8 bits
     registerValues[0x00000000] = regFrfValue & 0x000000FF;  //Write the final 8 bits of the regFrfValue variable into the first index of the array
 
-    interactWithRegistersSX1231H(REGADDR_FRF_MSB, registerValues, 0x00000003, 0x00000000);  //Send the configuration bytes to the transceiver IC
+    setRegistersSX1231H(REGADDR_FRF_MSB, registerValues, 0x00000003);  //Update the shadow copy of the carrier frequency registers
 }
 
 //Set Frequency Deviation Function, sets the FSK (de)modulator frequency deviation
 void setFreqDeviationSX1231H(uint32_t freqDev)
 {
-    float calculatedDeviation = (float) freqDev / SX1231H_F_STEP;  //Calculate the value of Fdev to provide to the transceiver to achieve the desired frequency deviation in FSK mode
-    uint16_t regFdevValue = calculatedDeviation;                   //Force cast the calculated value into an unsigned 16-bit integer to make byte separation easier
+    uint16_t regFdevValue = SX1231H_FREQ_TO_STEPS(freqDev);  //Calculate the value of Fdev to provide to the transceiver to achieve the desired frequency deviation in FSK mode
 
     uint8_t registerValues[0x00000002];  //Create an array of 2 bytes to use for splitting the contents of the register value across
 
@@ -113,13 +262,13 @@ void setFreqDeviationSX1231H(uint32_t freqDev)
     regFdevValue >>= 0x00000008;                             //Shift the contents of regFdevValue to the right by 8 bits
     registerValues[0x00000000] = regFdevValue & 0x000000FF;  //Write the final 8 bits of the regFdev variable into the first index of the array
 
-    interactWithRegistersSX1231H(REGADDR_FDEV_MSB, registerValues, 0x00000002, 0x00000000);  //Send the configuration bytes to the transceiver IC
+    setRegistersSX1231H(REGADDR_FDEV_MSB, registerValues, 0x00000002);  //Update the shadow copy of the frequency deviation registers
 }
 
 //Set Bit-Rate Function, sets the data (de)modulator to operate at the desired bit-rate
 void setBitRateSX1231H(uint32_t bitRate)
 {
-    bitRate = SX1231H_F_XOSC / bitRate;  //Calculate the value to be written to the bit-rate registers in order to achieve the desired bit-rate
+    bitRate = SX1231H_BITRATE_TO_DIVIDER(bitRate);  //Calculate the value to be written to the bit-rate registers in order to achieve the desired bit-rate
 
     uint8_t registerValues[0x00000002];  //Create an array of 2 bytes to use for splitting the contents of the register value across
 
@@ -127,7 +276,7 @@ void setBitRateSX1231H(uint32_t bitRate)
     bitRate >>= 0x00000008;                             //Shift the contents of the bitRate variable to the right by 8 bits
     registerValues[0x00000000] = bitRate & 0x000000FF;  //Write the remaining 8 bits of the calculated bit-rate value into the first index of the array
 
-    interactWithRegistersSX1231H(REGADDR_BITRATE_MSB, registerValues, 0x00000002, 0x00000000);  //Send the configuration bytes to the transceiver IC
+    setRegistersSX1231H(REGADDR_BITRATE_MSB, registerValues, 0x00000002);  //Update the shadow copy of the bit-rate registers
 }
 
 //Set Device Mode Function, puts the transceiver into the desired operating mode
@@ -135,40 +284,18 @@ void setDeviceModeSX1231H(opModeSX1231H_t newMode)
 {
     if (newMode == MODE_RESERVED) return;  //Just leave if trying to set the mode of the transceiver to something invalid
 
-    uint8_t registerValue = newMode << 0x00000002;                                         //Write the value of the newMode enum to the registerValue variable and shift it to the left by 2 bits
-    interactWithRegistersSX1231H(REGADDR_OPMODE, &registerValue, 0x00000001, 0x00000000);  //Send the configuration byte to the transceiver IC
+    flushRegistersSX1231H();                                    //Commit any pending configuration before the transceiver changes modes
+    setRegisterSX1231H(REGADDR_OPMODE, newMode << 0x00000002);  //Shift the value of the newMode enum to the left by 2 bits and place it in the shadow copy of RegOpMode
+    flushRegistersSX1231H();                                    //Send the new mode to the transceiver IC
 }
 
 //Set Power Level Function, sets the TX output power strength
 void setPowerLevelSX1231H(uint32_t txPower)
 {
-    uint8_t paLevel = 0x00;               //Create a buffer variable to use for storing the value that will be written to RegPaLevel
-    uint8_t overcurrentRegister = 0x19;   //Create another buffer for storing the value to be written to the overcurrent settings register
-    uint8_t pa1HighPowerRegister = 0x55;  //Make a buffer for the high power settings register of PA1, defaulting to disabling high power mode
-    uint8_t pa2HighPowerRegister = 0x70;  //Make a buffer for the high power settings register of PA2, defaulting to disabling high power mode
-
-    if (txPower > 0x00000017) txPower = 0x00000017;  //Force any value of txPower greater than 0x17 back to 0x17 to prevent the offsets from messing up
-
-    if (txPower >= 0x000000008)
-    {
-        paLevel = 0x68 + txPower;  //Enable both PA1 and PA2 when operating in high power mode, setting the output level as requested
-
-        pa1HighPowerRegister = 0x5D;  //Put PA1 into high power mode
-        pa2HighPowerRegister = 0x7C;  //Put PA2 into high power mode
-    }
-    else if (txPower >= 0x00000005)
-    {
-        paLevel = 0x6B + txPower;  //Enable both PA1 and PA2, setting the output accordingly
-    }
-    else if (txPower)
-    {
-        paLevel = 0x4F + txPower;  //Enable PA1, and set the output level accordingly
-    }
-
-    interactWithRegistersSX1231H(REGADDR_PALEVEL, &paLevel, 0x00000001, 0x00000000);               //Write the value of paLevel to the RegPaLevel register on the transceiver IC
-    interactWithRegistersSX1231H(REGADDR_OCP, &overcurrentRegister, 0x00000001, 0x00000000);       //Write the value of overcurrentRegister to the RegOcp register on the transceiver IC
-    interactWithRegistersSX1231H(REGADDR_TESTPA1, &pa1HighPowerRegister, 0x00000001, 0x00000000);  //Write the value of pa1HighPowerRegister to the RegTestPa1 register on the transceiver IC
-    interactWithRegistersSX1231H(REGADDR_TESTPA2, &pa2HighPowerRegister, 0x00000001, 0x00000000);  //Write the value of pa2HighPowerRegister to the RegTestPa2 register on the transceiver IC
+    setRegisterSX1231H(REGADDR_PALEVEL, SX1231H_PALEVEL_VALUE(txPower));  //Place the RegPaLevel value for the requested power level into the shadow copy, enabling PA1 and PA2 as needed
+    setRegisterSX1231H(REGADDR_OCP, SX1231H_OCP_VALUE(txPower));          //Place the overcurrent protection settings for the requested power level into the shadow copy of the RegOcp register
+    setRegisterSX1231H(REGADDR_TESTPA1, SX1231H_TESTPA1_VALUE(txPower));  //Place the high power settings of PA1 into the shadow copy of the RegTestPa1 register
+    setRegisterSX1231H(REGADDR_TESTPA2, SX1231H_TESTPA2_VALUE(txPower));  //Place the high power settings of PA2 into the shadow copy of the RegTestPa2 register
 }
 
 //Get Device Mode Function, returns the current mode that the transceiver is operating in
@@ -185,6 +312,93 @@ opModeSX1231H_t getDeviceModeSX1231H()
 
 
 
+/*****************************
+ *  Register Shadow Functions  *
+ *****************************/
+
+
+//Set Register Function, updates a register within the shadow copy, marking it dirty only when the value actually changes
+void setRegisterSX1231H(uint32_t address, uint8_t value)
+{
+    if (address == REGADDR_FIFO || address >= SX1231H_REGISTER_COUNT) return;  //The FIFO and anything outside of the register map can't be shadowed
+
+    uint32_t word = address >> 0x00000005;                 //Calculate which word of the bitmaps holds the bit for this register
+    uint32_t mask = 0x00000001 << (address & 0x0000001F);  //Calculate the bit within that word that represents this register
+
+    if ((sx1231hShadowValid[word] & mask) && sx1231hShadowRegisters[address] == value) return;  //Leave early when the transceiver already holds this exact value
+
+    sx1231hShadowRegisters[address] = value;  //Store the new value in the shadow copy
+    sx1231hShadowDirty[word] |= mask;         //Mark the register as needing to be written on the next flush
+}
+
+//Set Registers Function, updates a range of consecutive registers within the shadow copy
+void setRegistersSX1231H(uint32_t startAddress, const uint8_t *values, uint32_t length)
+{
+    while (length--) setRegisterSX1231H(startAddress++, *(values++));  //Update each register in the range one at a time
+}
+
+//Flush Registers Function, writes every dirty register in the shadow copy out to the transceiver using as few bursts as possible
+void flushRegistersSX1231H()
+{
+    uint32_t address = 0x00000001;  //Start scanning right after RegFifo, which is never shadowed
+
+    //Scan the entire register map for ranges of dirty registers
+    while (address < SX1231H_REGISTER_COUNT)
+    {
+        //Skip over any register that doesn't need writing
+        if (!(sx1231hShadowDirty[address >> 0x00000005] & (0x00000001 << (address & 0x0000001F))))
+        {
+            address++;
+            continue;
+        }
+
+        uint32_t startAddress = address;  //The burst starts at the first dirty register found
+        uint32_t endAddress = address;    //Keep track of the last dirty register included in the burst
+        uint32_t gap = 0x00000000;        //Count the number of clean registers seen since the last dirty one
+
+        //Extend the burst for as long as the following registers are dirty, or clean but safe to rewrite and followed closely by another dirty register
+        while (++address < SX1231H_REGISTER_COUNT)
+        {
+            uint32_t word = address >> 0x00000005;                 //Calculate which word of the bitmaps holds the bit for this register
+            uint32_t mask = 0x00000001 << (address & 0x0000001F);  //Calculate the bit within that word that represents this register
+
+            if (sx1231hShadowDirty[word] & mask)
+            {
+                endAddress = address;  //Include this register and any clean ones before it in the burst
+                gap = 0x00000000;      //Start counting clean registers again
+            }
+            else if (!(sx1231hShadowValid[word] & mask) || ++gap > SX1231H_FLUSH_MAX_GAP)
+            {
+                break;  //Stop at registers with unknown contents, or once the gap is too large to be worth bridging
+            }
+        }
+
+        interactWithRegistersSX1231H(startAddress, sx1231hShadowRegisters + startAddress, endAddress - startAddress + 0x00000001, 0x00000000);  //Write the whole range to the transceiver in a single burst
+
+        //Mark every register in the burst as written
+        for (address = startAddress; address <= endAddress; address++)
+        {
+            sx1231hShadowValid[address >> 0x00000005] |= 0x00000001 << (address & 0x0000001F);     //The transceiver now matches the shadow copy
+            sx1231hShadowDirty[address >> 0x00000005] &= ~(0x00000001 << (address & 0x0000001F));  //Nothing left to write for this register
+        }
+    }
+}
+
+//Invalidate Shadow Function, forgets everything known about the transceiver's registers, forcing the next write of each one through
+void invalidateShadowSX1231H()
+{
+    uint32_t word = (SX1231H_REGISTER_COUNT + 0x0000001F) >> 0x00000005;  //Start at the end of the bitmaps
+
+    //Clear both bitmaps entirely
+    while (word--)
+    {
+        sx1231hShadowValid[word] = 0x00000000;  //No register is known to match the transceiver anymore
+        sx1231hShadowDirty[word] = 0x00000000;  //Nothing is waiting to be written
+    }
+}
+
+
+
 /*****************************************
  *  Transceiver Data Exchange Functions  *
  *****************************************/
@@ -193,6 +407,47 @@ opModeSX1231H_t getDeviceModeSX1231H()
 //Interact With Registers Functions, reads/writes to the registers in the transceiver at the given start address using/into dataBytes 
 void interactWithRegistersSX1231H(uint32_t startAddress, uint8_t *dataBytes, uint32_t bufferLength, uint32_t readMode)
 {
+#ifdef SX1231H_MEASURE_SPI_CYCLES
+    uint32_t startCount = _CP0_GET_COUNT();  //Take note of the CP0 Count at the start of the transfer
+#endif
+
+    beginTransactionSX1231H(startAddress, readMode);                      //Select the transceiver and send it the start address
+    transferBytesSX1231H(dataBytes, bufferLength, readMode, 0xFFFFFFFF);  //Exchange the data bytes, releasing the SS line once done
+
+#ifdef SX1231H_MEASURE_SPI_CYCLES
+    sx1231hTransferCycles = _CP0_GET_COUNT() - startCount;  //Record how long the transfer took
+#endif
+}
+
+//Write Segments Function, writes several separate buffers to consecutive addresses starting at startAddress within a single chip-select window
+void writeSegmentsSX1231H(uint32_t startAddress, const segmentSX1231H_t *segments, uint32_t segmentCount)
+{
+    if (!segmentCount) return;  //Leave early when there is nothing to write, otherwise the SS line would be left asserted
+
+#ifdef SX1231H_MEASURE_SPI_CYCLES
+    uint32_t startCount = _CP0_GET_COUNT();  //Take note of the CP0 Count at the start of the transfer
+#endif
+
+    beginTransactionSX1231H(startAddress, 0x00000000);  //Select the transceiver and send it the start address with the write flag set
+
+    //Stream each segment straight out of its own buffer, only releasing the SS line after the last one
+    while (segmentCount--)
+    {
+        transferBytesSX1231H((uint8_t *) segments->bytes, segments->length, 0x00000000, !segmentCount);  //Write the next segment to the transceiver
+        segments++;                                                                                    //Move on to the next segment descriptor
+    }
+
+#ifdef SX1231H_MEASURE_SPI_CYCLES
+    sx1231hTransferCycles = _CP0_GET_COUNT() - startCount;  //Record how long the transfer took
+#endif
+}
+
+//Begin Transaction Function, selects the transceiver and sends the start address along with the read/write flag
+void beginTransactionSX1231H(uint32_t startAddress, uint32_t readMode)
+{
+    PROFILE_ENTER(PROBE_SPI_TRANSACTION);  //Start timing the transaction from the moment the transceiver is selected
+    acquirePeripheral(PERIPHERAL_SPI1);    //Power SPI1 up for as long as the transceiver is selected
+
     while (SPI1CON & 0x00000800);  //Wait until the SPI1 peripheral is in idle mode before starting the data transaction
 
     startAddress |= 0x00000080;                //Force-set Bit-7 of the startAddress variable to indicate the assumed write operation
@@ -204,7 +459,27 @@ void interactWithRegistersSX1231H(uint32_t startAddress, uint8_t *dataBytes, uin
     while (SPI1STAT & 0x00000800);  //Wait until the SPI2 peripheral is no longer busy before continuing
     SPI1BUF;                        //Read from the SPI2 peripherals input buffer to clear it
     SPI1STATCLR = 0x00000040;       //Clear the Read Buffer Overflow flag in the SPI1 status register
-    
+}
+
+//Transfer Bytes Function, exchanges bytes with the transceiver within an already open transaction, optionally releasing the SS line afterwards
+void transferBytesSX1231H(uint8_t *dataBytes, uint32_t bufferLength, uint32_t readMode, uint32_t releaseWhenDone)
+{
+    //Hand longer transfers over to the DMA, idling the CPU until the completion interrupt releases the SS line
+    if (bufferLength >= SX1231H_DMA_THRESHOLD)
+    {
+        startBlockTransferSPI(dataBytes, (readMode) ? dataBytes : 0x00000000, bufferLength, (releaseWhenDone) ? &releaseChipSelectSX1231H : 0x00000000);  //Stream the data through SPI1, sending the buffer's old contents as filler bytes when reading
+        waitWhileBusy(&transferActiveSPI);                                                                                                                //Keep the CPU in IDLE mode until the transfer completes
+        return;
+    }
+
+    pollBytesSX1231H(dataBytes, bufferLength, readMode);  //Shorter transfers are cheaper to poll through
+
+    if (releaseWhenDone) releaseChipSelectSX1231H();  //Bring the SS line back up to its idle state when this was the final part of the transaction
+}
+
+//Poll Bytes Function, exchanges bytes with the transceiver one at a time without the DMA, safe to use from within interrupts
+void pollBytesSX1231H(uint8_t *dataBytes, uint32_t bufferLength, uint32_t readMode)
+{
     //Perform the data exchange for the size of the provided buffer
     while (bufferLength--)
     {
@@ -230,8 +505,14 @@ void interactWithRegistersSX1231H(uint32_t startAddress, uint8_t *dataBytes, uin
             SPI1BUF;  //Clear the SPI1 receive buffer and its associated flags by reading from the SPI1BUF register
         }
     }
+}
 
-    LATBSET = 0x00001000;  //Clear RB12 to bring the SS line back up to its idle state of logic HIGH
+//Release Chip Select Function, brings the SS line of the transceiver back up to end the current SPI transaction
+void releaseChipSelectSX1231H()
+{
+    LATBSET = 0x00001000;                 //Set RB12 to bring the SS line back up to its idle state of logic HIGH
+    releasePeripheral(PERIPHERAL_SPI1);   //SPI1 is no longer needed until the transceiver is next selected
+    PROFILE_EXIT(PROBE_SPI_TRANSACTION);  //Stop timing the transaction now that the transceiver has been deselected
 }
 
 
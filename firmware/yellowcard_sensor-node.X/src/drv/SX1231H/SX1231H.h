@@ -10,6 +10,44 @@
 //Import any libraries used by this file
 #include <xc.h>                //Include the primary header used by the XC32 compiler
 #include "SX1231HRegisters.h"  //Include a list of handy register address definitons for the transceiver
+#include "../HAL.h"            //Include the HAL header which contains the DMA driven SPI interface used for longer transfers and the WAIT helper
+
+
+//Define any constants specific to the transceiver
+#define SX1231H_POR_TIME_MS    0x0000000A  //Time in milliseconds to wait after power on before the transceiver is ready to communicate (datasheet section 7.2.1)
+
+#ifdef SX1231H_FORCE_POLLED
+#undef SX1231H_DMA_THRESHOLD
+#define SX1231H_DMA_THRESHOLD    0xFFFFFFFF  //No transfer is ever long enough to reach the DMA, every byte is polled through as before the DMA was used
+#endif
+
+#ifndef SX1231H_DMA_THRESHOLD
+#define SX1231H_DMA_THRESHOLD    0x00000008  //Transfers of at least this many bytes are handed to the DMA, shorter ones are cheaper to poll through
+#endif
+
+#ifndef SX1231H_FLUSH_MAX_GAP
+#define SX1231H_FLUSH_MAX_GAP    0x00000002  //Largest run of unchanged registers that a flush will rewrite to join two dirty ranges into a single burst
+#endif
+
+#ifndef SX1231H_DIOMAPPING1_VALUE
+#define SX1231H_DIOMAPPING1_VALUE    0x00  //RegDioMapping1 contents, DIO0 = 00 selects PacketSent and DIO1 = 00 selects FifoLevel while in TX mode
+#endif
+
+#ifndef SX1231H_DIO1_INT3R
+#define SX1231H_DIO1_INT3R    0x00000002  //INT3R value selecting the pin that DIO1 of the transceiver is wired to, 0x02 selects RB1
+#endif
+
+//Polled transfers keep the CPU busy for every byte, roughly 64 SYSCLK cycles of spinning on SPIBUSY plus about 12 cycles of loop overhead at 16MHz,
+//so a full 66 byte FIFO load is expected to hold the CPU awake for ~5000 cycles. DMA transfers should cost ~60 cycles of setup plus two short interrupts
+//(~200 cycles total) with the CPU idling in between. These are estimates rather than measurements, define SX1231H_MEASURE_SPI_CYCLES to have the CP0
+//Count of every register and segment transfer recorded in sx1231hTransferCycles and of every FIFO load or refill in sx1231hFifoCycles, then build
+//once more with SX1231H_FORCE_POLLED also defined to measure the same transfers polled through for comparison.
+
+//FifoLevel (DIO1) is raised while the FIFO holds more than SX1231H_FIFO_THRESHOLD bytes, it has to match the FifoThreshold field of RegFifoThresh
+//in sx1231hInit_PacketEngine. Streamed frames are topped up on its falling edge, leaving SX1231H_FIFO_THRESHOLD bytes (~50ms at 2400bps) of
+//margin for the refill interrupt to be serviced before the FIFO runs dry. Segments and the bytes they point to have to stay untouched until
+//waitForTxSX1231H() returns when a frame is larger than the FIFO.
+#define SX1231H_FIFO_THRESHOLD    0x0F
 
 
 //Define any enum types used in this file
@@ -25,15 +63,44 @@ typedef enum
 } modSchemeSX1231H_t;
 
 
+//Define any structs used in this file
+typedef struct
+{
+    const uint8_t *bytes;  //Start of the bytes making up this segment
+    uint32_t length;       //Number of bytes within the segment
+} segmentSX1231H_t;
+
+
 //Define any variables that are external to this file
-extern const uint8_t sx1231hInit_PacketEngine[];  //Stores the default configuration to load into the transceiver to configure the packet engine
+extern const uint8_t sx1231hInit_Radio[];                 //Stores the compile-time generated mode, modulation, bit-rate, deviation and carrier frequency registers
+extern const uint8_t sx1231hInit_PowerAmplifier[];        //Stores the compile-time generated power amplifier registers
+extern const uint8_t sx1231hInit_PacketEngine[];          //Stores the default configuration to load into the transceiver to configure the packet engine
+extern volatile uint32_t sx1231hTxActive;                 //Set while a frame is on its way out of the transceiver, cleared from the INT4 interrupt once PacketSent is raised
+extern volatile uint32_t sx1231hStreamRemaining;          //Number of bytes of the frame being streamed that have yet to be written into the FIFO buffer
+extern void (*sx1231hRestHook)(volatile uint32_t *flag);  //Called to wait out a frame on air until the provided flag is cleared, waitWhileBusy() unless the application supplies a rest that honours its own low-power rules
+#ifdef SX1231H_MEASURE_SPI_CYCLES
+extern volatile uint32_t sx1231hTransferCycles;           //CP0 Count cycles (SYSCLK / 2) taken by the most recent register or segment transfer, including chip-select handling
+extern volatile uint32_t sx1231hFifoCycles;               //CP0 Count cycles (SYSCLK / 2) taken by the most recent FIFO load or refill, including chip-select handling
+#endif
 
 
 //Define prototypes for functions used in the SX1231 source file
-extern void initializeSX1231H(modSchemeSX1231H_t modulation);  //Initialize Transceiver Function, configures the transceiver IC to operate as required for the application
+extern void initializeSX1231H();  //Initialize Transceiver Function, configures the transceiver IC to operate as required for the application
 
-extern void writePacketSX1231H(const uint8_t *payloadBytes,  //Load Packet Function, writes the desired packet to the FIFO buffer on the transceiver IC
+extern void writePacketSX1231H(const uint8_t *payloadBytes,         //Load Packet Function, writes the desired packet to the FIFO buffer on the transceiver IC
                                uint32_t payloadLength);
+extern void writeFrameSX1231H(const segmentSX1231H_t *segments,     //Write Frame Function, streams a frame made up of several separate segments (header first, then the payload pieces) into the FIFO buffer without staging it
+                              uint32_t segmentCount);
+extern void transmitPacketSX1231H(const uint8_t *payloadBytes,      //Transmit Packet Function, sends the desired packet over the air, returning as soon as it has been handed to the transceiver
+                                  uint32_t payloadLength);
+extern void transmitFrameSX1231H(const segmentSX1231H_t *segments,  //Transmit Frame Function, sends a frame made up of several separate segments over the air, returning as soon as it has been handed to the transceiver
+                                 uint32_t segmentCount);
+extern void wakeSX1231H();                                          //Wake Function, moves the transceiver into STBY so that its crystal oscillator has started up by the time the next frame is loaded, it has to be put back to SLEEP after sending
+extern void waitForTxSX1231H();                                     //Wait For TX Function, rests the MCU through sx1231hRestHook until the frame currently on air has been sent
+extern void packetSentSX1231H();                                    //Packet Sent Function, called from the INT4 interrupt when DIO0 signals that the transceiver has finished sending the frame
+extern void refillFifoSX1231H();                                    //Refill FIFO Function, called from the INT3 interrupt when DIO1 signals that the FIFO has drained down to its threshold
+extern void fillFifoSX1231H(uint32_t room,                          //Fill FIFO Function, writes up to room bytes of the frame being streamed into the FIFO buffer within a single chip-select window
+                            uint32_t fromInterrupt);
 
 extern void setCarrierFreqSX1231H(uint32_t freqRF);         //Set Carrier Frequency Function, sets the RF transceiver to tune to the desired carrier frequency
 extern void setFreqDeviationSX1231H(uint32_t freqDev);      //Set Frequency Deviation Function, sets the FSK (de)modulator frequency deviation
@@ -41,12 +108,33 @@ extern void setBitRateSX1231H(uint32_t bitRate);            //Set Bit-Rate Funct
 extern void setDeviceModeSX1231H(opModeSX1231H_t newMode);  //Set Device Mode Function, instructs the RF transceiver to enter the desired mode
 extern void setPowerLevelSX1231H(uint32_t txPower);         //Set Power Level Function, sets the TX output power strength
 
+extern void setRegisterSX1231H(uint32_t address,            //Set Register Function, updates a register within the shadow copy, marking it dirty only when the value actually changes
+                               uint8_t value);
+extern void setRegistersSX1231H(uint32_t startAddress,      //Set Registers Function, updates a range of consecutive registers within the shadow copy
+                                const uint8_t *values,
+                                uint32_t length);
+extern void flushRegistersSX1231H();                        //Flush Registers Function, writes every dirty register in the shadow copy out to the transceiver using as few bursts as possible
+extern void invalidateShadowSX1231H();                      //Invalidate Shadow Function, forgets everything known about the transceiver's registers, forcing the next write of each one through
+
 extern opModeSX1231H_t getDeviceModeSX1231H();  //Get Device Mode Function, returns the current mode that the transceiver is operating in
 
 extern void interactWithRegistersSX1231H(uint32_t startAddress,  //Interact With Registers Functions, reads/writes to the registers in the transceiver at the given start address using/into dataBytes
                                          uint8_t *dataBytes,
                                          uint32_t bufferLength,
                                          uint32_t readMode);
+extern void writeSegmentsSX1231H(uint32_t startAddress,          //Write Segments Function, writes several separate buffers to consecutive addresses starting at startAddress within a single chip-select window
+                                 const segmentSX1231H_t *segments,
+                                 uint32_t segmentCount);
+extern void beginTransactionSX1231H(uint32_t startAddress,       //Begin Transaction Function, selects the transceiver and sends the start address along with the read/write flag
+                                    uint32_t readMode);
+extern void transferBytesSX1231H(uint8_t *dataBytes,             //Transfer Bytes Function, exchanges bytes with the transceiver within an already open transaction, optionally releasing the SS line afterwards
+                                 uint32_t bufferLength,
+                                 uint32_t readMode,
+                                 uint32_t releaseWhenDone);
+extern void pollBytesSX1231H(uint8_t *dataBytes,                 //Poll Bytes Function, exchanges bytes with the transceiver one at a time without the DMA, safe to use from within interrupts
+                             uint32_t bufferLength,
+                             uint32_t readMode);
+extern void releaseChipSelectSX1231H();                          //Release Chip Select Function, brings the SS line of the transceiver back up to end the current SPI transaction
 
 
 #endif
@@ -9,6 +9,32 @@
 
 
 
+/********************
+ *  Radio Settings  *
+ ********************/
+
+#ifndef APPRF_CARRIER_FREQ
+#define APPRF_CARRIER_FREQ                  432950000    //Carrier frequency in Hz
+#endif
+
+#ifndef APPRF_FREQ_DEVIATION
+#define APPRF_FREQ_DEVIATION                600          //Frequency deviation in Hz used by the FSK (de)modulator
+#endif
+
+#ifndef APPRF_BIT_RATE
+#define APPRF_BIT_RATE                      2400         //Bit-rate of the data (de)modulator in bits per second
+#endif
+
+#ifndef APPRF_MODULATION
+#define APPRF_MODULATION                    OOK_F_2BR    //Modulation scheme, any of the modSchemeSX1231H_t values
+#endif
+
+#ifndef APPRF_TX_POWER
+#define APPRF_TX_POWER                      0x16         //TX output power level, using the same 0x00 - 0x17 scale as setPowerLevelSX1231H
+#endif
+
+
+
 /****************************
  *  Packet Engine Settings  *
  ****************************/
@@ -203,6 +229,9 @@
 #define REGADDR_TESTDAGC             0x6F
 #define REGADDR_TESTAFC              0x71
 
+#define SX1231H_REGISTER_COUNT       0x72    //Number of addresses spanned by the register map, from RegFifo up to and including RegTestAfc
+#define SX1231H_FIFO_SIZE            0x42    //Number of bytes the FIFO buffer of the transceiver can hold
+
 
 
 /********************
@@ -211,6 +240,20 @@
 
 #define SX1231H_F_XOSC        32000000      //Frequency of the crystal external to the transceiver IC
 #define SX1231H_F_STEP        61.03515625F  //Step resolution of the PLL used to generate the carrier frequency inside the transceiver
+#define SX1231H_F_STEP_SHIFT  19            //F_STEP is F_XOSC divided by 2^19, allowing frequencies to be converted using only integer math
+
+
+//Register value conversions, these fold away entirely when given constants
+#define SX1231H_FREQ_TO_STEPS(freq)        ((uint32_t) ((((unsigned long long) (freq)) << SX1231H_F_STEP_SHIFT) / SX1231H_F_XOSC))  //Converts a frequency in Hz into a number of F_STEP increments, as used by RegFrf and RegFdev
+#define SX1231H_BITRATE_TO_DIVIDER(rate)   ((uint32_t) (SX1231H_F_XOSC / (rate)))                                                   //Converts a bit-rate in bits per second into the divider used by RegBitrate
+
+#define SX1231H_TX_POWER_LIMIT(power)      (((power) > 0x17) ? 0x17 : (power))  //Bounds a TX power level to the highest level supported by the transceiver
+#define SX1231H_PALEVEL_VALUE(power)       ((SX1231H_TX_POWER_LIMIT(power) >= 0x08) ? (0x68 + SX1231H_TX_POWER_LIMIT(power)) : \
+                                            (SX1231H_TX_POWER_LIMIT(power) >= 0x05) ? (0x6B + SX1231H_TX_POWER_LIMIT(power)) : \
+                                            (SX1231H_TX_POWER_LIMIT(power)) ? (0x4F + SX1231H_TX_POWER_LIMIT(power)) : 0x00)  //Value of RegPaLevel for the given TX power level
+#define SX1231H_TESTPA1_VALUE(power)       ((SX1231H_TX_POWER_LIMIT(power) >= 0x08) ? 0x5D : 0x55)  //Value of RegTestPa1, high power mode is only used at the top power levels
+#define SX1231H_TESTPA2_VALUE(power)       ((SX1231H_TX_POWER_LIMIT(power) >= 0x08) ? 0x7C : 0x70)  //Value of RegTestPa2, high power mode is only used at the top power levels
+#define SX1231H_OCP_VALUE(power)           ((SX1231H_TX_POWER_LIMIT(power) >= 0x08) ? 0x0F : 0x19)  //Value of RegOcp, the 90mA limit has to be turned off whenever high power mode is used
 
 
 #endif
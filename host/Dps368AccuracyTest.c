@@ -0,0 +1,195 @@
+/***************************************************************************************************************
+ *  Yellowcard - Example firmware for the Yellowcard RF Development Kit                                        *
+ * ----------------------------------------------------------------------------------------------------------- *
+ *  Dps368AccuracyTest.c - Checks the integer DPS368 conversions of the node against the receiver's reference  *
+ ***************************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "../firmware/yellowcard_sensor-node.X/src/drv/DPS368/DPS368.c"
+#include "PacketDecoder.h"
+
+
+//Define any constants that are used within this file
+#define TEST_PRES_BOUND        0.2         //Largest difference allowed between the converted pressure and the reference in Pascals over the full raw range
+#define TEST_RANGE_BOUND       0.02        //Largest difference allowed between the converted pressure and the reference in Pascals within the range of the sensor
+#define TEST_TEMP_BOUND        0.01        //Largest difference allowed between the converted temperature and the reference in degrees Celsius
+#define TEST_RANGE_MIN         30000.0     //Lowest pressure the sensor is specified for in Pascals
+#define TEST_RANGE_MAX         120000.0    //Highest pressure the sensor is specified for in Pascals
+#define TEST_CLAMP_LIMIT       21474836.0  //Pressure in Pascals past which the integer conversion clamps its result to what an int32_t holds
+#define TEST_PRES_STRIDE       0x000001FF  //Step between the raw pressures converted, odd so that every low bit pattern gets visited
+#define TEST_TEMP_STRIDE       0x000FFFFF  //Step between the raw temperatures converted alongside each raw pressure
+#define TEST_REGISTER_SPACE    0x00000030  //Number of registers held by the simulated sensor, enough to cover COEF_SRCE
+
+//The coefficients of each set below are written into a simulated register map in the packed layout the sensor uses, then read back through
+//readCalCoeffsDPS368() and initializeDPS368() at every combination of oversampling rates. The pressure is converted across the whole 24-bit raw range
+//at raw temperatures spanning the whole range as well, and compared in double precision against convertToPressureFromDPS368() from PacketDecoder.c,
+//which is what the receiver uses. Results the integer conversion has to clamp to an int32_t are left out. The error grows with the magnitude of the
+//result, so it is bounded separately over the 300 to 1200hPa the sensor is specified for and over everything else the raw range can produce, most of
+//which are pressures that can't physically be measured. The temperature is checked at every raw value.
+//
+//      make test, or cc -std=gnu99 -Ishim -O2 -o dps368test Dps368AccuracyTest.c PacketDecoder.c -lm
+
+
+
+/***************
+ *  Variables  *
+ ***************/
+
+
+//Coefficient Sets
+const decodedCalibration_t testCoefficients[] = {{204, -261, 80469, -54769, -2659, 1253, -10932, 93, -1413, 0, 0},   //Coefficients typical of a DPS368 part
+                                                 {196, -258, 87312, -63718, -3210, 1412, -11875, 142, -1665, 0, 0},  //Steeper pressure slope and stronger temperature dependence
+                                                 {211, -266, 76251, -49203, -2188, 1107, -9806, 61, -1187, 0, 0}};   //Shallower pressure slope and weaker temperature dependence
+
+//Simulated Sensor
+uint8_t testRegisters[TEST_REGISTER_SPACE];  //Register map of the simulated sensor, indexed by register address
+
+
+
+/*******************
+ *  HAL Stand-Ins  *
+ *******************/
+
+
+//Write To I2C Function, accepts every write as the configuration registers make no difference to the conversions
+uint32_t writeToI2C(uint32_t address, const uint8_t *bytes, uint32_t length)
+{
+    (void) address;
+    (void) bytes;
+    (void) length;
+
+    return 0xFFFFFFFF;
+}
+
+//Read From I2C Function, reads the requested number of registers out of the simulated register map starting at the address held in the first byte
+uint32_t readFromI2C(uint32_t address, uint8_t *bytes, uint32_t readLength, uint32_t addressLength)
+{
+    uint32_t registerAddress = bytes[0x00000000];  //Register the read starts at
+
+    (void) address;
+    (void) addressLength;
+
+    if (registerAddress + readLength > TEST_REGISTER_SPACE) return 0x00000000;  //Reads past the end of the register map get no response
+
+    memcpy(bytes, testRegisters + registerAddress, readLength);
+
+    return 0xFFFFFFFF;
+}
+
+
+
+/******************
+ *  Test Helpers  *
+ ******************/
+
+
+//Load Coefficients Function, packs the given coefficients into the COEF registers of the simulated sensor and flags them as ready
+static void loadCoefficients(const decodedCalibration_t *coefficients)
+{
+    uint8_t *coef = testRegisters + 0x00000010;  //Start of the COEF registers
+
+    memset(testRegisters, 0x00, sizeof(testRegisters));
+
+    coef[0x00] = (coefficients->c0 >> 0x00000004) & 0xFF;                                                  //c0 bits 11 to 4
+    coef[0x01] = ((coefficients->c0 << 0x00000004) & 0xF0) | ((coefficients->c1 >> 0x00000008) & 0x0F);    //c0 bits 3 to 0 and c1 bits 11 to 8
+    coef[0x02] = coefficients->c1 & 0xFF;                                                                  //c1 bits 7 to 0
+    coef[0x03] = (coefficients->c00 >> 0x0000000C) & 0xFF;                                                 //c00 bits 19 to 12
+    coef[0x04] = (coefficients->c00 >> 0x00000004) & 0xFF;                                                 //c00 bits 11 to 4
+    coef[0x05] = ((coefficients->c00 << 0x00000004) & 0xF0) | ((coefficients->c10 >> 0x00000010) & 0x0F);  //c00 bits 3 to 0 and c10 bits 19 to 16
+    coef[0x06] = (coefficients->c10 >> 0x00000008) & 0xFF;                                                 //c10 bits 15 to 8
+    coef[0x07] = coefficients->c10 & 0xFF;                                                                 //c10 bits 7 to 0
+    coef[0x08] = (coefficients->c01 >> 0x00000008) & 0xFF;                                                 //c01 bits 15 to 8
+    coef[0x09] = coefficients->c01 & 0xFF;                                                                 //c01 bits 7 to 0
+    coef[0x0A] = (coefficients->c11 >> 0x00000008) & 0xFF;                                                 //c11 bits 15 to 8
+    coef[0x0B] = coefficients->c11 & 0xFF;                                                                 //c11 bits 7 to 0
+    coef[0x0C] = (coefficients->c20 >> 0x00000008) & 0xFF;                                                 //c20 bits 15 to 8
+    coef[0x0D] = coefficients->c20 & 0xFF;                                                                 //c20 bits 7 to 0
+    coef[0x0E] = (coefficients->c21 >> 0x00000008) & 0xFF;                                                 //c21 bits 15 to 8
+    coef[0x0F] = coefficients->c21 & 0xFF;                                                                 //c21 bits 7 to 0
+    coef[0x10] = (coefficients->c30 >> 0x00000008) & 0xFF;                                                 //c30 bits 15 to 8
+    coef[0x11] = coefficients->c30 & 0xFF;                                                                 //c30 bits 7 to 0
+
+    testRegisters[0x08] = 0x80;  //COEF_RDY within MEAS_CFG
+}
+
+//Check Calibration Function, converts every result covered at the oversampling rates of the given calibration, returning the worst errors seen
+static void checkCalibration(const calibrationDPS368_t *calibration, const decodedCalibration_t *reference, double *worstPres, double *worstRange, double *worstTemp)
+{
+    double expected;  //Reference result in Pascals or degrees Celsius
+    double error;     //Absolute difference between the converted result and the reference
+
+    //Every raw temperature, only once per temperature oversampling rate as the pressure one makes no difference to it
+    for (uint32_t rawTemperature = 0x00000000; (rawTemperature <= 0x00FFFFFF) && !reference->presOversample; rawTemperature++)
+    {
+        expected = convertToTempCFromDPS368(reference, rawTemperature);
+        error = fabs((convertToCentiCFromDPS368(calibration, rawTemperature) / 100.0) - expected);
+        if (error > *worstTemp) *worstTemp = error;
+    }
+
+    //The whole raw pressure range at raw temperatures spanning the whole range
+    for (uint32_t rawTemperature = 0x00000000; rawTemperature <= 0x00FFFFFF; rawTemperature += TEST_TEMP_STRIDE)
+    {
+        for (uint32_t rawPressure = 0x00000000; rawPressure <= 0x00FFFFFF; rawPressure += TEST_PRES_STRIDE)
+        {
+            expected = convertToPressureFromDPS368(reference, rawPressure, rawTemperature);
+            if (fabs(expected) >= TEST_CLAMP_LIMIT) continue;  //Leave out what the integer conversion clamps
+
+            error = fabs((convertToCentiPaFromDPS368(calibration, rawPressure, rawTemperature) / 100.0) - expected);
+            if (error > *worstPres) *worstPres = error;
+            if ((error > *worstRange) && (expected >= TEST_RANGE_MIN) && (expected <= TEST_RANGE_MAX)) *worstRange = error;
+        }
+    }
+}
+
+
+
+/*****************
+ *  Entry Point  *
+ *****************/
+
+
+//Main Function, checks every coefficient set at every combination of oversampling rates and reports the worst errors seen
+int main()
+{
+    calibrationDPS368_t calibration;  //Calibration context built by the driver
+    decodedCalibration_t reference;   //The same calibration in the form taken by the reference conversions
+    double worstPres = 0.0;           //Largest pressure error seen in Pascals
+    double worstRange = 0.0;          //Largest pressure error seen within the range of the sensor in Pascals
+    double worstTemp = 0.0;           //Largest temperature error seen in degrees Celsius
+    uint32_t failures = 0x00000000;   //Number of calibrations that failed to load
+
+    for (uint32_t set = 0x00000000; set < sizeof(testCoefficients) / sizeof(testCoefficients[0x00000000]); set++)
+    {
+        loadCoefficients(&testCoefficients[set]);
+        if (!readCalCoeffsDPS368(&calibration)) failures++;
+
+        for (uint32_t oversample = 0x00000000; oversample < 0x00000040; oversample++)
+        {
+            reference = testCoefficients[set];
+            reference.presOversample = oversample >> 0x00000003;
+            reference.tempOversample = oversample & 0x00000007;
+
+            if (!initializeDPS368(&calibration, reference.presOversample, BACKGROUND_1HZ, reference.tempOversample, BACKGROUND_1HZ, 0x00000000, 0x00000000)) failures++;
+            checkCalibration(&calibration, &reference, &worstPres, &worstRange, &worstTemp);
+        }
+    }
+
+    printf("Worst pressure error %.4f Pa within 300-1200hPa (bound %.2f Pa), %.4f Pa over the full raw range (bound %.2f Pa)\n", worstRange, TEST_RANGE_BOUND, worstPres, TEST_PRES_BOUND);
+    printf("Worst temperature error %.4f C (bound %.2f C)\n", worstTemp, TEST_TEMP_BOUND);
+
+    if (failures) printf("%u calibrations failed to load\n", failures);
+    if ((worstRange > TEST_RANGE_BOUND) || (worstPres > TEST_PRES_BOUND)) printf("Pressure strays outside of its bound\n");
+    if (worstTemp > TEST_TEMP_BOUND) printf("Temperature strays outside of its bound\n");
+
+    return (failures || (worstRange > TEST_RANGE_BOUND) || (worstPres > TEST_PRES_BOUND) || (worstTemp > TEST_TEMP_BOUND)) ? 0x00000001 : 0x00000000;
+}
+
+
+
+
+
+
+//END OF FILE
\ No newline at end of file
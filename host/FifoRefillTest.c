@@ -0,0 +1,276 @@
+/*********************************************************************************************************
+ *  Yellowcard - Example firmware for the Yellowcard RF Development Kit                                  *
+ * ----------------------------------------------------------------------------------------------------- *
+ *  FifoRefillTest.c - Streams SX1231H frames into a simulated FIFO draining at the configured bit-rate  *
+ *********************************************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+//Stand in for SPI1STAT, which the driver polls right after every byte it writes into SPI1BUF, so that each byte is captured as it is clocked out
+#define SPI1STAT    captureByteSPI()
+static uint32_t captureByteSPI();
+
+#include "../firmware/yellowcard_sensor-node.X/src/drv/SX1231H/SX1231H.c"
+
+
+//Define any constants that are used within this file
+#define TEST_BYTE_NS         ((uint64_t) 8000000000 / APPRF_BIT_RATE)  //Nanoseconds taken by the transceiver to send a single byte at the configured bit-rate
+#define TEST_MAX_FRAME       0x000000FF                                //Longest frame streamed, the largest length the packet engine supports
+#define TEST_MAX_SEGMENTS    0x00000040                                //Most segments a frame is split into
+#define TEST_NO_REFILL       0xFFFFFFFFFFFFFFFF                        //refillTime while no refill interrupt is pending
+
+//The simulated transceiver starts sending as soon as the FIFO isn't empty (TxStartCondition in RegFifoThresh) and takes a byte out of it every
+//TEST_BYTE_NS, leaving out the preamble and sync word which only add margin. When the FIFO drains down to SX1231H_FIFO_THRESHOLD bytes while
+//INT3 is enabled, refillFifoSX1231H() is called after the interrupt latency under test, with SPI bytes landing in the FIFO instantly. Every frame
+//of 1 to 255 bytes is sent split into pseudo-random segments at latencies up to a byte short of the margin, checking that the FIFO never overflows
+//or runs dry and that the bytes sent over the air match the frame exactly. A latency past the margin then has to be caught as an underrun.
+//
+//      make test, or cc -std=gnu99 -Ishim -o fifotest FifoRefillTest.c
+
+
+
+/***************
+ *  Variables  *
+ ***************/
+
+
+//Simulated FIFO
+uint8_t fifoBytes[SX1231H_FIFO_SIZE];  //Bytes held within the FIFO buffer, as a ring
+uint32_t fifoHead;                     //Index of the next byte to be sent within fifoBytes
+uint32_t fifoLevel;                    //Number of bytes held within the FIFO buffer
+uint32_t fifoOverflows;                //Number of bytes written while the FIFO buffer was already full
+
+//Simulated SPI
+uint32_t spiAddress;  //Address byte of the SPI transaction in progress, write flag included
+
+//Simulated Air
+uint8_t airBytes[TEST_MAX_FRAME];  //Bytes sent over the air for the frame in progress
+uint32_t airLength;                //Number of bytes within airBytes
+
+//Simulated Interrupts
+uint32_t int3Enabled;  //Non-zero while the driver has the INT3 interrupt enabled
+
+//Refill Latencies
+const uint64_t testLatencies[] = {0x00000000, 10000000, 25000000, TEST_BYTE_NS * (SX1231H_FIFO_THRESHOLD - 0x00000001)};  //Refill interrupt latencies under test in ns, up to a byte short of the margin
+
+//HAL Stand-Ins
+volatile uint32_t transferActiveSPI = 0x00000000;  //Never set, block transfers complete before startBlockTransferSPI() returns
+
+
+
+/***************************
+ *  Simulated Transceiver  *
+ ***************************/
+
+
+//Push FIFO Function, adds a byte written over SPI onto the end of the FIFO buffer
+static void pushFifo(uint8_t byte)
+{
+    if (fifoLevel == SX1231H_FIFO_SIZE)
+    {
+        fifoOverflows++;  //The transceiver drops bytes written into a full FIFO buffer
+        return;
+    }
+
+    fifoBytes[(fifoHead + fifoLevel) % SX1231H_FIFO_SIZE] = byte;  //Add the byte after the last one held
+    fifoLevel++;
+}
+
+//Capture Byte SPI Function, stands in for SPI1STAT, taking the byte just written into SPI1BUF as the address or as a byte for the FIFO buffer
+static uint32_t captureByteSPI()
+{
+    //The address is the first byte sent after the SS line is pulled low, every byte after it goes to the FIFO buffer when it is the address written
+    if (LATBCLR)
+    {
+        spiAddress = SPI1BUF;  //Take note of the address being written to
+        LATBCLR = 0x00000000;  //Leave the rest of the transaction to be treated as data
+    }
+    else if (spiAddress == (REGADDR_FIFO | 0x00000080)) pushFifo(SPI1BUF);
+
+    return 0x00000000;  //Never busy
+}
+
+//Update Interrupts Function, picks up whether the driver enabled or disabled INT3 within the call that has just returned
+static void updateInterrupts()
+{
+    if (IEC0SET & 0x00040000) int3Enabled = 0xFFFFFFFF;  //INT3 was enabled
+    if (IEC0CLR & 0x00040000) int3Enabled = 0x00000000;  //INT3 was disabled
+
+    IEC0SET = 0x00000000;
+    IEC0CLR = 0x00000000;
+}
+
+
+
+/*******************
+ *  HAL Stand-Ins  *
+ *******************/
+
+
+//Start Block Transfer SPI Function, hands the bytes straight to the simulated transceiver and completes the transfer right away
+void startBlockTransferSPI(const uint8_t *txBytes, uint8_t *rxBytes, uint32_t length, void (*onComplete)())
+{
+    for (uint32_t byte = 0x00000000; byte < length; byte++)
+    {
+        if (txBytes && (spiAddress == (REGADDR_FIFO | 0x00000080))) pushFifo(txBytes[byte]);  //Only writes to the FIFO buffer are of interest
+        if (rxBytes) rxBytes[byte] = 0x00;                                                      //Registers read back as 0
+    }
+
+    if (onComplete) onComplete();  //Release the SS line when asked to
+}
+
+//Wait While Busy Function, returns straight away as every flag waited on has already been cleared by the simulation
+void waitWhileBusy(volatile uint32_t *busyFlag)
+{
+    (void) busyFlag;
+}
+
+//Acquire Peripheral Function, does nothing as SPI1 is always powered within the simulation
+void acquirePeripheral(peripheralModule_t module)
+{
+    (void) module;
+}
+
+//Release Peripheral Function, does nothing as SPI1 is always powered within the simulation
+void releasePeripheral(peripheralModule_t module)
+{
+    (void) module;
+}
+
+
+
+/*****************
+ *  Test Frames  *
+ *****************/
+
+
+//Send Frame Function, streams the given frame through the driver into the simulated transceiver, returning the number of problems found
+static uint32_t sendFrame(const segmentSX1231H_t *segments, uint32_t segmentCount, const uint8_t *frame, uint32_t frameLength, uint64_t latencyNs, uint32_t *underruns)
+{
+    uint64_t now = 0x00000000;             //Nanoseconds since the transmission started
+    uint64_t refillTime = TEST_NO_REFILL;  //Time at which the pending refill interrupt is serviced
+    uint32_t problems = 0x00000000;        //Number of problems found with the frame
+
+    fifoHead = 0x00000000;
+    fifoLevel = 0x00000000;
+    fifoOverflows = 0x00000000;
+    airLength = 0x00000000;
+
+    transmitFrameSX1231H(segments, segmentCount);  //Load the frame, the transmission starts as soon as the first byte lands in the FIFO buffer
+    updateInterrupts();
+
+    //Send the frame a byte at a time, servicing the refill interrupt whenever it comes due before the next byte is needed
+    while (airLength < frameLength)
+    {
+        if ((refillTime != TEST_NO_REFILL) && (refillTime <= now + TEST_BYTE_NS))
+        {
+            now = refillTime;
+            refillTime = TEST_NO_REFILL;
+            refillFifoSX1231H();  //Service INT3
+            updateInterrupts();
+            continue;
+        }
+
+        if (!fifoLevel)
+        {
+            (*underruns)++;  //The transceiver needed its next byte with nothing left in the FIFO buffer
+            break;
+        }
+
+        now += TEST_BYTE_NS;                          //Clock the next byte out of the FIFO buffer
+        airBytes[airLength++] = fifoBytes[fifoHead];  //Send it over the air
+        fifoHead = (fifoHead + 0x00000001) % SX1231H_FIFO_SIZE;
+        fifoLevel--;
+
+        if ((fifoLevel == SX1231H_FIFO_THRESHOLD) && int3Enabled) refillTime = now + latencyNs;  //Falling edge of FifoLevel on DIO1
+    }
+
+    packetSentSX1231H();  //PacketSent on DIO0
+
+    if (fifoOverflows) problems++;
+    if (airLength != frameLength) return problems + 0x00000001;  //Cut short by an underrun
+    if (memcmp(airBytes, frame, frameLength)) problems++;
+    if (fifoLevel || sx1231hStreamRemaining || int3Enabled) problems++;
+
+    return problems;
+}
+
+//Split Frame Function, splits the frame into pseudo-random segments, leading with a 5 byte header when there is room for one, returning the segment count
+static uint32_t splitFrame(const uint8_t *frame, uint32_t frameLength, segmentSX1231H_t *segments, uint32_t *seed)
+{
+    uint32_t segmentCount = 0x00000000;  //Number of segments made so far
+    uint32_t offset = 0x00000000;        //Offset of the next segment within the frame
+    uint32_t length;                     //Length of the next segment
+
+    while (offset < frameLength)
+    {
+        *seed = (*seed * 1103515245) + 12345;                                   //Step the pseudo-random sequence
+        length = (segmentCount) ? (*seed >> 0x00000010) % 0x00000048 : 0x00000005;  //Anything from empty segments to ones larger than the FIFO buffer
+        if ((segmentCount == TEST_MAX_SEGMENTS - 0x00000001) || (length > frameLength - offset)) length = frameLength - offset;
+
+        segments[segmentCount].bytes = frame + offset;
+        segments[segmentCount].length = length;
+        segmentCount++;
+        offset += length;
+    }
+
+    return segmentCount;
+}
+
+
+
+/*****************
+ *  Entry Point  *
+ *****************/
+
+
+//Main Function, streams every frame length at each latency and then checks that a latency past the margin is caught
+int main()
+{
+    uint8_t frame[TEST_MAX_FRAME];                 //Bytes of the frame being sent
+    segmentSX1231H_t segments[TEST_MAX_SEGMENTS];  //Segments the frame is split into
+    uint32_t segmentCount;                         //Number of segments within segments
+    uint32_t seed = 0x00000001;                    //State of the pseudo-random sequence
+    uint32_t frames = 0x00000000;                  //Number of frames sent
+    uint32_t failures = 0x00000000;                //Number of frames that had problems
+    uint32_t underruns = 0x00000000;               //Number of frames cut short by an underrun
+
+    for (uint32_t latency = 0x00000000; latency < sizeof(testLatencies) / sizeof(testLatencies[0x00000000]); latency++)
+    {
+        for (uint32_t frameLength = 0x00000001; frameLength <= TEST_MAX_FRAME; frameLength++)
+        {
+            for (uint32_t byte = 0x00000000; byte < frameLength; byte++) frame[byte] = (seed = (seed * 1103515245) + 12345) >> 0x00000018;
+
+            if (frameLength & 0x00000001) wakeSX1231H();  //Start every other frame from STBY rather than SLEEP
+            segmentCount = splitFrame(frame, frameLength, segments, &seed);
+
+            if (sendFrame(segments, segmentCount, frame, frameLength, testLatencies[latency], &underruns))
+            {
+                printf("Frame of %u bytes in %u segments failed at %llu us latency\n", frameLength, segmentCount, (unsigned long long) (testLatencies[latency] / 1000));
+                failures++;
+            }
+            frames++;
+        }
+    }
+
+    //The test has to be able to tell when the margin is overrun
+    segmentCount = splitFrame(frame, TEST_MAX_FRAME, segments, &seed);
+    if (!sendFrame(segments, segmentCount, frame, TEST_MAX_FRAME, TEST_BYTE_NS * (SX1231H_FIFO_THRESHOLD + 0x00000002), &underruns) || (underruns != 0x00000001))
+    {
+        printf("An underrun past the refill margin went unnoticed\n");
+        failures++;
+    }
+
+    printf("%u frames streamed at %u bps, margin %llu us, %u failed\n", frames, APPRF_BIT_RATE, (unsigned long long) (TEST_BYTE_NS * SX1231H_FIFO_THRESHOLD / 1000), failures);
+
+    return (failures) ? 0x00000001 : 0x00000000;
+}
+
+
+
+
+
+
+//END OF FILE
@@ -0,0 +1,201 @@
+/*********************************************************************************************
+ *  Yellowcard - Example firmware for the Yellowcard RF Development Kit                      *
+ * ----------------------------------------------------------------------------------------- *
+ *  LogDecoder.c - Decodes the binary log records of the sensor node back into its log text  *
+ *********************************************************************************************/
+
+#include <stdio.h>
+#include "LogDecoder.h"
+
+
+
+/************************
+ *  Record Descriptors  *
+ ************************/
+
+const logRecordDescriptor_t logDecoderDescriptors[] = {{0x03, {0x02, 0x02, 0x04}, 0x01},                     //LOG_RECORD_MEASUREMENT, temperature (centi-C), humidity (centi-%) and pressure (centi-Pa)
+                                                       {0x00, {0x00}, 0x00},                                 //LOG_RECORD_PACKET, the raw bytes of the packet
+                                                       {0x05, {0x04, 0x04, 0x04, 0x04, 0x04}, 0x00},         //LOG_RECORD_TIMING, Timer 1 ticks from the start of the cycle to each of its stages
+                                                       {0x06, {0x01, 0x04, 0x04, 0x04, 0x04, 0x04}, 0x00},   //LOG_RECORD_CHARGE, clock policy, charge (nC) at each operating point and charge (nC) in SLEEP
+                                                       {0x02, {0x04, 0x04}, 0x00},                           //LOG_RECORD_PROFILE, Count cycles added by a probe and Count cycles taken off every sample
+                                                       {0x00, {0x00}, 0x00}};                                //LOG_RECORD_PROBE, probe, count, min, mean and max (4 bytes each) followed by each histogram bucket (2 bytes each)
+
+
+
+/*******************
+ *  Log Constants  *
+ *******************/
+
+static const char *packetTypeNames[] = {"ACKNOWLEDGE", "EVENT", "MEASURE_REPORT", "RAW_REPORT", "CALIBRATION"};
+static const char *cycleStageLabels[] = {"\n  Results Ready:  ", "\n     Radio Wake:  ", "\n   Frame Loaded:  ", "\n     Frame Sent:  ", "\n       Log Sent:  "};
+static const char *clockPolicyNames[] = {"FIXED", "GOVERNED", "RACE_TO_IDLE"};
+static const char *operatingPointLabels[] = {"\n           1MHz:  ", "\n           4MHz:  ", "\n          16MHz:  ", "\n          40MHz:  "};
+static const char *probeNames[] = {"I2C Transaction", "SPI Transaction", "I2C2 ISR", "DMA0 ISR", "DMA1 ISR", "SPI1 ISR", "Timer1 ISR", "RTCC ISR", "INT3 ISR", "DMA2 ISR", "UART2 ISR",
+                                    "INT4 ISR", "Change Notice ISR"};
+static const char *probeStatisticLabels[] = {"\n          Count:  ", "\n            Min:  ", "\n           Mean:  ", "\n            Max:  "};
+
+
+
+/*********************
+ *  Record Decoding  *
+ *********************/
+
+
+//Get Log Record Length Function, returns the length of the whole record from its header, at least LOG_RECORD_HEADER_LENGTH bytes have to be available
+size_t getLogRecordLength(const uint8_t *recordBytes)
+{
+    return LOG_RECORD_HEADER_LENGTH + recordBytes[0x00000002] + LOG_RECORD_CRC_LENGTH;  //Header, payload and CRC
+}
+
+//Decode Log Record Function, extracts the fields of a record after checking its sync byte, type, payload length and CRC
+uint32_t decodeLogRecord(const uint8_t *recordBytes, size_t receivedLength, decodedLogRecord_t *record)
+{
+    const logRecordDescriptor_t *descriptor;                          //Layout of the payload of the record
+    const uint8_t *payload = recordBytes + LOG_RECORD_HEADER_LENGTH;  //Next byte of the payload to decode
+    size_t recordLength;                                              //Length of the whole record as given by its header
+    uint32_t fieldBytes = 0x00000000;                                 //Number of payload bytes taken up by the fields
+
+    if (receivedLength < LOG_RECORD_HEADER_LENGTH) return 0x00000000;                                                      //Leave when there isn't even a whole header to decode
+    if ((recordBytes[0x00000000] != LOG_RECORD_SYNC) || (recordBytes[0x00000001] >= LOG_RECORD_COUNT)) return 0x00000000;  //Leave when this isn't the start of a record
+    recordLength = getLogRecordLength(recordBytes);                                                                        //Find how long the record claims to be
+    if (receivedLength < recordLength) return 0x00000000;                                                                  //Leave when the record was cut short of the length it claims
+
+    //Check the CRC before trusting anything else within the record
+    if (calculateLogCRC16(recordBytes + 0x00000001, recordLength - LOG_RECORD_CRC_LENGTH - 0x00000001) !=
+        ((recordBytes[recordLength - 0x00000002] << 0x00000008) | recordBytes[recordLength - 0x00000001])) return 0x00000000;
+
+    descriptor = &logDecoderDescriptors[recordBytes[0x00000001]];                                                          //Pick the layout of the payload from the type of the record
+    for (uint32_t field = 0x00000000; field < descriptor->fieldCount; field++) fieldBytes += descriptor->fieldWidths[field];  //Add up the widths of its fields
+    if (descriptor->fieldCount && (recordBytes[0x00000002] != fieldBytes)) return 0x00000000;                                //Fixed layouts have to match their descriptor exactly
+
+    record->type = recordBytes[0x00000001];                                                                                                                    //Type of the record
+    record->timestamp = ((uint32_t) recordBytes[0x00000003] << 0x00000018) | (recordBytes[0x00000004] << 0x00000010) | (recordBytes[0x00000005] << 0x00000008) | recordBytes[0x00000006];  //Timestamp, MSB first
+    record->fieldCount = descriptor->fieldCount;                                                                                                               //Number of fields that follow
+    record->bytes = descriptor->fieldCount ? NULL : payload;                                                                                                   //Records without fields carry their whole payload as raw bytes
+    record->byteCount = descriptor->fieldCount ? 0x00000000 : recordBytes[0x00000002];                                                                         //Number of raw bytes carried
+
+    //Pull each field out MSB first, sign extending the ones that are signed
+    for (uint32_t field = 0x00000000; field < descriptor->fieldCount; field++)
+    {
+        uint32_t width = descriptor->fieldWidths[field];  //Width of the field in bytes
+        uint64_t value = 0x00000000;                      //Value of the field being put together
+
+        for (uint32_t byte = 0x00000000; byte < width; byte++) value = (value << 0x00000008) | *payload++;  //Shift in each byte of the field
+
+        //Take the weight of the sign bit off negative values of signed fields
+        if ((descriptor->signedFields & (0x00000001 << field)) && (value >> ((width << 0x00000003) - 0x00000001))) value -= (uint64_t) 0x00000001 << (width << 0x00000003);
+
+        record->fields[field] = (int64_t) value;  //Store the finished field
+    }
+
+    return 0xFFFFFFFF;  //Return a non-negative value to indicate the record was decoded
+}
+
+//Format Log Record Function, writes the text the node would have logged for the record into the provided buffer, returning its length
+size_t formatLogRecord(const decodedLogRecord_t *record, char *text, size_t textSize)
+{
+    const int64_t *fields = record->fields;  //Fields of the record
+    size_t textLength = 0x00000000;          //Length of the text written so far
+    int64_t magnitude;                       //Magnitude of the temperature, the sign is written separately
+    uint32_t total;                          //Total charge drawn across the cycle
+    uint32_t probe;                          //Probe a probe record belongs to
+
+    //Appends onto the text, keeping textLength within the buffer
+    #define APPEND(...)    (textLength += snprintf(text + ((textLength < textSize) ? textLength : 0x00000000), (textLength < textSize) ? textSize - textLength : 0x00000000, __VA_ARGS__))
+
+    switch (record->type)
+    {
+        //The fractional digits of the temperature are written without zero padding, exactly as the node does
+        case LOG_RECORD_MEASUREMENT:
+            magnitude = (fields[0x00000000] < 0x00000000) ? -fields[0x00000000] : fields[0x00000000];
+            APPEND("\n\n\n\nMeasurement\n  Temperature:  %s%u", (fields[0x00000000] < 0x00000000) ? "-" : "", (uint32_t) (magnitude / 0x00000064));
+            if (magnitude % 0x00000064) APPEND(".%u", (uint32_t) (magnitude % 0x00000064));
+            APPEND(" C\n     Humidity:  %u %%\n     Pressure:  %u Pa", (uint32_t) ((fields[0x00000001] + 0x00000032) / 0x00000064), (uint32_t) ((int32_t) fields[0x00000002] / 0x00000064));
+            break;
+
+        case LOG_RECORD_PACKET:
+            if (record->byteCount < 0x00000005) return 0x00000000;  //Not even a whole packet header to log
+            APPEND("\n\nPacket\n   Length:  %u\n  Address:  %u\n     Type:  %s\n  Frame #:  %u\n      Raw: ", record->bytes[0x00000000], record->bytes[0x00000001],
+                   (record->bytes[0x00000002] < sizeof(packetTypeNames) / sizeof(packetTypeNames[0x00000000])) ? packetTypeNames[record->bytes[0x00000002]] : "UNKNOWN",
+                   (record->bytes[0x00000003] << 0x00000008) | record->bytes[0x00000004]);
+            for (uint32_t byte = 0x00000000; byte < record->byteCount; byte++) APPEND(" %02X", record->bytes[byte]);
+            break;
+
+        //Timer 1 ticks (1/32768s) are converted into microseconds by multiplying by 15625/512, the same as the node does
+        case LOG_RECORD_TIMING:
+            APPEND("\n\n\n\nPrevious Cycle (us)");
+            for (uint32_t stage = 0x00000000; stage < record->fieldCount; stage++) APPEND("%s%u", cycleStageLabels[stage], (uint32_t) (((uint64_t) fields[stage] * 0x3D09) >> 0x00000009));
+            break;
+
+        case LOG_RECORD_CHARGE:
+            APPEND("\n\n\n\nPrevious Cycle Charge (nC)\n         Policy:  %s", (fields[0x00000000] < 0x00000003) ? clockPolicyNames[fields[0x00000000]] : "UNKNOWN");
+            total = (uint32_t) fields[0x00000005];  //The node adds the charge in SLEEP onto the charge at each operating point
+            for (uint32_t point = 0x00000000; point < 0x00000004; point++)
+            {
+                APPEND("%s%u", operatingPointLabels[point], (uint32_t) fields[point + 0x00000001]);
+                total += (uint32_t) fields[point + 0x00000001];
+            }
+            APPEND("\n          Sleep:  %u\n          Total:  %u", (uint32_t) fields[0x00000005], total);
+            break;
+
+        case LOG_RECORD_PROFILE:
+            APPEND("\n\n\n\nProbe Profile (Count cycles)\n     Probe Cost:  %u\n   Bias Removed:  %u", (uint32_t) fields[0x00000000], (uint32_t) fields[0x00000001]);
+            break;
+
+        //The probe is followed by four 4 byte statistics and then the 2 byte buckets of the histogram, all MSB first
+        case LOG_RECORD_PROBE:
+            if (record->byteCount != 0x00000011 + (LOG_HISTOGRAM_BUCKETS << 0x00000001)) return 0x00000000;  //Not the layout the node sends
+            probe = record->bytes[0x00000000];
+            if (probe < LOG_TASK_PROBES) APPEND("\n\nTask %u", probe);
+            else APPEND("\n\n%s", (probe - LOG_TASK_PROBES < sizeof(probeNames) / sizeof(probeNames[0x00000000])) ? probeNames[probe - LOG_TASK_PROBES] : "Unknown Probe");
+            for (uint32_t value = 0x00000000; value < 0x00000004; value++)
+            {
+                const uint8_t *valueBytes = record->bytes + 0x00000001 + (value << 0x00000002);  //Bytes of the statistic
+
+                APPEND("%s%u", probeStatisticLabels[value], ((uint32_t) valueBytes[0x00000000] << 0x00000018) | (valueBytes[0x00000001] << 0x00000010) | (valueBytes[0x00000002] << 0x00000008) | valueBytes[0x00000003]);
+            }
+            APPEND("\n      Histogram: ");
+            for (uint32_t bucket = 0x00000000; bucket < LOG_HISTOGRAM_BUCKETS; bucket++) APPEND(" %u", (record->bytes[0x00000011 + (bucket << 0x00000001)] << 0x00000008) | record->bytes[0x00000012 + (bucket << 0x00000001)]);
+            break;
+
+        default:
+            return 0x00000000;  //Unknown records have no text
+    }
+
+    #undef APPEND
+
+    return textLength;  //Return the length of the text, which was cut short when it is textSize or more
+}
+
+
+
+/***********************
+ *  Utility Functions  *
+ ***********************/
+
+
+//Calculate Log CRC16 Function, returns the CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF) of the provided bytes
+uint16_t calculateLogCRC16(const uint8_t *bytes, size_t length)
+{
+    uint16_t crc = 0xFFFF;  //Start from the initial value of the CRC
+
+    while (length--)
+    {
+        crc ^= *bytes++ << 0x00000008;  //Bring the next byte into the top of the CRC
+
+        //Shift the byte through the CRC one bit at a time, applying the polynomial whenever a one falls out of the top
+        for (uint32_t bit = 0x00000008; bit; bit--)
+        {
+            crc = (crc & 0x8000) ? (crc << 0x00000001) ^ 0x1021 : crc << 0x00000001;
+        }
+    }
+
+    return crc;  //Return the calculated CRC
+}
+
+
+
+
+
+
+//END OF FILE
\ No newline at end of file
@@ -0,0 +1,86 @@
+/****************************************************************************************************
+ *  Yellowcard - Example firmware for the Yellowcard RF Development Kit                             *
+ * ------------------------------------------------------------------------------------------------ *
+ *  LogDecoder.h - Receiver side decoding of the binary log records sent by the sensor node's UART  *
+ ****************************************************************************************************/
+
+#ifndef _LOG_DECODER_H_
+#define _LOG_DECODER_H_
+
+//Import any libraries used by this file
+#include <stdint.h>  //Include the fixed width integer types, the record fields are decoded into these
+#include <stddef.h>  //Include the standard definitions, provides size_t for the length of the received stream
+
+
+//Define any constants related to the record framing, these have to match Logging.h of the sensor node firmware
+#define LOG_RECORD_SYNC             0xA5
+#define LOG_RECORD_HEADER_LENGTH    0x00000007
+#define LOG_RECORD_CRC_LENGTH       0x00000002
+#define LOG_RECORD_MAX_FIELDS       0x00000006
+
+//Define any constants related to the profiler records, these have to match PROFILER_TASK_PROBES and PROFILER_HISTOGRAM_BUCKETS in Profiler.h
+#define LOG_TASK_PROBES          0x00000008
+#define LOG_HISTOGRAM_BUCKETS    0x00000010
+
+//Plain C99 with no dependencies, meant for whatever is listening to the UART of a node built with LOG_BINARY. Records are framed as below, with
+//multi-byte values MSB first and the CRC being the CRC-16/CCITT-FALSE of everything after the sync byte. decodeLogRecord() checks a single record,
+//formatLogRecord() turns it back into the exact text the node logs when built without LOG_BINARY. LogDecoderTool.c wraps both into a filter that
+//reads the raw stream from stdin, resyncing on the next sync byte after anything that fails its checks, and writes the text to stdout:
+//
+//      [0xA5] [type] [payload length] [timestamp (4)] [payload ...] [CRC (2)]
+//
+//      cc -std=c99 -o logdecoder LogDecoderTool.c LogDecoder.c
+
+
+//Define any enums used within this file
+typedef enum
+{
+    LOG_RECORD_MEASUREMENT, LOG_RECORD_PACKET, LOG_RECORD_TIMING, LOG_RECORD_CHARGE, LOG_RECORD_PROFILE, LOG_RECORD_PROBE, LOG_RECORD_COUNT
+} logRecordType_t;
+
+
+//Define any structs used within this file
+typedef struct
+{
+    uint8_t fieldCount;                          //Number of fields making up the payload, 0 for records carrying a run of raw bytes instead
+    uint8_t fieldWidths[LOG_RECORD_MAX_FIELDS];  //Width of each field in bytes
+    uint8_t signedFields;                        //Bit mask of the fields holding 2's complement values, bit 0 being the first field
+} logRecordDescriptor_t;
+
+typedef struct
+{
+    uint8_t type;                           //logRecordType_t of the record
+    uint32_t timestamp;                     //Scheduler time of the node in Timer 1 ticks (1/32768s) at which the record was built
+    uint32_t fieldCount;                    //Number of fields held within fields
+    int64_t fields[LOG_RECORD_MAX_FIELDS];  //Value of each field, sign extended for signed fields
+    const uint8_t *bytes;                   //Raw bytes carried by records without fields, points into the received stream
+    uint32_t byteCount;                     //Number of raw bytes
+} decodedLogRecord_t;
+
+
+//Define any variables that are external to this file
+extern const logRecordDescriptor_t logDecoderDescriptors[];  //Stores the layout of the payload of each record, indexed by logRecordType_t
+
+
+//Record Decoding Functions
+extern size_t getLogRecordLength(const uint8_t *recordBytes);     //Get Log Record Length Function, returns the length of the whole record from its header, at least LOG_RECORD_HEADER_LENGTH bytes have to be available
+extern uint32_t decodeLogRecord(const uint8_t *recordBytes,       //Decode Log Record Function, extracts the fields of a record after checking its sync byte, type, payload length and CRC
+                                size_t receivedLength,
+                                decodedLogRecord_t *record);
+extern size_t formatLogRecord(const decodedLogRecord_t *record,  //Format Log Record Function, writes the text the node would have logged for the record into the provided buffer, returning its length
+                              char *text,
+                              size_t textSize);
+
+//Utility Functions
+extern uint16_t calculateLogCRC16(const uint8_t *bytes,  //Calculate Log CRC16 Function, returns the CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF) of the provided bytes
+                                  size_t length);
+
+
+#endif
+
+
+
+
+
+
+//END OF FILE
\ No newline at end of file
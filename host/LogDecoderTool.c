@@ -0,0 +1,85 @@
+/************************************************************************************************
+ *  Yellowcard - Example firmware for the Yellowcard RF Development Kit                         *
+ * -------------------------------------------------------------------------------------------- *
+ *  LogDecoderTool.c - Filter turning the binary log stream of a sensor node into its log text  *
+ ************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "LogDecoder.h"
+
+
+//Define any constants that are used within this file
+#define TOOL_BUFFER_LENGTH    0x00001000  //Bytes of the stream held at once, has to be larger than the longest record
+#define TOOL_TEXT_LENGTH      0x00000400  //Largest text written for a single record
+
+
+
+/*****************
+ *  Entry Point  *
+ *****************/
+
+
+//Main Function, reads the raw stream from stdin and writes the text of every valid record to stdout, reporting how many bytes were skipped on stderr
+int main()
+{
+    static uint8_t streamBuffer[TOOL_BUFFER_LENGTH];  //Bytes of the stream that have been read but not yet decoded
+    char text[TOOL_TEXT_LENGTH];                      //Text of the record being written out
+    decodedLogRecord_t record;                        //Record being decoded
+    size_t bufferLength = 0x00000000;                 //Number of bytes held within streamBuffer
+    size_t offset;                                    //Offset of the next byte to decode within streamBuffer
+    size_t readLength;                                //Number of bytes returned by the latest read
+    size_t recordCount = 0x00000000;                  //Number of records decoded
+    size_t skippedCount = 0x00000000;                 //Number of bytes skipped while looking for the start of a valid record
+
+    do
+    {
+        readLength = fread(streamBuffer + bufferLength, 0x00000001, TOOL_BUFFER_LENGTH - bufferLength, stdin);  //Top the buffer up from the stream
+        bufferLength += readLength;
+        offset = 0x00000000;
+
+        //Work through every record that has been received in full, leaving the rest for after the next read
+        while (offset < bufferLength)
+        {
+            if (streamBuffer[offset] != LOG_RECORD_SYNC)
+            {
+                offset++;        //Skip anything that isn't the start of a record
+                skippedCount++;
+                continue;
+            }
+
+            //Wait for the rest of the record unless the stream has ended
+            if (((bufferLength - offset) < LOG_RECORD_HEADER_LENGTH) || ((bufferLength - offset) < getLogRecordLength(streamBuffer + offset)))
+            {
+                if (readLength) break;
+            }
+
+            //Records that fail their checks only have their sync byte skipped, so a real record starting within them is still found
+            if (!decodeLogRecord(streamBuffer + offset, bufferLength - offset, &record))
+            {
+                offset++;
+                skippedCount++;
+                continue;
+            }
+
+            fwrite(text, 0x00000001, formatLogRecord(&record, text, TOOL_TEXT_LENGTH), stdout);  //Write the text of the record out
+            offset += getLogRecordLength(streamBuffer + offset);                                  //Move onto the byte after the record
+            recordCount++;
+        }
+
+        memmove(streamBuffer, streamBuffer + offset, bufferLength - offset);  //Keep whatever is left of a record that has only partly arrived
+        bufferLength -= offset;
+    }
+    while (readLength);
+
+    fprintf(stderr, "%zu records decoded, %zu bytes skipped\n", recordCount, skippedCount);  //Report how well the stream was received
+
+    return 0x00000000;
+}
+
+
+
+
+
+
+//END OF FILE
\ No newline at end of file
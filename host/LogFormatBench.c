@@ -0,0 +1,424 @@
+/**************************************************************************************************
+ *  Yellowcard - Example firmware for the Yellowcard RF Development Kit                           *
+ * ---------------------------------------------------------------------------------------------- *
+ *  LogFormatBench.c - Times the cursor log formatter against the strlen() based one it replaced  *
+ **************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "Application.h"
+
+
+//Define any constants that are used within this file
+#define BENCH_ITERATIONS    0x001E8480  //Number of logs constructed by each formatter for each log type
+#define BENCH_RUNS          0x00000005  //Number of times each timing is repeated, the fastest run is the one reported
+
+//The text construct functions of the node are built from the same interrupt-free copy of Logging.c as the round-trip test and timed against the
+//formatter they replaced, reproduced below as it stood: uintToDecString() and byteToHexString() writing null terminated strings, with strlen()
+//rescanning the whole log after every field and the templates spliced in at hard-coded offsets. The host C library finds string lengths a word or
+//more at a time, which the MCU doesn't, so the baseline rescans through baselineLength(), a byte at a time. Both formatters have to give the same
+//logs before anything is timed. The fastest of BENCH_RUNS runs is reported for each, on the host rather than the PIC32, so only the ratio carries
+//over to the node.
+//
+//      make bench
+
+
+
+/***************
+ *  Variables  *
+ ***************/
+
+
+//Baseline Templates
+const uint8_t baselineConstants_measurementReport[] = "\n\n\n\nMeasurement\n  Temperature:   C\n     Humidity:   %\n     Pressure:   Pa\0";
+const uint8_t baselineConstants_packet[] = "\n\nPacket\n   Length:  \n  Address:  \n     Type:  \n  Frame #:  \n      Raw: ";
+
+//Baseline Lookups
+const uint8_t *baselineConstants_packetTypeLookup[] = {logConstants_packetType_acknowledge,
+                                                       logConstants_packetType_event,
+                                                       logConstants_packetType_measureReport,
+                                                       logConstants_packetType_rawReport,
+                                                       logConstants_packetType_calibration};
+
+const uint8_t *baselineConstants_cycleStageLookup[] = {logConstants_cycleStage_resultsReady,
+                                                       logConstants_cycleStage_radioWake,
+                                                       logConstants_cycleStage_frameLoaded,
+                                                       logConstants_cycleStage_frameSent,
+                                                       logConstants_cycleStage_logSent};
+
+const uint8_t *baselineConstants_clockPolicyLookup[] = {logConstants_clockPolicy_fixed,
+                                                        logConstants_clockPolicy_governed,
+                                                        logConstants_clockPolicy_raceToIdle};
+
+const uint8_t *baselineConstants_operatingPointLookup[] = {logConstants_operatingPoint_1MHz,
+                                                           logConstants_operatingPoint_4MHz,
+                                                           logConstants_operatingPoint_16MHz,
+                                                           logConstants_operatingPoint_40MHz};
+
+//Bench Inputs
+int32_t benchTemperature = -1234;                                                                //Temperature in hundredths of a degree Celsius, nudged on every log
+const int32_t benchHumidity = 4549;                                                              //Relative humidity in hundredths of a percent
+const int32_t benchPressure = 10132550;                                                          //Pressure in hundredths of a Pascal
+uint8_t benchPacket[PACKET_LENGTH_CALIBRATION] = {PACKET_LENGTH_CALIBRATION, 0x03, CALIBRATION};  //CALIBRATION packet, the longest one logged, filled in with a pattern
+const uint32_t benchStageTicks[CYCLE_STAGE_COUNT] = {0x00000064, 0x00000CCD, 0x00008000, 0x00010000, 0x00061A80};  //Timer 1 ticks at each stage of a cycle
+const uint32_t benchPointCharge[SYSCLK_SPEED_COUNT] = {0x000004D2, 0x00004E20, 0x000493E0, 0x003D0900};            //Charge at each operating point in nC
+volatile uint32_t benchSink;                                                                     //Takes the length of every log so that none of them is optimized away
+
+
+
+/************************
+ *  Firmware Stand-Ins  *
+ ************************/
+
+
+//Get Time Scheduler Function, the text logs carry no time
+uint32_t getTimeScheduler()
+{
+    return 0x00000000;
+}
+
+//Calculate CRC16 Function, only called by the binary records
+uint16_t calculateCRC16(const uint8_t *bytes, uint32_t length)
+{
+    (void) bytes;
+    (void) length;
+
+    return 0x0000;
+}
+
+//Hold Awake Function, nothing to keep awake
+void holdAwake()
+{
+}
+
+//Release Awake Function, nothing to release
+void releaseAwake()
+{
+}
+
+//Start Transmission UART Function, never called as the logs are never queued
+void startTxUART(const uint8_t *bytes, const uint32_t *length)
+{
+    (void) bytes;
+    (void) length;
+}
+
+//Drain Transmission UART Function, never called as nothing is queued
+void drainTxUART()
+{
+}
+
+//Complete Transmission UART Function, never called as nothing is queued
+void completeTxUART()
+{
+}
+
+//Wait While Busy Function, never called as nothing is queued
+void waitWhileBusy(volatile uint32_t *busyFlag)
+{
+    (void) busyFlag;
+}
+
+
+
+/************************
+ *  Baseline Formatter  *
+ ************************/
+
+
+//Baseline Length Function, finds the length of the provided string a byte at a time as the MCU does
+static uint32_t baselineLength(const uint8_t *string)
+{
+    const uint8_t *end = string;  //Character being checked for the null terminator
+
+    while (*end) end++;
+
+    return end - string;
+}
+
+//Unsigned Integer To Decimal String, converts the provided unsigned integer into it's string representation
+static void uintToDecString(uint32_t numberToConvert, uint8_t *stringBuffer)
+{
+    uint32_t counter = 0x00000000;      //Create a variable to use for tracking the digit that's being converted
+    uint8_t tempBuffer[0x0000000B];     //Create an array of 11 bytes to use for storing the generated ASCII digits before copying them into the main byte
+    uint8_t *tempPointer = tempBuffer;  //Initialize a new pointer that points at the tempBuffer array
+
+    //Perform digit separation for the size of the provided buffer
+    while (counter++ <= 0x0000000B)
+    {
+        *(tempPointer++) = (numberToConvert % 0x0000000A) | 0x00000030;  //Modulo the contents of numberToConvert by 10, ORing 0x30 to the result to convert the digit into an ASCII character
+        numberToConvert /= 0x0000000A;                                   //Divide numberToConvert by 10, then put the result back into the numberToConvert variable
+        if (!numberToConvert) break;                                     //Break from the loop whenever numberToConvert becomes empty
+    }
+
+    //Starting from the array index given by the value of the counter variable, start reversing the contents of the character array so that it's legible
+    while (counter--) *(stringBuffer++) = *(--tempPointer);  //Copy the character at the address before the one stored in tempPointer into the next character in the stringBuffer array
+
+    *stringBuffer = 0x00;  //Complete the string by null terminating it with 0x00
+}
+
+//Byte To Hexadecimal String, converts the provided byte into it's hexadecimal string representation
+static void byteToHexString(uint8_t byteToConvert, uint8_t *stringBuffer)
+{
+    *stringBuffer = ((byteToConvert & 0x000000F0) >> 0x00000004) | 0x30;  //Mask out the last 4 bits of the provided byte and create the first ASCII character for it
+    if (*stringBuffer > 0x39) *stringBuffer += 0x07;                      //Add 0x07 to the character if it's supposed to be a letter
+    *(++stringBuffer) = (byteToConvert & 0x0000000F) | 0x30;              //Mask out the first 4 bits of the provided byte and create the second ASCII character for it
+    if (*stringBuffer > 0x39) *stringBuffer += 0x07;                      //Add 0x07 to the character if it's supposed to be a letter
+    *(++stringBuffer) = 0x00;                                             //Complete the string by null terminating it with 0x00
+}
+
+//Baseline Measurement Log Function, constructs a new string to log the provided measurement results
+static uint32_t baselineMeasurementLog(uint8_t *stringBuffer, const int32_t *temperature, const int32_t *humidity, const int32_t *pressure)
+{
+    int32_t dataBuffer;     //Reserve a new 32-bit variable in RAM to use for doing number manipulation while creating the measurement report
+    uint32_t stringLength;  //Create a new variable to use for tracking the length of the string being constructed
+
+    memcpy(stringBuffer, baselineConstants_measurementReport, 0x00000020);  //Copy the first part of the measurement report string into the string buffer
+    stringLength = 0x00000020;                                              //Set the starting length of the string to 32 characters
+    dataBuffer = *temperature;                                              //Store the most recent temperature measurement in the dataBuffer, it is already in hundredths of a degree
+
+    //Handle scenarios where the value of dataBuffer is actually a negative
+    if (dataBuffer < 0x00000000)
+    {
+        stringBuffer[stringLength++] = 0x2D;  //Add a minus character to the string buffer to indicate the negative number
+        dataBuffer = -dataBuffer;             //Force the contents of dataBuffer back into the positives again
+    }
+
+    uintToDecString(dataBuffer / 0x00000064, stringBuffer + stringLength);  //Convert the whole number portion of the temperature into a string and put it into the string buffer
+    stringLength = baselineLength(stringBuffer);                            //Find the new length of the string with the whole number added into it
+    dataBuffer %= 0x00000064;                                               //Modulo the contents of dataBuffer by 100, storing the result back into the dataBuffer variable
+
+    //Only add the decimal point and digits when actually required, otherwise don't bother
+    if (dataBuffer)
+    {
+        stringBuffer[stringLength++] = 0x2E;                                    //Place the decimal point right after the whole number portion
+        uintToDecString(dataBuffer % 0x00000064, stringBuffer + stringLength);  //Convert the decimal portion of the temperature into a string and put it into the string buffer
+        stringLength = baselineLength(stringBuffer);                            //Find the new length of the string with the decimal places added into it
+    }
+
+    memcpy(stringBuffer + stringLength, baselineConstants_measurementReport + 0x00000020, 0x00000013);  //Load the next segment of the report string into the buffer
+    stringLength += 0x00000013;                                                                         //Add the appropriate amount to stringLength to compensate for the added characters
+    uintToDecString((*humidity + 0x00000032) / 0x00000064, stringBuffer + stringLength);                //Convert the measured RH into whole percent as a string, rounded to the nearest, and append it to the string buffer
+    stringLength = baselineLength(stringBuffer);                                                        //Find the new length of the string with the humidity measurement added in
+
+    memcpy(stringBuffer + stringLength, baselineConstants_measurementReport + 0x00000033, 0x00000013);  //Load the next segment of the report string into the buffer
+    stringLength += 0x00000013;                                                                         //Add the appropriate amount to stringLength to compensate for the added characters
+    uintToDecString(*pressure / 0x00000064, stringBuffer + stringLength);                               //Convert the measured pressure into whole Pascals as a string and append it to the string buffer
+    stringLength = baselineLength(stringBuffer);                                                        //Find the new length of the string with the barometric pressure value added
+
+    memcpy(stringBuffer + stringLength, baselineConstants_measurementReport + 0x00000046, 0x00000004);  //Add the final part of the report string into the buffer
+    stringLength += 0x00000004;                                                                         //Add the appropriate amount to stringLength to compensate for the added characters
+
+    return stringLength;  //Leave the function returning the final length of the constructed string
+}
+
+//Baseline Packet Log Function, constructs a new string to log the provided packet bytes
+static uint32_t baselinePacketLog(uint8_t *stringBuffer, const uint8_t *packetBytes)
+{
+    uint32_t stringLength;                          //Create a new variable to use for tracking the length of the string being constructed
+    uint32_t counter = *packetBytes;                //Store the size of the provided packet locally in a new variable to use for later
+    uint32_t dataBuffer = packetBytes[0x00000001];  //Reserve a new 32-bit variable in RAM to use for doing number manipulation while creating the log message
+
+    memcpy(stringBuffer, baselineConstants_packet, 0x00000015);  //Copy the first part of the packet log string into the string buffer
+    stringLength = 0x00000015;                                   //Set the starting length of the string to 22 characters
+    uintToDecString(counter, stringBuffer + stringLength);       //Put the decimal representation of the packet size
+    stringLength = baselineLength(stringBuffer);                 //Find the new length of the string with the packet size added in
+
+    memcpy(stringBuffer + stringLength, baselineConstants_packet + 0x00000015, 0x0000000D);  //Load the next segment of the log string into the buffer
+    stringLength += 0x0000000D;                                                              //Add the appropriate amount to stringLength to compensate for the added characters
+    uintToDecString(dataBuffer, stringBuffer + stringLength);                                //Convert the destination address value into it's decimal form and append it to the string buffer
+    stringLength = baselineLength(stringBuffer);                                             //Find the new length of the string with the destination address added
+
+    const uint8_t *typeString = baselineConstants_packetTypeLookup[packetBytes[0x00000002]];         //Create a pointer that points to the string that represents the packet type
+    memcpy(stringBuffer + stringLength, baselineConstants_packet + 0x00000022, 0x0000000D);          //Load the next segment of the log string into the buffer
+    stringLength += 0x0000000D;                                                                      //Add the appropriate amount to stringLength to compensate for the added characters
+    memcpy(stringBuffer + stringLength, typeString, baselineLength(typeString) + 0x00000001);        //Copy the string constants that represents the packet type into the buffer
+    stringLength = baselineLength(stringBuffer);                                                     //Find the new length of the string with the packet type added
+
+    memcpy(stringBuffer + stringLength, baselineConstants_packet + 0x0000002F, 0x0000000D);  //Load the next segment of the log string into the buffer
+    stringLength += 0x0000000D;                                                              //Add the appropriate amount to stringLength to compensate for the added characters
+    dataBuffer = (packetBytes[0x00000003] << 0x00000008) | packetBytes[0x00000004];          //Combine the next 3 bytes of the packet to calculate the frame number of the packet
+    uintToDecString(dataBuffer, stringBuffer + stringLength);                                //Convert the frame number into it's decimal form and append it to the string buffer
+    stringLength = baselineLength(stringBuffer);                                             //Find the new length of the string with the frame number added
+
+    memcpy(stringBuffer + stringLength, baselineConstants_packet + 0x0000003C, 0x0000000C);  //Load the next segment of the log string into the buffer
+    stringLength += 0x0000000C;                                                              //Add the appropriate amount to stringLength to compensate for the added characters
+
+    //Create a series of hexadecimal translations of the raw packet
+    while (counter--)
+    {
+        stringBuffer[stringLength++] = 0x20;                             //Append a space just before the hexadecimal string
+        byteToHexString(*(packetBytes++), stringBuffer + stringLength);  //Convert the next byte of the packet into it's string hexadecimal representation and append it to stringBuffer
+        stringLength += 0x00000002;                                      //Increment the value of the stringLength variable by 2 to compensate for the 2 newly added bytes
+    }
+
+    stringBuffer[stringLength++] = 0x00;  //Null terminate the end of the string
+    return stringLength;                  //Leave the function returning the final length of the constructed string
+}
+
+//Baseline Timing Log Function, constructs a new string listing how long into the previous measurement cycle each of its stages was reached
+static uint32_t baselineTimingLog(uint8_t *stringBuffer, const uint32_t *stageTicks, uint32_t stageCount)
+{
+    uint32_t stringLength = baselineLength(logConstants_cycleTiming);  //Create a new variable to use for tracking the length of the string being constructed
+    uint32_t labelLength;                                              //Length of the label of the stage being added
+
+    memcpy(stringBuffer, logConstants_cycleTiming, stringLength);  //Copy the heading of the timing log into the string buffer
+
+    //Add a line for each stage, giving the time at which it was reached in microseconds from the start of the cycle
+    for (uint32_t stage = 0x00000000; stage < stageCount; stage++)
+    {
+        labelLength = baselineLength(baselineConstants_cycleStageLookup[stage]);                                          //Find the length of the label for the stage
+        memcpy(stringBuffer + stringLength, baselineConstants_cycleStageLookup[stage], labelLength);                      //Copy the label of the stage into the string buffer
+        stringLength += labelLength;                                                                                      //Add the appropriate amount to stringLength to compensate for the added characters
+        uintToDecString((uint32_t) (((uint64_t) stageTicks[stage] * 0x3D09) >> 0x00000009), stringBuffer + stringLength);  //Convert the Timer 1 ticks (1/32768s) into microseconds, multiplying by 15625/512, and append them to the string buffer
+        stringLength = baselineLength(stringBuffer);                                                                      //Find the new length of the string with the time added in
+    }
+
+    stringBuffer[stringLength++] = 0x00;  //Null terminate the end of the string
+    return stringLength;                  //Leave the function returning the final length of the constructed string
+}
+
+//Baseline Charge Log Function, constructs a new string listing the charge drawn by the previous measurement cycle at each operating point, in SLEEP and in total
+static uint32_t baselineChargeLog(uint8_t *stringBuffer, uint32_t clockPolicy, const uint32_t *pointCharge, uint32_t pointCount, uint32_t sleepCharge)
+{
+    uint32_t stringLength = baselineLength(logConstants_cycleCharge);  //Create a new variable to use for tracking the length of the string being constructed
+    uint32_t labelLength;                                              //Length of the label being added
+    uint32_t totalCharge = sleepCharge;                                //Sum of the charge drawn across the whole cycle
+
+    memcpy(stringBuffer, logConstants_cycleCharge, stringLength);  //Copy the heading of the charge log into the string buffer
+
+    //Name the clock policy that was in use
+    labelLength = baselineLength(logConstants_clockPolicy);                                            //Find the length of the policy label
+    memcpy(stringBuffer + stringLength, logConstants_clockPolicy, labelLength);                        //Copy the policy label into the string buffer
+    stringLength += labelLength;                                                                       //Add the appropriate amount to stringLength to compensate for the added characters
+    labelLength = baselineLength(baselineConstants_clockPolicyLookup[clockPolicy]);                    //Find the length of the name of the policy
+    memcpy(stringBuffer + stringLength, baselineConstants_clockPolicyLookup[clockPolicy], labelLength);  //Copy the name of the policy into the string buffer
+    stringLength += labelLength;                                                                       //Add the appropriate amount to stringLength to compensate for the added characters
+
+    //Add a line for each operating point, giving the charge drawn while running or resting at it
+    for (uint32_t point = 0x00000000; point < pointCount; point++)
+    {
+        labelLength = baselineLength(baselineConstants_operatingPointLookup[point]);                      //Find the length of the label for the operating point
+        memcpy(stringBuffer + stringLength, baselineConstants_operatingPointLookup[point], labelLength);  //Copy the label of the operating point into the string buffer
+        stringLength += labelLength;                                                                      //Add the appropriate amount to stringLength to compensate for the added characters
+        uintToDecString(pointCharge[point], stringBuffer + stringLength);                                 //Convert the charge into a decimal string and append it to the string buffer
+        stringLength = baselineLength(stringBuffer);                                                      //Find the new length of the string with the charge added in
+        totalCharge += pointCharge[point];                                                                //Add the charge onto the total for the cycle
+    }
+
+    //Finish off with the charge drawn in SLEEP and the total for the whole cycle
+    labelLength = baselineLength(logConstants_chargeSleep);                      //Find the length of the SLEEP label
+    memcpy(stringBuffer + stringLength, logConstants_chargeSleep, labelLength);  //Copy the SLEEP label into the string buffer
+    uintToDecString(sleepCharge, stringBuffer + stringLength + labelLength);     //Convert the SLEEP charge into a decimal string and append it to the string buffer
+    stringLength = baselineLength(stringBuffer);                                 //Find the new length of the string with the charge added in
+    labelLength = baselineLength(logConstants_chargeTotal);                      //Find the length of the total label
+    memcpy(stringBuffer + stringLength, logConstants_chargeTotal, labelLength);  //Copy the total label into the string buffer
+    uintToDecString(totalCharge, stringBuffer + stringLength + labelLength);     //Convert the total charge into a decimal string and append it to the string buffer
+    stringLength = baselineLength(stringBuffer);                                 //Find the new length of the string with the total added in
+
+    stringBuffer[stringLength++] = 0x00;  //Null terminate the end of the string
+    return stringLength;                  //Leave the function returning the final length of the constructed string
+}
+
+
+
+/*******************
+ *  Bench Helpers  *
+ *******************/
+
+
+//Construct Log Function, constructs the given log type through either formatter, nudging the temperature each time so the work can't be hoisted
+static uint32_t constructLog(uint8_t *log, uint32_t type, uint32_t baseline)
+{
+    switch (type)
+    {
+        case 0x00000000:
+            benchTemperature += 0x00000007;  //Walk through temperatures with and without fractional digits
+            if (benchTemperature > 3000) benchTemperature = -1234;
+            return (baseline) ? baselineMeasurementLog(log, &benchTemperature, &benchHumidity, &benchPressure) : constructMeasurementLog(log, &benchTemperature, &benchHumidity, &benchPressure);
+
+        case 0x00000001:
+            return (baseline) ? baselinePacketLog(log, benchPacket) : constructPacketLog(log, benchPacket);
+
+        case 0x00000002:
+            return (baseline) ? baselineTimingLog(log, benchStageTicks, CYCLE_STAGE_COUNT) : constructTimingLog(log, benchStageTicks, CYCLE_STAGE_COUNT);
+
+        default:
+            return (baseline) ? baselineChargeLog(log, 0x00000001, benchPointCharge, SYSCLK_SPEED_COUNT, 0x0000022B) : constructChargeLog(log, 0x00000001, benchPointCharge, SYSCLK_SPEED_COUNT, 0x0000022B);
+    }
+}
+
+//Time Formatter Function, constructs the given log type BENCH_ITERATIONS times through either formatter, returning the fastest run in ns per log
+static double timeFormatter(uint32_t type, uint32_t baseline)
+{
+    uint8_t log[LOG_SLOT_SIZE];  //Buffer the logs are constructed into, as large as a slot of the log queue
+    struct timespec start;       //Time at which the run started
+    struct timespec end;         //Time at which the run finished
+    double fastest = 0.0;        //Fastest run so far in ns per log
+
+    for (uint32_t run = 0x00000000; run < BENCH_RUNS; run++)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (uint32_t iteration = 0x00000000; iteration < BENCH_ITERATIONS; iteration++) benchSink += constructLog(log, type, baseline);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        double elapsed = (((end.tv_sec - start.tv_sec) * 1e9) + (end.tv_nsec - start.tv_nsec)) / BENCH_ITERATIONS;  //Time taken by the run in ns per log
+        if (!run || (elapsed < fastest)) fastest = elapsed;
+    }
+
+    return fastest;
+}
+
+
+
+/*****************
+ *  Entry Point  *
+ *****************/
+
+
+//Main Function, checks that both formatters agree on every log type and then times each of them
+int main()
+{
+    const char *names[] = {"Measurement", "Packet (26B)", "Timing", "Charge"};  //Name of each log type timed
+    uint8_t cursorLog[LOG_SLOT_SIZE];                                           //Log constructed by the cursor formatter
+    uint8_t baselineLog[LOG_SLOT_SIZE];                                         //Log constructed by the baseline formatter
+    uint32_t cursorLogLength;                                                   //Length of the log constructed by the cursor formatter
+    uint32_t baselineLogLength;                                                 //Length of the log constructed by the baseline formatter
+    double cursorTime;                                                          //Time taken by the cursor formatter in ns per log
+    double baselineTime;                                                        //Time taken by the baseline formatter in ns per log
+
+    for (uint32_t byte = 0x00000005; byte < PACKET_LENGTH_CALIBRATION; byte++) benchPacket[byte] = byte * 0x00000025;
+
+    //Both formatters have to construct the same logs, or the timings mean nothing
+    for (uint32_t type = 0x00000000; type < 0x00000004; type++)
+    {
+        cursorLogLength = constructLog(cursorLog, type, 0x00000000);
+        benchTemperature -= 0x00000007;  //Give the baseline the same temperature
+        baselineLogLength = constructLog(baselineLog, type, 0xFFFFFFFF);
+
+        if ((cursorLogLength != baselineLogLength) || memcmp(cursorLog, baselineLog, cursorLogLength))
+        {
+            printf("%s logs differ between the two formatters\n", names[type]);
+            return 0x00000001;
+        }
+    }
+
+    printf("%-14s %14s %14s %9s\n", "Log", "strlen() (ns)", "Cursor (ns)", "Speedup");
+
+    for (uint32_t type = 0x00000000; type < 0x00000004; type++)
+    {
+        baselineTime = timeFormatter(type, 0xFFFFFFFF);
+        cursorTime = timeFormatter(type, 0x00000000);
+        printf("%-14s %14.1f %14.1f %8.2fx\n", names[type], baselineTime, cursorTime, baselineTime / cursorTime);
+    }
+
+    return 0x00000000;
+}
+
+
+
+
+
+
+//END OF FILE
\ No newline at end of file
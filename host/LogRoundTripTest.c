@@ -0,0 +1,233 @@
+/*********************************************************************************************************
+ *  Yellowcard - Example firmware for the Yellowcard RF Development Kit                                  *
+ * ----------------------------------------------------------------------------------------------------- *
+ *  LogRoundTripTest.c - Writes the same logs through either the text or the binary construct functions  *
+ *********************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "Application.h"
+
+
+//Define any constants that are used within this file
+#define TEST_MEASUREMENTS    0x00000007  //Number of measurement logs written
+#define TEST_MAX_FRAME       0x000000FF  //Longest frame the transceiver sends, too long for its packet log to fit within a slot
+#define TEST_GUARD_SIZE      0x00000040  //Number of bytes watched past the end of the slot the longest frame is logged into
+#define TEST_GUARD_BYTE      0x5A        //Pattern the guard bytes are filled with
+
+//Built twice against a copy of Logging.c with its interrupt masking taken out, once as it is and once with LOG_BINARY, each build writing the same
+//logs to stdout exactly as DMA 2 would send them. Piping the binary build through the log decoder has to give back the text build byte for byte,
+//which covers every record type, the field layouts on both ends and the text formatting of the decoder against that of the node. A frame of the
+//longest length is also logged into a slot followed by guard bytes, checking that it is cut short within the slot, with its CRC intact in the
+//binary build. Being cut short at different points, it is left out of what is written.
+//
+//      make test, which runs
+//      ./logtext > logtext.out && ./logbinary > logbinary.out && ./logdecoder < logbinary.out | diff -u logtext.out -
+
+
+
+/***************
+ *  Variables  *
+ ***************/
+
+
+//Measurements
+const int32_t testTemperatures[TEST_MEASUREMENTS] = {2105, -512, -1200, 0, 2599, -5, 12500};           //Temperatures in hundredths of a degree Celsius, with and without fractional digits
+const int32_t testHumidities[TEST_MEASUREMENTS] = {4549, 10000, 0, 5050, 123, 49, 50};                  //Relative humidities in hundredths of a percent, either side of rounding up
+const int32_t testPressures[TEST_MEASUREMENTS] = {10132550, 9800000, 12345678, 0, 7, 99, 2147483647};  //Pressures in hundredths of a Pascal
+
+//Packets
+const uint8_t testAcknowledgePacket[] = {0x05, 0x03, 0x00, 0xFF, 0xFF};                                                       //ACKNOWLEDGE of node 3 with the largest frame number
+const uint8_t testEventPacket[] = {0x07, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00};                                                   //RESET event of node 3
+const uint8_t testMeasureReportPacket[] = {0x0B, 0x03, 0x02, 0x01, 0x2C, 0x08, 0x39, 0x2D, 0x9A, 0x9B, 0x00};               //MEASURE_REPORT of node 3
+const uint8_t testRawReportPacket[] = {0x0F, 0x03, 0x03, 0x01, 0x2D, 0x66, 0x0A, 0x8F, 0x3C, 0x7B, 0x1E, 0x04, 0xC2, 0x55, 0x00};  //RAW_REPORT of node 3
+
+//Guarded Slot
+struct
+{
+    uint8_t slot[LOG_SLOT_SIZE];      //Slot the longest frame is logged into
+    uint8_t guard[TEST_GUARD_SIZE];  //Bytes following on from the slot, as the next slot of the log queue would
+} testGuardedSlot;
+
+//Scheduler Stand-In
+uint32_t testTicks = 0x00000000;  //Scheduler time handed out to the binary records, moved on for every record
+
+
+
+/************************
+ *  Firmware Stand-Ins  *
+ ************************/
+
+
+//Get Time Scheduler Function, hands out a different time to every record, the text logs carry no time so it is only there to be ignored
+uint32_t getTimeScheduler()
+{
+    return testTicks += 0x00012345;
+}
+
+//Calculate CRC16 Function, CRC-16/CCITT-FALSE worked out a bit at a time straight from its definition
+uint16_t calculateCRC16(const uint8_t *bytes, uint32_t length)
+{
+    uint16_t crc = 0xFFFF;  //Start from the initial value of the CRC
+
+    while (length--)
+    {
+        crc ^= *bytes++ << 0x00000008;
+        for (uint32_t bit = 0x00000000; bit < 0x00000008; bit++) crc = (crc & 0x8000) ? (crc << 0x00000001) ^ 0x1021 : crc << 0x00000001;
+    }
+
+    return crc;
+}
+
+//Hold Awake Function, nothing to keep awake
+void holdAwake()
+{
+}
+
+//Release Awake Function, nothing to release
+void releaseAwake()
+{
+}
+
+//Start Transmission UART Function, never called as the logs are written straight out of their buffer rather than queued
+void startTxUART(const uint8_t *bytes, const uint32_t *length)
+{
+    (void) bytes;
+    (void) length;
+}
+
+//Drain Transmission UART Function, never called as nothing is queued
+void drainTxUART()
+{
+}
+
+//Complete Transmission UART Function, never called as nothing is queued
+void completeTxUART()
+{
+}
+
+//Wait While Busy Function, never called as nothing is queued
+void waitWhileBusy(volatile uint32_t *busyFlag)
+{
+    (void) busyFlag;
+}
+
+
+
+/******************
+ *  Test Helpers  *
+ ******************/
+
+
+//Check Longest Frame Function, logs a frame of the longest length into the guarded slot, returning whether the log stayed within the slot
+static uint32_t checkLongestFrame()
+{
+    uint8_t frame[TEST_MAX_FRAME] = {TEST_MAX_FRAME, 0x03, RAW_REPORT};  //Frame of the longest length, filled in with a pattern below
+    uint32_t length;                                                     //Length of the log constructed from the frame
+
+    for (uint32_t byte = 0x00000003; byte < TEST_MAX_FRAME; byte++) frame[byte] = byte * 0x0000003B;
+    memset(&testGuardedSlot, TEST_GUARD_BYTE, sizeof(testGuardedSlot));
+
+    length = constructPacketLog(testGuardedSlot.slot, frame);
+
+    for (uint32_t byte = 0x00000000; byte < TEST_GUARD_SIZE; byte++)
+    {
+        if (testGuardedSlot.guard[byte] == TEST_GUARD_BYTE) continue;
+
+        fprintf(stderr, "The log of a %u byte frame ran past the end of its slot\n", TEST_MAX_FRAME);
+        return 0x00000000;
+    }
+
+    if (length > LOG_SLOT_SIZE)
+    {
+        fprintf(stderr, "The log of a %u byte frame claims %u bytes within a %u byte slot\n", TEST_MAX_FRAME, length, LOG_SLOT_SIZE);
+        return 0x00000000;
+    }
+
+#ifdef LOG_BINARY
+    //The record has to carry as much of the frame as fits and still pass its CRC
+    uint16_t crc = calculateCRC16(testGuardedSlot.slot + 0x00000001, length - LOG_RECORD_CRC_LENGTH - 0x00000001);  //CRC of everything after the sync byte
+
+    if ((length != LOG_SLOT_SIZE) || (testGuardedSlot.slot[0x00000002] != length - LOG_RECORD_HEADER_LENGTH - LOG_RECORD_CRC_LENGTH) ||
+        (testGuardedSlot.slot[length - 0x00000002] != (crc >> 0x00000008)) || (testGuardedSlot.slot[length - 0x00000001] != (crc & 0x00FF)))
+    {
+        fprintf(stderr, "The record of a %u byte frame wasn't cut short to a whole %u byte record\n", TEST_MAX_FRAME, LOG_SLOT_SIZE);
+        return 0x00000000;
+    }
+#endif
+
+    return 0xFFFFFFFF;
+}
+
+
+
+/*****************
+ *  Entry Point  *
+ *****************/
+
+
+//Write Log Function, sends the constructed log out as DMA 2 would, leaving off the null terminator of the text logs which the log decoder doesn't write
+static void writeLog(const uint8_t *log, uint32_t length)
+{
+#ifndef LOG_BINARY
+    length--;  //The length of a text log counts its null terminator
+#endif
+
+    fwrite(log, 0x00000001, length, stdout);
+}
+
+//Main Function, constructs and writes out every log that is covered
+int main()
+{
+    uint8_t log[LOG_SLOT_SIZE];                                                                   //Buffer the logs are constructed into, as large as a slot of the log queue
+    uint8_t calibrationPacket[0x0000001A] = {0x1A, 0x03, 0x04, 0xFF, 0xFF};                       //CALIBRATION of node 3, filled in with a pattern below
+    uint32_t stageTicks[CYCLE_STAGE_COUNT] = {0x00000001, 0x00000CCD, 0x00008000, 0x00010000, 0xF0000000};  //Timer 1 ticks, the last one large enough to need the 64-bit conversion
+    uint32_t pointCharge[SYSCLK_SPEED_COUNT] = {0x00000001, 0x000000C8, 0x00007530, 0x003D0900};  //Charge at each operating point in nC
+    profilerProbeStats_t stats;                                                                   //Statistics of the probe being logged
+
+    for (uint32_t measurement = 0x00000000; measurement < TEST_MEASUREMENTS; measurement++)
+    {
+        writeLog(log, constructMeasurementLog(log, &testTemperatures[measurement], &testHumidities[measurement], &testPressures[measurement]));
+    }
+
+    for (uint32_t byte = 0x00000005; byte < sizeof(calibrationPacket); byte++) calibrationPacket[byte] = byte * 0x00000025;
+
+    writeLog(log, constructPacketLog(log, testAcknowledgePacket));
+    writeLog(log, constructPacketLog(log, testEventPacket));
+    writeLog(log, constructPacketLog(log, testMeasureReportPacket));
+    writeLog(log, constructPacketLog(log, testRawReportPacket));
+    writeLog(log, constructPacketLog(log, calibrationPacket));
+    if (!checkLongestFrame()) return 0x00000001;
+
+    writeLog(log, constructTimingLog(log, stageTicks, CYCLE_STAGE_COUNT));
+
+    for (uint32_t clockPolicy = 0x00000000; clockPolicy < 0x00000003; clockPolicy++)
+    {
+        writeLog(log, constructChargeLog(log, clockPolicy, pointCharge, SYSCLK_SPEED_COUNT, clockPolicy * 0x0000022B));
+    }
+
+    writeLog(log, constructProfileLog(log, 0x0000001F, 0x00000006));
+
+    //Every probe with statistics covering the whole range of each field
+    for (uint32_t probe = 0x00000000; probe < PROFILER_PROBE_COUNT; probe++)
+    {
+        stats.count = (probe * 0x000003E8) + 0x00000007;
+        stats.minCycles = probe * 0x00000003;
+        stats.maxCycles = 0xFFFFFFFF - probe;
+        stats.totalCycles = (uint64_t) stats.count * ((probe * 0x00000064) + 0x00000032);
+
+        for (uint32_t bucket = 0x00000000; bucket < PROFILER_HISTOGRAM_BUCKETS; bucket++) stats.histogram[bucket] = (bucket * probe * 0x000003D1) & 0x0000FFFF;
+        stats.histogram[PROFILER_HISTOGRAM_BUCKETS - 0x00000001] = 0xFFFF;
+
+        writeLog(log, constructProbeLog(log, probe, &stats));
+    }
+
+    return 0x00000000;
+}
+
+
+
+
+
+
+//END OF FILE
\ No newline at end of file
@@ -0,0 +1,173 @@
+/**************************************************************************************************
+ *  Yellowcard - Example firmware for the Yellowcard RF Development Kit                           *
+ * ---------------------------------------------------------------------------------------------- *
+ *  PacketDecoder.c - Decodes the packets sent by the sensor node and converts their raw results  *
+ **************************************************************************************************/
+
+#include "PacketDecoder.h"
+
+
+
+/****************************
+ *  DPS368 Scaling Factors  *
+ ****************************/
+
+const uint32_t decoderScalingFactorsDPS368[] = {524288, 1572864, 3670016, 7864320, 253952, 516096, 1040384, 2088960};
+
+
+
+/*********************
+ *  Packet Decoding  *
+ *********************/
+
+
+//Decode Header Function, extracts the header of a packet after checking that the bytes received cover the length it claims
+uint32_t decodeHeader(const uint8_t *packetBytes, size_t receivedLength, decodedHeader_t *header)
+{
+    if (receivedLength < PACKET_LENGTH_HEADER) return 0x00000000;    //Leave when there isn't even a whole header to decode
+    if (receivedLength < packetBytes[0x00000000]) return 0x00000000;  //Leave when the packet was cut short of the length it claims
+
+    header->length = packetBytes[0x00000000];                                                   //Length of the whole packet
+    header->sourceAddress = packetBytes[0x00000001];                                            //Node ID of the sender
+    header->payloadType = packetBytes[0x00000002];                                              //Type of the payload
+    header->frameNumber = (packetBytes[0x00000003] << 0x00000008) | packetBytes[0x00000004];  //Frame number, MSB first
+
+    return 0xFFFFFFFF;  //Return a non-negative value to indicate the header was decoded
+}
+
+//Decode Measure Report Function, extracts the converted measurements from a MEASURE_REPORT packet
+uint32_t decodeMeasureReport(const uint8_t *packetBytes, size_t receivedLength, decodedMeasureReport_t *report)
+{
+    decodedHeader_t header;  //Header of the packet, checked before the payload is touched
+
+    if (!decodeHeader(packetBytes, receivedLength, &header)) return 0x00000000;
+    if ((header.payloadType != MEASURE_REPORT) || (header.length != PACKET_LENGTH_MEASUREREPORT)) return 0x00000000;
+
+    report->temperature = (int16_t) ((packetBytes[0x00000005] << 0x00000008) | packetBytes[0x00000006]);                               //Temperature in hundredths of a degree Celsius
+    report->humidity = packetBytes[0x00000007];                                                                                         //Relative humidity in whole percent
+    report->pressure = (packetBytes[0x00000008] << 0x00000010) | (packetBytes[0x00000009] << 0x00000008) | packetBytes[0x0000000A];  //Pressure in whole Pascals
+
+    return 0xFFFFFFFF;  //Return a non-negative value to indicate the report was decoded
+}
+
+//Decode Raw Report Function, extracts the unconverted sensor results from a RAW_REPORT packet
+uint32_t decodeRawReport(const uint8_t *packetBytes, size_t receivedLength, decodedRawReport_t *report)
+{
+    decodedHeader_t header;  //Header of the packet, checked before the payload is touched
+
+    if (!decodeHeader(packetBytes, receivedLength, &header)) return 0x00000000;
+    if ((header.payloadType != RAW_REPORT) || (header.length != PACKET_LENGTH_RAWREPORT)) return 0x00000000;
+
+    report->rawTemperature = (packetBytes[0x00000005] << 0x00000008) | packetBytes[0x00000006];                                                  //SHT4x temperature ticks
+    report->rawHumidity = (packetBytes[0x00000007] << 0x00000008) | packetBytes[0x00000008];                                                     //SHT4x humidity ticks
+    report->rawPressure = (packetBytes[0x00000009] << 0x00000010) | (packetBytes[0x0000000A] << 0x00000008) | packetBytes[0x0000000B];         //DPS368 pressure result
+    report->rawPresTemperature = (packetBytes[0x0000000C] << 0x00000010) | (packetBytes[0x0000000D] << 0x00000008) | packetBytes[0x0000000E];  //DPS368 temperature result
+
+    return 0xFFFFFFFF;  //Return a non-negative value to indicate the report was decoded
+}
+
+//Decode Calibration Function, extracts the DPS368 coefficients and oversampling rates from a CALIBRATION packet
+uint32_t decodeCalibration(const uint8_t *packetBytes, size_t receivedLength, decodedCalibration_t *calibration)
+{
+    decodedHeader_t header;  //Header of the packet, checked before the payload is touched
+
+    if (!decodeHeader(packetBytes, receivedLength, &header)) return 0x00000000;
+    if ((header.payloadType != CALIBRATION) || (header.length != PACKET_LENGTH_CALIBRATION)) return 0x00000000;
+
+    calibration->presOversample = packetBytes[0x00000005] >> 0x00000004;  //Pressure oversampling rate from the upper nibble
+    calibration->tempOversample = packetBytes[0x00000005] & 0x0000000F;   //Temperature oversampling rate from the lower nibble
+
+    //Extract the coefficients, every one of them was sign extended into whole bytes by the node
+    const uint8_t *field = packetBytes + 0x00000006;
+    calibration->c0 = (int16_t) ((field[0x00000000] << 0x00000008) | field[0x00000001]);
+    calibration->c1 = (int16_t) ((field[0x00000002] << 0x00000008) | field[0x00000003]);
+    calibration->c00 = signExtend((field[0x00000004] << 0x00000010) | (field[0x00000005] << 0x00000008) | field[0x00000006], 0x00000018);
+    calibration->c10 = signExtend((field[0x00000007] << 0x00000010) | (field[0x00000008] << 0x00000008) | field[0x00000009], 0x00000018);
+    calibration->c01 = (int16_t) ((field[0x0000000A] << 0x00000008) | field[0x0000000B]);
+    calibration->c11 = (int16_t) ((field[0x0000000C] << 0x00000008) | field[0x0000000D]);
+    calibration->c20 = (int16_t) ((field[0x0000000E] << 0x00000008) | field[0x0000000F]);
+    calibration->c21 = (int16_t) ((field[0x00000010] << 0x00000008) | field[0x00000011]);
+    calibration->c30 = (int16_t) ((field[0x00000012] << 0x00000008) | field[0x00000013]);
+
+    if ((calibration->presOversample > 0x00000007) || (calibration->tempOversample > 0x00000007)) return 0x00000000;  //Reject oversampling rates that don't exist
+
+    return 0xFFFFFFFF;  //Return a non-negative value to indicate the calibration was decoded
+}
+
+
+
+/*********************
+ *  Data Conversion  *
+ *********************/
+
+
+//Convert To Temperature Celsius From SHT4X, returns the temperature in Celsius from the provided raw SHT4x ticks
+double convertToTempCFromSHT4X(uint16_t rawTemperature)
+{
+    return (rawTemperature * 175.0 / 65535.0) - 45.0;  //Calculate the temperature in Celsius
+}
+
+//Convert To Relative Humidity From SHT4X, returns the relative humidity in % from the provided raw SHT4x ticks
+double convertToRHFromSHT4X(uint16_t rawHumidity)
+{
+    double returnValue = (rawHumidity * 125.0 / 65535.0) - 6.0;  //Calculate the actual humidity as a percentage
+    if (returnValue > 100.0) returnValue = 100.0;  //Bound the calculated relative humidity to an upper limit of 100% RH
+    if (returnValue < 0.0) returnValue = 0.0;      //Bound the calculated relative humidity to a lower limit of 0% RH
+
+    return returnValue;  //Return the calculated relative humidity
+}
+
+//Convert To Temperature Celsius From DPS368, returns the temperature in Celsius from the provided raw DPS368 result
+double convertToTempCFromDPS368(const decodedCalibration_t *calibration, uint32_t rawTemperature)
+{
+    double scaledTemp = (double) signExtend(rawTemperature, 0x00000018) / decoderScalingFactorsDPS368[calibration->tempOversample];  //Calculate Traw_sc
+
+    return (calibration->c0 * 0.5) + (calibration->c1 * scaledTemp);  //Calculate the temperature in Celsius
+}
+
+//Convert To Pressure From DPS368, returns the compensated pressure in Pascals from the provided raw DPS368 results
+double convertToPressureFromDPS368(const decodedCalibration_t *calibration, uint32_t rawPressure, uint32_t rawTemperature)
+{
+    double scaledTemp = (double) signExtend(rawTemperature, 0x00000018) / decoderScalingFactorsDPS368[calibration->tempOversample];  //Calculate Traw_sc
+    double scaledPres = (double) signExtend(rawPressure, 0x00000018) / decoderScalingFactorsDPS368[calibration->presOversample];     //Calculate Praw_sc
+
+    //Calculate the compensated pressure in Pascals as given in the datasheet
+    return calibration->c00 + (scaledPres * (calibration->c10 + (scaledPres * (calibration->c20 + (scaledPres * calibration->c30))))) +
+           (scaledTemp * calibration->c01) + (scaledTemp * scaledPres * (calibration->c11 + (scaledPres * calibration->c21)));
+}
+
+//Convert Raw Report Function, converts every result of a decoded raw report using the calibration of the node that sent it
+uint32_t convertRawReport(const decodedCalibration_t *calibration, const decodedRawReport_t *report, convertedRawReport_t *converted)
+{
+    if (!calibration) return 0x00000000;  //Leave when no calibration has been received from the node yet, the DPS368 results can't be converted without it
+
+    converted->temperature = convertToTempCFromSHT4X(report->rawTemperature);                                          //SHT4x temperature in Celsius
+    converted->humidity = convertToRHFromSHT4X(report->rawHumidity);                                                   //SHT4x relative humidity in %
+    converted->pressure = convertToPressureFromDPS368(calibration, report->rawPressure, report->rawPresTemperature);  //DPS368 compensated pressure in Pascals
+    converted->presTemperature = convertToTempCFromDPS368(calibration, report->rawPresTemperature);                  //DPS368 temperature in Celsius
+
+    return 0xFFFFFFFF;  //Return a non-negative value to indicate the report was converted
+}
+
+
+
+/***********************
+ *  Utility Functions  *
+ ***********************/
+
+
+//Sign Extend Function, returns the provided 2's complement value of the given bit-depth as a signed 32-bit value
+int32_t signExtend(uint32_t value, uint32_t bitDepth)
+{
+    uint32_t signBit = 0x00000001 << (bitDepth - 0x00000001);  //Mask selecting the sign bit of the value
+
+    value &= (signBit << 0x00000001) - 0x00000001;  //Drop anything above the bit-depth
+    return (int32_t) (value ^ signBit) - (int32_t) signBit;  //Flip the sign bit and subtract its weight, leaving negative values negative
+}
+
+
+
+
+
+
+//END OF FILE
\ No newline at end of file
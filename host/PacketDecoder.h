@@ -0,0 +1,124 @@
+/****************************************************************************************
+ *  Yellowcard - Example firmware for the Yellowcard RF Development Kit                 *
+ * ------------------------------------------------------------------------------------ *
+ *  PacketDecoder.h - Receiver side decoding and conversion of the sensor node packets  *
+ ****************************************************************************************/
+
+#ifndef _PACKET_DECODER_H_
+#define _PACKET_DECODER_H_
+
+//Import any libraries used by this file
+#include <stdint.h>  //Include the fixed width integer types, the packet fields are decoded into these
+#include <stddef.h>  //Include the standard definitions, provides size_t for the length of received packets
+
+
+//Define any constants related to packet lengths, these have to match PacketStructures.h of the sensor node firmware
+#define PACKET_LENGTH_HEADER           0x00000005
+#define PACKET_LENGTH_EVENT            0x00000007
+#define PACKET_LENGTH_MEASUREREPORT    0x0000000B
+#define PACKET_LENGTH_RAWREPORT        0x0000000F
+#define PACKET_LENGTH_CALIBRATION      0x0000001A
+
+//Plain C99 with no dependencies beyond libm, meant to be dropped straight into whatever receives the packets from the gateway. Each decode function
+//takes the bytes of a whole packet, header included, and checks both the payload type and the length byte before touching anything. RAW_REPORT
+//packets can only be converted once a CALIBRATION packet has been received from the same node, which it sends after every reset. The conversions
+//follow the SHT4x and DPS368 datasheets in double precision, so the receiver gets the full resolution the sensors have to offer.
+
+
+//Define any enums used within this file
+typedef enum
+{
+    ACKNOWLEDGE = 0x00, EVENT = 0x01, MEASURE_REPORT = 0x02, RAW_REPORT = 0x03, CALIBRATION = 0x04
+} packetPayloadType_t;
+
+
+//Define any structs used within this file
+typedef struct
+{
+    uint8_t length;         //Length of the whole packet in bytes, header included
+    uint8_t sourceAddress;  //Node ID of the sensor node that sent the packet
+    uint8_t payloadType;    //packetPayloadType_t of the payload following the header
+    uint16_t frameNumber;   //Frame number of the packet, incremented by the node for every packet it sends
+} decodedHeader_t;
+
+typedef struct
+{
+    int32_t temperature;  //Temperature in hundredths of a degree Celsius
+    uint32_t humidity;    //Relative humidity in whole percent
+    uint32_t pressure;    //Barometric pressure in whole Pascals
+} decodedMeasureReport_t;
+
+typedef struct
+{
+    uint16_t rawTemperature;      //Temperature ticks of the SHT4x
+    uint16_t rawHumidity;         //Relative humidity ticks of the SHT4x
+    uint32_t rawPressure;         //24-bit pressure result of the DPS368
+    uint32_t rawPresTemperature;  //24-bit temperature result of the DPS368
+} decodedRawReport_t;
+
+typedef struct
+{
+    int32_t c0;               //Sign extended 12-bit c0 coefficient
+    int32_t c1;               //Sign extended 12-bit c1 coefficient
+    int32_t c00;              //Sign extended 20-bit c00 coefficient
+    int32_t c10;              //Sign extended 20-bit c10 coefficient
+    int32_t c01;              //16-bit c01 coefficient
+    int32_t c11;              //16-bit c11 coefficient
+    int32_t c20;              //16-bit c20 coefficient
+    int32_t c21;              //16-bit c21 coefficient
+    int32_t c30;              //16-bit c30 coefficient
+    uint32_t presOversample;  //precisionDPS368_t of the pressure measurements, picks the pressure scaling factor
+    uint32_t tempOversample;  //precisionDPS368_t of the temperature measurements, picks the temperature scaling factor
+} decodedCalibration_t;
+
+typedef struct
+{
+    double temperature;      //Temperature from the SHT4x in Celsius
+    double humidity;         //Relative humidity from the SHT4x in %, bounded to 0-100%
+    double pressure;         //Compensated barometric pressure from the DPS368 in Pascals
+    double presTemperature;  //Temperature from the DPS368 in Celsius
+} convertedRawReport_t;
+
+
+//Define any variables that are external to this file
+extern const uint32_t decoderScalingFactorsDPS368[];  //Stores the DPS368 compensation scaling factors, indexed by precisionDPS368_t
+
+
+//Packet Decoding Functions
+extern uint32_t decodeHeader(const uint8_t *packetBytes,               //Decode Header Function, extracts the header of a packet after checking that the bytes received cover the length it claims
+                             size_t receivedLength,
+                             decodedHeader_t *header);
+extern uint32_t decodeMeasureReport(const uint8_t *packetBytes,        //Decode Measure Report Function, extracts the converted measurements from a MEASURE_REPORT packet
+                                    size_t receivedLength,
+                                    decodedMeasureReport_t *report);
+extern uint32_t decodeRawReport(const uint8_t *packetBytes,            //Decode Raw Report Function, extracts the unconverted sensor results from a RAW_REPORT packet
+                                size_t receivedLength,
+                                decodedRawReport_t *report);
+extern uint32_t decodeCalibration(const uint8_t *packetBytes,          //Decode Calibration Function, extracts the DPS368 coefficients and oversampling rates from a CALIBRATION packet
+                                  size_t receivedLength,
+                                  decodedCalibration_t *calibration);
+
+//Data Conversion Functions
+extern double convertToTempCFromSHT4X(uint16_t rawTemperature);                  //Convert To Temperature Celsius From SHT4X, returns the temperature in Celsius from the provided raw SHT4x ticks
+extern double convertToRHFromSHT4X(uint16_t rawHumidity);                        //Convert To Relative Humidity From SHT4X, returns the relative humidity in % from the provided raw SHT4x ticks
+extern double convertToTempCFromDPS368(const decodedCalibration_t *calibration,  //Convert To Temperature Celsius From DPS368, returns the temperature in Celsius from the provided raw DPS368 result
+                                       uint32_t rawTemperature);
+extern double convertToPressureFromDPS368(const decodedCalibration_t *calibration,  //Convert To Pressure From DPS368, returns the compensated pressure in Pascals from the provided raw DPS368 results
+                                          uint32_t rawPressure,
+                                          uint32_t rawTemperature);
+extern uint32_t convertRawReport(const decodedCalibration_t *calibration,       //Convert Raw Report Function, converts every result of a decoded raw report using the calibration of the node that sent it
+                                 const decodedRawReport_t *report,
+                                 convertedRawReport_t *converted);
+
+//Utility Functions
+extern int32_t signExtend(uint32_t value, uint32_t bitDepth);  //Sign Extend Function, returns the provided 2's complement value of the given bit-depth as a signed 32-bit value
+
+
+#endif
+
+
+
+
+
+
+//END OF FILE
\ No newline at end of file
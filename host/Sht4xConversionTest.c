@@ -0,0 +1,110 @@
+/**********************************************************************************************************
+ *  Yellowcard - Example firmware for the Yellowcard RF Development Kit                                   *
+ * ------------------------------------------------------------------------------------------------------ *
+ *  Sht4xConversionTest.c - Checks the integer SHT4x conversions of the node at every possible raw value  *
+ **********************************************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+
+#define SHT4X_FLOAT_REFERENCE
+#include "../firmware/yellowcard_sensor-node.X/src/drv/SHT4x/SHT4x.c"
+
+
+//Define any constants that are used within this file
+#define TEST_FLOAT_BOUND    0.0051  //Largest difference allowed from the float conversions, half a hundredth from the rounding plus what float loses at 315
+
+//Every one of the 65536 raw values is converted to hundredths of a degree Celsius, of a degree Fahrenheit and of a percent of relative humidity.
+//Each result has to match span * raw / 65535 + offset worked out in double precision and rounded to the nearest hundredth, the humidity bounded
+//to 0-100% first, and has to stay within TEST_FLOAT_BOUND of the float conversions the node used before.
+//
+//      make test, or cc -std=gnu99 -Ishim -O2 -o sht4xtest Sht4xConversionTest.c -lm
+
+
+
+/*******************
+ *  HAL Stand-Ins  *
+ *******************/
+
+
+//Write To I2C Function, never called by the conversions
+uint32_t writeToI2C(uint32_t address, const uint8_t *bytes, uint32_t length)
+{
+    (void) address;
+    (void) bytes;
+    (void) length;
+
+    return 0x00000000;
+}
+
+//Read From I2C Function, never called by the conversions
+uint32_t readFromI2C(uint32_t address, uint8_t *bytes, uint32_t readLength, uint32_t addressLength)
+{
+    (void) address;
+    (void) bytes;
+    (void) readLength;
+    (void) addressLength;
+
+    return 0x00000000;
+}
+
+
+
+/******************
+ *  Test Helpers  *
+ ******************/
+
+
+//Check Result Function, compares a single converted result against the exact and float references, returning whether it matched both
+static uint32_t checkResult(const char *unit, uint32_t raw, int32_t converted, double exact, float reference, double *worstFloat)
+{
+    double floatError = fabs((converted / 100.0) - reference);  //Difference from the float conversion
+
+    if (floatError > *worstFloat) *worstFloat = floatError;
+
+    if ((converted == (int32_t) lround(exact)) && (floatError <= TEST_FLOAT_BOUND)) return 0xFFFFFFFF;
+
+    printf("Raw 0x%04X converted to %d centi-%s, expected %ld with the float version giving %.4f\n", raw, converted, unit, lround(exact), reference);
+
+    return 0x00000000;
+}
+
+
+
+/*****************
+ *  Entry Point  *
+ *****************/
+
+
+//Main Function, converts every raw value with each of the conversions and reports how many didn't match
+int main()
+{
+    uint16_t rawValue;               //Raw value being converted
+    double exactRH;                  //Exact relative humidity in hundredths of a percent, bounded to 0-100%
+    double worstFloat = 0.0;         //Largest difference seen from the float conversions
+    uint32_t failures = 0x00000000;  //Number of results that didn't match
+
+    for (uint32_t raw = 0x00000000; raw <= 0x0000FFFF; raw++)
+    {
+        rawValue = raw;
+
+        exactRH = (SHT4X_SPAN_CENTI_RH * raw / 65535.0) + SHT4X_OFFSET_CENTI_RH;
+        if (exactRH > 10000.0) exactRH = 10000.0;
+        if (exactRH < 0.0) exactRH = 0.0;
+
+        if (!checkResult("C", raw, convertToCentiCFromSHT4X(&rawValue), (SHT4X_SPAN_CENTI_C * raw / 65535.0) + SHT4X_OFFSET_CENTI_C, convertToTempCFromSHT4X(&rawValue), &worstFloat)) failures++;
+        if (!checkResult("F", raw, convertToCentiFFromSHT4X(&rawValue), (SHT4X_SPAN_CENTI_F * raw / 65535.0) + SHT4X_OFFSET_CENTI_F, converttoTempFFromSHT4X(&rawValue), &worstFloat)) failures++;
+        if (!checkResult("RH", raw, convertToCentiRHFromSHT4X(&rawValue), exactRH, convertToRHFromSHT4X(&rawValue), &worstFloat)) failures++;
+    }
+
+    printf("65536 raw values converted to C, F and RH, worst difference from float %.4f (bound %.4f), %u failed\n", worstFloat, TEST_FLOAT_BOUND, failures);
+
+    return (failures) ? 0x00000001 : 0x00000000;
+}
+
+
+
+
+
+
+//END OF FILE
\ No newline at end of file
@@ -0,0 +1,21 @@
+/*************************************************************************
+ *  Yellowcard - Example firmware for the Yellowcard RF Development Kit  *
+ * --------------------------------------------------------------------- *
+ *  attribs.h - Host stand-in for the XC32 interrupt attributes          *
+ *************************************************************************/
+
+#ifndef _SYS_ATTRIBS_H_
+#define _SYS_ATTRIBS_H_
+
+//Define any macros used within this file
+#define __ISR(vector, ipl)    __attribute__ ((used))  //Interrupt handlers become plain functions on the host
+
+
+#endif
+
+
+
+
+
+
+//END OF FILE
\ No newline at end of file
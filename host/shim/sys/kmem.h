@@ -0,0 +1,27 @@
+/*************************************************************************
+ *  Yellowcard - Example firmware for the Yellowcard RF Development Kit  *
+ * --------------------------------------------------------------------- *
+ *  kmem.h - Host stand-in for the XC32 address translation macros       *
+ *************************************************************************/
+
+#ifndef _SYS_KMEM_H_
+#define _SYS_KMEM_H_
+
+//Import any libraries used by this file
+#include <stdint.h>  //Include the fixed width integer types, addresses are truncated down to 32 bits just like on the MCU
+
+
+//Define any macros used within this file
+#define KVA_TO_PA(v)     ((uint32_t) (uintptr_t) (v) & 0x1FFFFFFF)  //Physical address of a virtual one, only ever written into the stand-in SFRs on the host
+#define PA_TO_KVA0(v)    ((v) | 0x80000000)
+#define PA_TO_KVA1(v)    ((v) | 0xA0000000)
+
+
+#endif
+
+
+
+
+
+
+//END OF FILE
\ No newline at end of file
@@ -0,0 +1,53 @@
+/**************************************************************************************************
+ *  Yellowcard - Example firmware for the Yellowcard RF Development Kit                           *
+ * ---------------------------------------------------------------------------------------------- *
+ *  xc.h - Host stand-in for the XC32 device header, builds firmware sources into the host tests  *
+ **************************************************************************************************/
+
+#ifndef _XC_H_
+#define _XC_H_
+
+//Import any libraries used by this file
+#include <stdint.h>  //Include the fixed width integer types, the SFRs are stood in for by these
+#include <stddef.h>  //Include the standard definitions, the firmware relies on XC32 pulling these in
+
+
+//Define any macros standing in for the compiler intrinsics used by the firmware
+#define _CP0_GET_COUNT()     0x00000000  //Count never advances on the host
+#define _CP0_SET_COUNT(x)    ((void) (x))
+
+//Every SFR used by the firmware is a plain zero initialised variable, weak so that each translation unit including this file shares the same one.
+//Nothing reacts to them, so a test stands in for the hardware behind a register it depends on by defining the register as a macro before the
+//firmware source is included. Only SPI1STAT is skipped here when a test has done so, it is polled right after every byte written into SPI1BUF.
+#define SHIM_SFR(name)    volatile uint32_t __attribute__ ((weak)) name
+
+SHIM_SFR(ALRMDATE); SHIM_SFR(ALRMTIME); SHIM_SFR(ANSELB); SHIM_SFR(CFGCONCLR); SHIM_SFR(CFGCONSET); SHIM_SFR(CNCONB); SHIM_SFR(CNENB);
+SHIM_SFR(CNPDBSET); SHIM_SFR(CNSTATB); SHIM_SFR(DCH0CON); SHIM_SFR(DCH0CSIZ); SHIM_SFR(DCH0DSA); SHIM_SFR(DCH0DSIZ); SHIM_SFR(DCH0ECON);
+SHIM_SFR(DCH0INT); SHIM_SFR(DCH0INTCLR); SHIM_SFR(DCH0SSA); SHIM_SFR(DCH0SSIZ); SHIM_SFR(DCH1CON); SHIM_SFR(DCH1CSIZ); SHIM_SFR(DCH1DSA);
+SHIM_SFR(DCH1DSIZ); SHIM_SFR(DCH1ECON); SHIM_SFR(DCH1INT); SHIM_SFR(DCH1INTCLR); SHIM_SFR(DCH1SSA); SHIM_SFR(DCH1SSIZ); SHIM_SFR(DCH2CON);
+SHIM_SFR(DCH2CSIZ); SHIM_SFR(DCH2DAT); SHIM_SFR(DCH2DSA); SHIM_SFR(DCH2DSIZ); SHIM_SFR(DCH2ECON); SHIM_SFR(DCH2ECONSET); SHIM_SFR(DCH2INT);
+SHIM_SFR(DCH2SSA); SHIM_SFR(DCH2SSIZ); SHIM_SFR(DMACON); SHIM_SFR(DMACONCLR); SHIM_SFR(DMACONSET); SHIM_SFR(I2C2BRG); SHIM_SFR(I2C2CON);
+SHIM_SFR(I2C2CONCLR); SHIM_SFR(I2C2CONSET); SHIM_SFR(I2C2RCV); SHIM_SFR(I2C2STAT); SHIM_SFR(I2C2STATCLR); SHIM_SFR(I2C2TRN); SHIM_SFR(IEC0);
+SHIM_SFR(IEC0CLR); SHIM_SFR(IEC0SET); SHIM_SFR(IEC1); SHIM_SFR(IEC1CLR); SHIM_SFR(IEC1SET); SHIM_SFR(IFS0); SHIM_SFR(IFS0CLR); SHIM_SFR(IFS1);
+SHIM_SFR(IFS1CLR); SHIM_SFR(INT3R); SHIM_SFR(INT4R); SHIM_SFR(INTCON); SHIM_SFR(IPC1); SHIM_SFR(IPC10); SHIM_SFR(IPC3); SHIM_SFR(IPC4);
+SHIM_SFR(IPC6); SHIM_SFR(IPC7); SHIM_SFR(IPC8); SHIM_SFR(IPC9); SHIM_SFR(LATA); SHIM_SFR(LATB); SHIM_SFR(LATBCLR); SHIM_SFR(LATBSET);
+SHIM_SFR(NVMADDR); SHIM_SFR(NVMCON); SHIM_SFR(NVMCONCLR); SHIM_SFR(NVMCONSET); SHIM_SFR(NVMDATA); SHIM_SFR(NVMKEY); SHIM_SFR(ODCB); SHIM_SFR(OSCCON);
+SHIM_SFR(OSCCONCLR); SHIM_SFR(OSCCONSET); SHIM_SFR(PMD1CLR); SHIM_SFR(PMD2CLR); SHIM_SFR(PMD3CLR); SHIM_SFR(PMD4CLR); SHIM_SFR(PMD5CLR);
+SHIM_SFR(PMD6CLR); SHIM_SFR(PORTB); SHIM_SFR(PR1); SHIM_SFR(RPA3R); SHIM_SFR(RPB13R); SHIM_SFR(RTCALRM); SHIM_SFR(RTCCON); SHIM_SFR(RTCDATE);
+SHIM_SFR(RTCTIME); SHIM_SFR(SDI1R); SHIM_SFR(SPI1BRG); SHIM_SFR(SPI1BUF); SHIM_SFR(SPI1CON); SHIM_SFR(SPI1CON2); SHIM_SFR(SPI1CONCLR);
+SHIM_SFR(SPI1CONSET); SHIM_SFR(SPI1STATCLR); SHIM_SFR(SYSKEY); SHIM_SFR(T1CON); SHIM_SFR(T1CONCLR); SHIM_SFR(T1CONSET); SHIM_SFR(TMR1);
+SHIM_SFR(TRISA); SHIM_SFR(TRISB); SHIM_SFR(U2BRG); SHIM_SFR(U2MODE); SHIM_SFR(U2RXR); SHIM_SFR(U2STA); SHIM_SFR(U2TXREG);
+
+#ifndef SPI1STAT
+SHIM_SFR(SPI1STAT);
+#endif
+
+
+#endif
+
+
+
+
+
+
+//END OF FILE
\ No newline at end of file